@@ -44,6 +44,7 @@
 #include <cstdint>
 #include <ctime>
 #include <map>
+#include <vector>
 
 namespace opentxs
 {
@@ -224,6 +225,16 @@ public:
     // Lucre step 5: mint verifies token when it is redeemed by merchant.
     EXPORT virtual bool VerifyToken(Nym& theNotary, String& theCleartextToken,
                                     int64_t lDenomination) = 0;
+
+    // Batch forms of the above, for a whole purse. theOutput receives one
+    // signature per token, in order. Both stop at the first failure.
+    EXPORT virtual bool SignTokens(Nym& theNotary,
+                                   const std::vector<Token*>& theTokens,
+                                   std::vector<String>& theOutput,
+                                   int32_t nTokenIndex);
+    EXPORT virtual bool VerifyTokens(
+        Nym& theNotary, std::vector<String>& theCleartextTokens,
+        const std::vector<int64_t>& theDenominations);
 };
 
 } // namespace opentxs
@@ -43,6 +43,14 @@
 #include "opentxs/core/String.hpp"
 
 #include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#if defined(OT_CASH_USING_LUCRE)
+class Bank;
+#endif
 
 namespace opentxs
 {
@@ -63,6 +71,23 @@ class MintLucre : public Mint
 private: // Private prevents erroneous use by other classes.
     typedef Mint ot_super;
     friend class Mint; // for the factory.
+
+    // The private info of a denomination, once unsealed, is kept as a Lucre
+    // Bank for the lifetime of the mint instead of being decrypted again for
+    // every token. The armored private info it came from is kept alongside,
+    // so the Bank is rebuilt if the mint is reloaded with different keys.
+    class CachedBank
+    {
+    public:
+        std::string private_;
+        std::unique_ptr<Bank> bank_;
+    };
+
+    std::mutex banks_lock_;
+    std::map<int64_t, CachedBank> banks_;
+
+    Bank* GetBank(Nym& theNotary, int64_t lDenomination);
+
 protected:
     MintLucre();
     EXPORT MintLucre(const String& strNotaryID,
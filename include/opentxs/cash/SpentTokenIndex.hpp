@@ -0,0 +1,149 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+#ifndef OPENTXS_CASH_SPENTTOKENINDEX_HPP
+#define OPENTXS_CASH_SPENTTOKENINDEX_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+class Identifier;
+class String;
+
+/** The spent token database.
+ *
+ *  Each mint series ("<instrument definition>.<series>") is recorded in two
+ *  files inside the spent folder: a sorted array of fixed size token hashes
+ *  (".index") which is searched in place, and an append-only journal of the
+ *  hashes recorded since the last merge (".log"). The journal is held in
+ *  memory and folded into the sorted array once it grows past a threshold.
+ *
+ *  A Bloom filter over both files is kept for every open series, so the
+ *  common case of a token which has not been spent is answered without
+ *  touching the disk.
+ *
+ *  Series which were recorded by older versions as one file per token are
+ *  imported the first time they are opened. The old files are left in place.
+ */
+class SpentTokenIndex
+{
+private:
+    class Series
+    {
+    private:
+        std::string index_file_;
+        std::string log_file_;
+        int index_ = -1;
+        int log_ = -1;
+        uint64_t count_ = 0;
+        std::set<std::string> journal_;
+        std::vector<uint64_t> bloom_;
+        uint64_t bloom_bits_ = 0;
+
+        static uint64_t Bits(const uint64_t elements);
+
+        void BloomAdd(const std::string& hash);
+        bool BloomCheck(const std::string& hash) const;
+        void BloomReset(const uint64_t elements);
+        void Close();
+        bool LoadIndex();
+        bool LoadLog();
+        bool Merge();
+        bool Read(const uint64_t position, std::string& hash) const;
+        bool Search(const std::string& hash) const;
+
+        Series(const Series&) = delete;
+        Series& operator=(const Series&) = delete;
+
+    public:
+        bool Open(const std::string& folder, const std::string& name);
+        bool Contains(const std::string& hash) const;
+        bool Insert(const std::vector<std::string>& hashes);
+
+        Series() = default;
+        ~Series();
+    };
+
+    std::mutex lock_;
+    std::map<std::string, std::unique_ptr<Series>> series_;
+    std::string folder_;
+
+    bool Folder(std::string& folder) const;
+    static bool Hash(const Identifier& tokenHash, std::string& hash);
+    static bool LegacyHashes(const std::string& folder,
+                             std::vector<std::string>& hashes);
+
+    Series* GetSeries(const String& series);
+
+    SpentTokenIndex() = default;
+    SpentTokenIndex(const SpentTokenIndex&) = delete;
+    SpentTokenIndex& operator=(const SpentTokenIndex&) = delete;
+
+public:
+    /** Size in bytes of one index record (a 256 bit token Identifier). */
+    static const std::size_t HASH_SIZE = 32;
+
+    EXPORT static SpentTokenIndex& It();
+
+    /** Keeps the database in folder, which must end with a path separator,
+     *  instead of the spent folder of the data folder. */
+    EXPORT explicit SpentTokenIndex(const std::string& folder);
+
+    /** Returns true if the token was spent, and also if the series could not
+     *  be read: any false return allows the token to be accepted. */
+    EXPORT bool IsSpent(const String& series, const Identifier& tokenHash);
+    /** Records a group of tokens with a single fsync. Hashes which are
+     *  already recorded are skipped. */
+    EXPORT bool Record(const String& series,
+                       const std::vector<Identifier>& tokenHashes);
+    EXPORT bool Record(const String& series, const Identifier& tokenHash);
+    /** Imports every series in the spent folder which is still stored as one
+     *  file per token. Returns the number of series that failed. */
+    EXPORT int32_t Migrate();
+};
+} // namespace opentxs
+
+#endif // OPENTXS_CASH_SPENTTOKENINDEX_HPP
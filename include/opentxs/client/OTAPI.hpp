@@ -3601,6 +3601,11 @@ public:
     EXPORT static int32_t getMarketList(const std::string& NOTARY_ID,
                                         const std::string& NYM_ID);
 
+    //! Asks the server for its per command latency. (Override Nym only,
+    // unless the server operator allows everyone.)
+    EXPORT static int32_t getCommandStats(const std::string& NOTARY_ID,
+                                          const std::string& NYM_ID);
+
     //! Gets all offers for a specific market and their details (up until
     // maximum depth)
     // Returns int32_t:
@@ -3813,6 +3813,11 @@ public:
     EXPORT int32_t getMarketList(const std::string& NOTARY_ID,
                                  const std::string& NYM_ID) const;
 
+    //! Asks the server for its per command latency. (Override Nym only,
+    // unless the server operator allows everyone.)
+    EXPORT int32_t getCommandStats(const std::string& NOTARY_ID,
+                                   const std::string& NYM_ID) const;
+
     //! Gets all offers for a specific market and their details (up until
     // maximum depth)
     // Returns int32_t:
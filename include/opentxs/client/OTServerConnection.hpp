@@ -42,6 +42,7 @@
 #include "opentxs/core/String.hpp"
 
 #include <stdint.h>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -51,6 +52,8 @@ typedef struct _zsock_t zsock_t;
 namespace opentxs
 {
 
+enum class MessageEncoding : std::uint8_t;
+
 class Identifier;
 class Message;
 class Nym;
@@ -95,7 +98,12 @@ public:
     static bool networkFailure();    // This returns s_bNetworkFailure.
 
 private:
-    bool send(const String&);
+    // Asks the notary which encodings it reads, once, before the first
+    // binary request.
+    bool negotiate();
+    bool encode(const Nym& nym, const Message& theMessage,
+                std::string& request) const;
+    bool send(const std::string& request, std::string& reply);
     bool receive(std::string& reply);
 
 private:
@@ -105,6 +113,11 @@ private:
     OTClient* m_pClient;
 
     std::string m_endpoint;
+    // Set from [Connection] wire_encoding. Drops back to XML for good if
+    // the notary doesn't list the binary encoding in its probe reply. New
+    // messages are given the same encoding.
+    MessageEncoding encoding_;
+    bool negotiated_;
 
     static int s_linger;
     static int s_send_timeout;
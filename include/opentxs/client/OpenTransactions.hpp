@@ -1090,13 +1090,21 @@ public:
                                              // threshold price here.
     EXPORT int32_t getMarketList(const Identifier& NOTARY_ID,
                                  const Identifier& NYM_ID) const;
+    // Asks for the server's per command latency. Only the server's override
+    // Nym is allowed, unless the operator turns it on for everyone.
+    EXPORT int32_t getCommandStats(const Identifier& NOTARY_ID,
+                                   const Identifier& NYM_ID) const;
+    // lKnownVersion is the marketVersion of a previous reply for the same
+    // depth. If the market hasn't changed since, the server replies
+    // notModified, with no payload.
     EXPORT int32_t getMarketOffers(const Identifier& NOTARY_ID,
                                    const Identifier& NYM_ID,
                                    const Identifier& MARKET_ID,
-                                   const int64_t& lDepth) const;
-    EXPORT int32_t getMarketRecentTrades(const Identifier& NOTARY_ID,
-                                         const Identifier& NYM_ID,
-                                         const Identifier& MARKET_ID) const;
+                                   const int64_t& lDepth,
+                                   const int64_t& lKnownVersion = 0) const;
+    EXPORT int32_t getMarketRecentTrades(
+        const Identifier& NOTARY_ID, const Identifier& NYM_ID,
+        const Identifier& MARKET_ID, const int64_t& lKnownVersion = 0) const;
     EXPORT int32_t getNymMarketOffers(const Identifier& NOTARY_ID,
                                       const Identifier& NYM_ID) const;
     // For cancelling market offers and payment plans.
@@ -41,10 +41,14 @@
 
 #include "opentxs/core/Contract.hpp"
 #include "opentxs/core/NumList.hpp"
+#include "opentxs/core/OTData.hpp"
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 
 #include <stdint.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -55,9 +59,17 @@ namespace opentxs
 
 class Message;
 class Nym;
+class OTAsymmetricKey;
 class OTPasswordData;
+class OTSignature;
 class Tag;
 
+// How a Message is encoded between client and server. XML is the signed
+// contract every notary understands. PROTOBUF is a NotaryMessagePB with
+// detached signatures over its serialized bytes. A notary always replies in
+// the encoding of the request.
+enum class MessageEncoding : std::uint8_t { XML = 0, PROTOBUF = 1 };
+
 class OTMessageStrategy
 {
 public:
@@ -105,16 +117,67 @@ private:
     int32_t processXmlNodeNotaryMessage(Message& m,
                                         irr::io::IrrXMLReader*& xml);
 
+    void updateCanonical();
+    bool loadEnvelope(const void* data, std::size_t size);
+    bool saveEnvelope(std::string& output) const;
+    bool verifyCanonical(const OTAsymmetricKey& theKey,
+                         const OTSignature& theSignature,
+                         const OTPasswordData* pPWData) const;
+
+    static std::atomic<MessageEncoding> default_encoding_;
+
+    MessageEncoding encoding_;
+    // The signed NotaryMessagePB, when encoding_ is PROTOBUF.
+    OTData canonical_;
+
 public:
     EXPORT Message();
     EXPORT virtual ~Message();
 
     virtual bool VerifyContractID() const;
 
+    EXPORT virtual bool LoadContractFromString(const String& theStr);
+    using Contract::SaveContract;
+    EXPORT virtual bool SaveContract();
+
     EXPORT virtual bool SignContract(const Nym& theNym,
                                      const OTPasswordData* pPWData = nullptr);
     EXPORT virtual bool VerifySignature(
         const Nym& theNym, const OTPasswordData* pPWData = nullptr) const;
+    EXPORT virtual bool VerifyWithKey(
+        const OTAsymmetricKey& theKey,
+        const OTPasswordData* pPWData = nullptr) const;
+
+    // Set before signing. A PROTOBUF message is still saved as text (for
+    // receipts and the Nymbox), but that text only loads as a Message.
+    EXPORT MessageEncoding Encoding() const { return encoding_; }
+    EXPORT void SetEncoding(MessageEncoding encoding);
+    // The encoding new messages start with. The client sets it to the
+    // encoding of its notary connection, so that requests are signed once,
+    // in the form they are sent in. Loading a message replaces it with the
+    // encoding that was loaded.
+    EXPORT static void SetDefaultEncoding(MessageEncoding encoding);
+
+    // The bytes sent to, or received from, the other side: armored XML, or
+    // a zero byte followed by a SignedNotaryMessagePB.
+    EXPORT bool SaveWire(std::string& output) const;
+    EXPORT bool LoadWire(const std::string& input);
+
+    // Encoding negotiation. The probe is not a message: a notary which only
+    // reads XML can't load it and answers with nothing, having processed
+    // nothing, while a newer notary answers with the encodings it reads.
+    EXPORT static std::string WireProbe();
+    EXPORT static bool IsWireProbe(const std::string& input);
+    EXPORT static std::string WireProbeReply();
+    EXPORT static bool ProbeReplySupports(
+        const std::string& reply,
+        MessageEncoding encoding);
+    // What the notary sends when it can't answer a request: nothing for
+    // armored XML, as older notaries do, and a lone zero byte for a binary
+    // request, so that it can't be mistaken for a notary which doesn't read
+    // the binary encoding.
+    EXPORT static std::string WireErrorReply(const std::string& request);
+    EXPORT static bool IsWireErrorReply(const std::string& reply);
 
     EXPORT bool HarvestTransactionNumbers(
         Nym& theNym,
@@ -48,6 +48,7 @@
 
 #include <czmq.h>
 #include <deque>
+#include <functional>
 #include <list>
 #include <map>
 #include <memory>
@@ -90,6 +91,15 @@ public:
     static const CredentialIndexModeFlag FULL_CREDS = false;
     Nym(const Nym&) = default;
 
+    // Called after SaveSignedNymfile writes a nymfile, with the Nym that
+    // was saved and the payload that went into the file. The server uses
+    // this to keep the Nyms it holds between requests in step with disk.
+    typedef std::function<void(const Nym&, const String&)> NymfileSaved;
+    EXPORT static void SetNymfileSavedCallback(NymfileSaved callback);
+
+private:
+    static NymfileSaved nymfile_saved_;
+
 private:
     std::string alias_;
     uint32_t credential_index_version_ = 0;
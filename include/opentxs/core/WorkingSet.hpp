@@ -0,0 +1,195 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_WORKINGSET_HPP
+#define OPENTXS_CORE_WORKINGSET_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace opentxs
+{
+
+class Identifier;
+class String;
+
+// The server's working set of accounts, boxes and box receipts.
+//
+// Once started, OTDB serves those files from memory after the first read.
+// Files written while a Request is open on the thread are held back and
+// written together when the request ends, so a box that is saved several
+// times in one request only reaches storage once. A contract that verified
+// against a signer is not verified again until its contents change.
+class WorkingSet
+{
+public:
+    // Scopes one client request on the current thread. Nested requests join
+    // the outer one.
+    class Request
+    {
+    public:
+        EXPORT Request();
+        EXPORT ~Request();
+
+    private:
+        Request(const Request&) = delete;
+        Request& operator=(const Request&) = delete;
+
+        bool outer_;
+    };
+
+    // capacity is how many bytes of unmodified files are kept. Zero leaves
+    // the working set off.
+    EXPORT static void Start(std::size_t capacity);
+    EXPORT static void Stop();
+
+    // Null unless the working set was started.
+    EXPORT static WorkingSet* It();
+
+    // Whether files under this top level folder are kept here.
+    bool Handles(const std::string& folder) const;
+
+    // These stand in for the matching OTDB calls on handled folders.
+    bool Exists(const std::string& folder, const std::string& one,
+                const std::string& two, const std::string& three);
+    std::string Query(const std::string& folder, const std::string& one,
+                      const std::string& two, const std::string& three);
+    bool Store(const std::string& contents, const std::string& folder,
+               const std::string& one, const std::string& two,
+               const std::string& three);
+    bool Erase(const std::string& folder, const std::string& one,
+               const std::string& two, const std::string& three);
+
+    // For contracts loaded from a handled folder. folder and filename are
+    // the contract's own, contents is its raw (decoded) file.
+    bool IsVerified(const String& folder, const String& filename,
+                    const String& contents, const Identifier& signer);
+    void Verified(const String& folder, const String& filename,
+                  const String& contents, const Identifier& signer);
+
+    uint64_t Hits() const { return hits_; }
+    uint64_t Misses() const { return misses_; }
+    uint64_t Commits() const { return commits_; }
+    uint64_t Coalesced() const { return coalesced_; }
+    uint64_t Verifications() const { return verifications_; }
+
+    ~WorkingSet();
+
+private:
+    class Entry
+    {
+    public:
+        std::string folder_;
+        std::string one_;
+        std::string two_;
+        std::string three_;
+        std::string contents_;
+        bool exists_;
+        bool dirty_;
+        // Bumped whenever contents_ or exists_ change, so a commit can tell
+        // whether the file was saved again while it was being written.
+        uint64_t generation_;
+        std::string signer_;
+        std::string verified_;
+        std::list<std::string>::iterator lru_;
+
+        Entry();
+
+        std::size_t Size() const
+        {
+            return contents_.size() + verified_.size();
+        }
+    };
+
+    // Storage writes of one file are serialized on one of these, chosen by
+    // the file's key, so an older copy never lands after a newer one.
+    static const std::size_t WRITE_LOCKS = 64;
+
+    static std::unique_ptr<WorkingSet> it_;
+
+    const std::size_t capacity_;
+    std::vector<std::string> folders_;
+
+    std::mutex lock_;
+    std::map<std::string, Entry> files_;
+    // Most recently used at the front.
+    std::list<std::string> lru_;
+    std::size_t size_;
+    std::map<std::thread::id, std::vector<std::string>> requests_;
+    std::array<std::mutex, WRITE_LOCKS> write_locks_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> commits_;
+    std::atomic<uint64_t> coalesced_;
+    std::atomic<uint64_t> verifications_;
+
+    static std::string key(const std::string& folder, const std::string& one,
+                           const std::string& two, const std::string& three);
+    static std::string contract_key(const String& folder,
+                                    const String& filename);
+
+    explicit WorkingSet(std::size_t capacity);
+    WorkingSet(const WorkingSet&) = delete;
+    WorkingSet& operator=(const WorkingSet&) = delete;
+
+    bool begin();
+    void commit();
+    Entry& insert(const std::string& key, const std::string& folder,
+                  const std::string& one, const std::string& two,
+                  const std::string& three);
+    bool pending(const std::string& key);
+    void touch(Entry& entry);
+    void drop(std::map<std::string, Entry>::iterator it);
+    void trim();
+    bool write(const std::string& key);
+    std::mutex& write_lock(const std::string& key);
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_WORKINGSET_HPP
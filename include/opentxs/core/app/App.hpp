@@ -102,6 +102,7 @@ private:
 
     void Periodic();
 
+    void Init_Armor();
     void Init_Config();
     void Init_Contracts();
     void Init_Crypto();
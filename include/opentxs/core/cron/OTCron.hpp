@@ -44,6 +44,16 @@
 #include "opentxs/core/util/StringUtils.hpp"
 #include "opentxs/core/util/Timer.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace opentxs
 {
 
@@ -57,6 +67,8 @@ typedef std::map<int64_t, OTCronItem*> mapOfCronItems;
 typedef std::multimap<time64_t, OTCronItem*> multimapOfCronItems;
 /** Mapped (uniquely) to market ID. */
 typedef std::map<std::string, OTMarket*> mapOfMarkets;
+/** Transaction numbers of cron items, ordered by the time they are next due. */
+typedef std::set<std::pair<time64_t, int64_t>> setOfCronWakeups;
 /** Cron stores a bunch of these on this list, which the server refreshes from
  * time to time. */
 typedef std::list<int64_t> listOfLongNumbers;
@@ -72,6 +84,10 @@ private:
     mapOfMarkets m_mapMarkets;      // A list of all valid markets.
     mapOfCronItems m_mapCronItems;  // Cron Items are found on both lists.
     multimapOfCronItems m_multimapCronItems;
+    setOfCronWakeups m_setWakeups;  // Every item on the map is scheduled here,
+    std::map<int64_t, time64_t> m_mapWakeups;  // and its due time kept here.
+    std::set<std::string> m_setChangedMarkets;  // Markets whose offers
+                                                // changed since last round.
     Identifier m_NOTARY_ID;  // Always store this in any object that's
                              // associated with a specific server.
 
@@ -93,9 +109,35 @@ private:
     static int32_t __cron_max_items_per_nym;  // Int. The maximum number of cron
                                               // items any given Nym can have
                                               // active at the same time.
+    static int32_t __cron_max_threads;  // Number of threads which process
+                                        // independent cron items at once.
+    static int32_t __cron_market_snapshot_interval;  // Number of journaled
+                                                     // changes after which a
+                                                     // market is re-signed
+                                                     // and saved in full.
+
+    // Cron items running on different threads share these.
+    mutable std::mutex m_lockTransactionNumbers;
+    std::recursive_mutex m_lockMarkets;
+    std::mutex m_lockWakeups;
+    std::atomic<bool> m_bDeferSave{false};
+    std::atomic<bool> m_bSavePending{false};
 
     static Timer tCron;
 
+    void ScheduleCronItem(int64_t lTransactionNum, time64_t tWakeTime);
+    void UnscheduleCronItem(int64_t lTransactionNum);
+    bool ProcessCronItem(OTCronItem& theItem);
+    void PartitionCronItems(
+        const std::vector<int64_t>& vecDue,
+        std::vector<std::vector<int64_t>>& vecPartitions,
+        std::vector<int64_t>& vecSerial);
+    void ProcessPartitions(
+        const std::vector<std::vector<int64_t>>& vecPartitions,
+        int32_t nMinimumTransactions);
+    void RemoveProcessedItem(int64_t lTransactionNum);
+    void CommitMarkets();
+
 public:
     static int32_t GetCronMsBetweenProcess()
     {
@@ -116,6 +158,24 @@ public:
     {
         __cron_max_items_per_nym = nMax;
     }
+    static int32_t GetCronMaxThreads() { return __cron_max_threads; }
+    static void SetCronMaxThreads(int32_t nThreads)
+    {
+        __cron_max_threads = nThreads;
+    }
+    static int32_t GetCronMarketSnapshotInterval()
+    {
+        return __cron_market_snapshot_interval;
+    }
+    static void SetCronMarketSnapshotInterval(int32_t nInterval)
+    {
+        __cron_market_snapshot_interval = nInterval;
+    }
+    /** The resource name under which trades on a given market are grouped when
+     * cron items are partitioned. (See OTCronItem::GetCronResources.) */
+    static std::string MarketResource(
+        const Identifier& INSTRUMENT_DEFINITION_ID,
+        const Identifier& CURRENCY_ID);
     inline bool IsActivated() const { return m_bIsActivated; }
     inline bool ActivateCron()
     {
@@ -137,16 +197,25 @@ public:
     EXPORT mapOfCronItems::iterator FindItemOnMap(int64_t lTransactionNum);
     EXPORT multimapOfCronItems::iterator FindItemOnMultimap(
         int64_t lTransactionNum);
+    /** Makes the item due on the next round, regardless of the wake time it
+     * reported. Used when something other than the item changes its state. */
+    EXPORT void WakeCronItem(int64_t lTransactionNum);
     // MARKETS
     bool AddMarket(OTMarket& theMarket, bool bSaveMarketFile = true);
     bool RemoveMarket(const Identifier& MARKET_ID);  // if returns false,
                                                      // market wasn't found.
 
     EXPORT OTMarket* GetMarket(const Identifier& MARKET_ID);
+    /** Called by a market whenever an offer is added, removed or traded, so
+     * that the trades resting on it are woken on the next round. */
+    void MarketChanged(const Identifier& MARKET_ID);
     OTMarket* GetOrCreateMarket(
         const Identifier& INSTRUMENT_DEFINITION_ID,
         const Identifier& CURRENCY_ID,
         const int64_t& lScale);
+    /** Writes a full signed snapshot of every market, so the next load has no
+     * journal to replay. Called at shutdown. */
+    EXPORT void SnapshotMarkets();
     /** This is informational only. It returns OTStorage-type data objects,
      * packed in a string. */
     EXPORT bool GetMarketList(OTASCIIArmor& ascOutput, int32_t& nMarketCount);
@@ -170,7 +239,10 @@ public:
      * transaction numbers in there must be enough to last for the entire
      * ProcessCronItems() call, and all the trades and payment plans within,
      * since it will not be replenished again at least until the call has
-     * finished.) */
+     * finished.) Only the items which are due, according to
+     * OTCronItem::GetNextWakeTime(), are processed on a given round. Due items
+     * which share no accounts, Nyms or markets are processed in parallel, on
+     * up to GetCronMaxThreads() threads. */
     EXPORT void ProcessCronItems();
 
     int64_t computeTimeout();
@@ -189,7 +261,13 @@ public:
     inline Nym* GetServerNym() const { return m_pServerNym; }
 
     EXPORT bool LoadCron();
+    /** While items are being processed in parallel, the save is deferred
+     * until they have all finished. Market changes which are still queued are
+     * committed first. */
     EXPORT bool SaveCron();
+    /** True while the changes made by cron items are being held back, to be
+     * written together once the round has finished. */
+    bool IsSaveDeferred() const { return m_bDeferSave.load(); }
 
     EXPORT OTCron();
     explicit OTCron(const Identifier& NOTARY_ID);
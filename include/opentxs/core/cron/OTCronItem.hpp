@@ -45,6 +45,8 @@
 #include "opentxs/core/OTTrackable.hpp"
 
 #include <deque>
+#include <set>
+#include <string>
 
 namespace opentxs
 {
@@ -149,10 +151,7 @@ public:
     {
         return m_bRemovalFlag;
     }
-    inline void FlagForRemoval()
-    {
-        m_bRemovalFlag = true;
-    }
+    void FlagForRemoval(); // Also wakes the item, if it's on Cron.
     inline void SetCronPointer(OTCron& theCron)
     {
         m_pCron = &theCron;
@@ -224,6 +223,13 @@ public:
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
                                 // From OTTrackable (parent class of this)
+    // The earliest time at which ProcessCron() may have something to do.
+    // OTCron doesn't process the item again before then, unless it is woken.
+    virtual time64_t GetNextWakeTime() const;
+    // Adds the accounts, Nyms and markets that ProcessCron() may touch, so
+    // that OTCron can run items with none of these in common on separate
+    // threads. Items which return false are processed alone.
+    virtual bool GetCronResources(std::set<std::string>& output) const;
     virtual ~OTCronItem();
 
     void InitCronItem();
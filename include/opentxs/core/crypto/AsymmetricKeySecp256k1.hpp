@@ -43,6 +43,9 @@
 #include "opentxs/core/crypto/LowLevelKeyGenerator.hpp"
 #include "opentxs/core/crypto/OTAsymmetricKey.hpp"
 
+#include <memory>
+#include <mutex>
+
 namespace opentxs
 {
 
@@ -56,6 +59,7 @@ private:
     typedef OTAsymmetricKey ot_super;
     friend class OTAsymmetricKey;  // For the factory.
     friend class LowLevelKeyGenerator;
+    friend class Libsecp256k1;  // For the parsed public key.
 
     AsymmetricKeySecp256k1();
     explicit AsymmetricKeySecp256k1(const proto::KeyRole role);
@@ -63,6 +67,11 @@ private:
     explicit AsymmetricKeySecp256k1(const String& publicKey);
     void ReleaseKeyLowLevel_Hook() const override;
     std::unique_ptr<OTData> key_;  // used by LowLevelKeyGenerator
+    /** Parsed form of the public key, filled in by Libsecp256k1 the first
+     *  time this key verifies a signature and dropped whenever the key is
+     *  replaced or released. */
+    mutable std::mutex parsed_lock_;
+    mutable std::unique_ptr<OTData> parsed_;
 
 public:
     CryptoAsymmetric& engine() const override;
@@ -41,6 +41,11 @@
 
 #include "opentxs/core/Proto.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
 namespace opentxs
 {
 
@@ -65,7 +70,24 @@ public:
       SHA512 = proto::HASHTYPE_SHA512
     };
 
+    // Largest digest any HashType produces, in bytes.
+    static const std::size_t MaxDigestSize = 64;
+
+    // Hashes its input incrementally, as it arrives in pieces. Final()
+    // writes the digest into a caller's buffer of MaxDigestSize bytes, after
+    // which the Hasher can't be updated again.
+    class Hasher
+    {
+    public:
+        virtual bool Update(const void* input, std::size_t size) = 0;
+        virtual bool Final(std::uint8_t* output, std::size_t& size) = 0;
+
+        virtual ~Hasher() = default;
+    };
+
     virtual ~CryptoHash() = default;
+    // Returns nullptr if the hash type isn't supported.
+    virtual std::unique_ptr<Hasher> Init(const HashType hashType) const = 0;
     virtual bool Digest(
         const HashType hashType,
         const OTPassword& data,
@@ -79,6 +101,13 @@ public:
         const OTPassword& inputKey,
         const OTData& inputData,
         OTPassword& outputDigest) const = 0;
+    // Hashes the input in place, without copying it.
+    bool Digest(
+        const HashType hashType,
+        const void* input,
+        const std::size_t size,
+        std::uint8_t* output,
+        std::size_t& outputSize) const;
     bool Digest(
         const HashType hashType,
         const String& data,
@@ -61,6 +61,8 @@ protected:
         OTPassword& theOutput, const char* szPrompt) const = 0;
 
 public:
+    enum class Base64Kernel : uint8_t { SCALAR = 0, SSSE3 = 1, AVX2 = 2 };
+
     virtual ~CryptoUtil() = default;
     EXPORT bool GetPasswordFromConsole(OTPassword& theOutput,
                                        bool bRepeat = false) const;
@@ -76,14 +78,46 @@ public:
     // here is because that's what OpenSSL uses. So we may need to find
     // another way of doing it, so we can use a safer parameter here
     // than what it currently is. TODO security.
-    virtual char* Base64Encode(const uint8_t* input, int32_t in_len,
-                               bool bLineBreaks) const = 0;
-    virtual uint8_t* Base64Decode(const char* input, size_t* out_len,
-                                  bool bLineBreaks) const = 0;
+    EXPORT char* Base64Encode(const uint8_t* input, int32_t in_len,
+                              bool bLineBreaks) const;
+    // Line breaks and other whitespace are skipped wherever they appear, so
+    // bLineBreaks is only kept for compatibility. Returns nullptr if the input
+    // is not valid base64.
+    EXPORT uint8_t* Base64Decode(const char* input, size_t* out_len,
+                                 bool bLineBreaks) const;
     std::string RandomFilename() const;
     String Nonce(const uint32_t size) const;
     String Nonce(const uint32_t size, OTData& rawOutput) const;
 
+    /** Number of characters Base64Encode writes for size bytes of input. */
+    EXPORT static size_t Base64EncodedSize(
+        const size_t size,
+        const bool bLineBreaks);
+    /** Writes exactly Base64EncodedSize(size, bLineBreaks) characters, with
+     * no null terminator. Line breaks match the OpenSSL encoder: a newline
+     * after every 64 characters and at the end. */
+    EXPORT static void Base64Encode(
+        const uint8_t* input,
+        const size_t size,
+        const bool bLineBreaks,
+        char* output);
+    /** Decodes whole 4-character groups until the input ends or a character
+     * outside the base64 alphabet (whitespace or padding, for example) is
+     * reached. Returns the number of characters consumed. output must have
+     * room for 3 bytes per 4 characters of input. */
+    EXPORT static size_t Base64DecodeBlocks(
+        const char* input,
+        const size_t size,
+        uint8_t* output);
+    /** Selects the implementation behind the base64 functions. The fastest
+     * one the CPU supports is used by default. Returns false, leaving the
+     * selection unchanged, if the CPU does not support kernel. */
+    EXPORT static bool SetBase64Kernel(const Base64Kernel kernel);
+    EXPORT static Base64Kernel SelectedBase64Kernel();
+
+    static std::string Base58CheckEncode(
+        const uint8_t* input,
+        const size_t size);
     static String Base58CheckEncode(const OTPassword& input);
     static String Base58CheckEncode(const OTData& input);
     static bool Base58CheckDecode(const String& input, OTData& output);
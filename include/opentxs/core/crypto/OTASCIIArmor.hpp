@@ -42,6 +42,7 @@
 #include "opentxs/core/String.hpp"
 
 #include <stdint.h>
+#include <atomic>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -62,6 +63,14 @@ class OTPacker;
 
 typedef std::map<int64_t, OTASCIIArmor*> mapOfArmor;
 
+/** Codec used to compress armored strings. ZLIB payloads are untagged, as
+ * written by every earlier version; other codecs begin with a tag byte. ZSTD
+ * is only available when built with OT_COMPRESSION_ZSTD. */
+enum class ArmorCompression : std::uint8_t {
+    ZLIB = 0,
+    ZSTD = 1
+};
+
 extern const char* OT_BEGIN_ARMORED;
 extern const char* OT_END_ARMORED;
 
@@ -103,6 +112,16 @@ class OTASCIIArmor : public String
 public:
     static OTDB::OTPacker* GetPacker();
 
+    /** Selects the codec and level used by SetString. Decoding always accepts
+     * every codec this build supports, whatever is selected here. Returns
+     * false, leaving the setting unchanged, if the codec is unavailable or
+     * the level is out of range for it. */
+    EXPORT static bool SetCompression(
+        const ArmorCompression codec,
+        const int32_t level);
+    EXPORT static ArmorCompression Compression();
+    EXPORT static int32_t CompressionLevel();
+
     EXPORT OTASCIIArmor();
     EXPORT OTASCIIArmor(const char* szValue);
     EXPORT OTASCIIArmor(const OTData& theValue);
@@ -176,11 +195,8 @@ public:
     EXPORT bool SetString(const String& theData, bool bLineBreaks = true);
 
 private:
-    std::string compress_string(
-        const std::string& str,
-        int32_t compressionlevel) const;
-    std::string decompress_string(const std::string& str) const;
-
+    // The codec in the high 32 bits and the level in the low 32 bits
+    static std::atomic<uint64_t> compression_;
     static std::unique_ptr<OTDB::OTPacker> s_pPacker;
 };
 
@@ -41,6 +41,8 @@
 
 #include "OTAsymmetricKeyOpenSSL.hpp"
 
+#include <mutex>
+
 extern "C" {
 #include <openssl/pem.h>
 #include <openssl/evp.h>
@@ -94,6 +96,10 @@ private:
     EVP_PKEY* m_pKey; // Instantiated form of key. (For private keys especially,
                       // we don't want it instantiated for any longer than
                       // absolutely necessary, when we have to use it.)
+    // Guards m_pKey, which GetKey frees and re-instantiates once the key
+    // timer runs out. Callers which use the EVP_PKEY returned by GetKey
+    // must hold it until they are done with the key.
+    mutable std::recursive_mutex m_lock;
     // PRIVATE METHODS
     EVP_PKEY* InstantiateKey(const OTPasswordData* pPWData = nullptr);
     EVP_PKEY* InstantiatePublicKey(const OTPasswordData* pPWData = nullptr);
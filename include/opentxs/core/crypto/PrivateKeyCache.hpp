@@ -0,0 +1,112 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_CRYPTO_PRIVATEKEYCACHE_HPP
+#define OPENTXS_CORE_CRYPTO_PRIVATEKEYCACHE_HPP
+
+#include "opentxs/core/OTData.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+class OTPassword;
+
+/** Holds decrypted private keys between signatures, so that a Nym which signs
+ *  continuously (such as the server Nym) does not repeat the symmetric
+ *  decryption of its key for every signature.
+ *
+ *  Entries are keyed by the encrypted form of the key. The plaintext is held
+ *  in an OTData, which zeroes its buffer when released, since a DER encoded
+ *  RSA key does not fit in an OTPassword. An entry lives no longer than the
+ *  master key timeout configured in OTCachedKey, and the whole cache is wiped
+ *  whenever the master password is destroyed. A timeout of 0 disables the cache. */
+class PrivateKeyCache
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::list<std::string> LRU;
+
+    class Entry
+    {
+    public:
+        OTData key_;
+        Clock::time_point expires_;
+        bool forever_ = false;
+        LRU::iterator position_;
+    };
+
+    static const std::size_t MAX_ENTRIES = 64;
+
+    mutable std::mutex lock_;
+    std::map<std::string, Entry> entries_;
+    LRU lru_;
+
+    static std::string Index(const OTData& encryptedKey);
+
+    void Erase(std::map<std::string, Entry>::iterator it);
+
+    PrivateKeyCache() = default;
+    PrivateKeyCache(const PrivateKeyCache&) = delete;
+    PrivateKeyCache& operator=(const PrivateKeyCache&) = delete;
+
+public:
+    EXPORT static PrivateKeyCache& It();
+
+    /** Copies the cached plaintext for encryptedKey into output. Returns false
+     *  if the key is not cached or its entry has expired. The OTPassword
+     *  overload also fails if the plaintext is larger than output holds. */
+    EXPORT bool Get(const OTData& encryptedKey, OTData& output);
+    EXPORT bool Get(const OTData& encryptedKey, OTPassword& output);
+    EXPORT void Insert(const OTData& encryptedKey, const OTData& decryptedKey);
+    EXPORT void Insert(
+        const OTData& encryptedKey,
+        const OTPassword& decryptedKey);
+    EXPORT void Clear();
+
+    ~PrivateKeyCache();
+};
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_CRYPTO_PRIVATEKEYCACHE_HPP
@@ -308,6 +308,7 @@ public:
     // Return False if expired or otherwise should be removed.
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
+    virtual bool GetCronResources(std::set<std::string>& output) const;
 
     // From OTTrackable (parent class of OTCronItem, parent class of this)
     /*
@@ -39,6 +39,7 @@
 #ifndef OPENTXS_CORE_SCRIPT_OTSCRIPT_HPP
 #define OPENTXS_CORE_SCRIPT_OTSCRIPT_HPP
 
+#include <stdint.h>
 #include <map>
 #include <string>
 #include <memory>
@@ -90,6 +91,9 @@ protected:
                                       // references them.
     mapOfVariables m_mapVariables; // no need to clean this up. Script doesn't
                                    // own the variables, just references them.
+    int64_t m_lCompiledOwner = 0; // when nonzero, the interpreter may keep
+                                  // the parsed script for this owner. (See
+                                  // SetCompiledOwner.)
 
     // List
     // Construction -- Destruction
@@ -112,6 +116,13 @@ public:
         m_str_display_filename = str_display_filename;
     }
 
+    // Scripts whose source cannot change (such as the clauses of an active
+    // smart contract) may be parsed once and kept by the interpreter. The
+    // owner ID (the smart contract's transaction number) is what the parsed
+    // form is released under, once the owner is gone.
+    //
+    void SetCompiledOwner(int64_t lOwner) { m_lCompiledOwner = lOwner; }
+
     // The same OTSmartContract that loads all the clauses (scripts) will
     // also load all the parties, so it will call this function whenever before
     // it
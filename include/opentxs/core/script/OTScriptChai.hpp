@@ -41,6 +41,8 @@
 
 #include "opentxs/core/script/OTScript.hpp"
 
+#include <stdint.h>
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4702) // warning C4702: unreachable code
@@ -74,6 +76,21 @@ public:
     virtual ~OTScriptChai();
 
     virtual bool ExecuteScript(OTVariable* pReturnVar = nullptr);
+
+    /** Drops the parsed clauses kept for lOwner (see
+     *  OTScript::SetCompiledOwner). */
+    EXPORT static void ReleaseCompiled(int64_t lOwner);
+
+    /** Interpreters are expensive to bootstrap, so they are kept in a pool
+     *  and reset to their freshly constructed state when an OTScriptChai is
+     *  destroyed. These count how often a construction found an idle
+     *  interpreter (hit) or had to build a new one (miss). */
+    EXPORT static uint64_t PoolHits();
+    EXPORT static uint64_t PoolMisses();
+    /** Number of scripts executed and their total run time. */
+    EXPORT static uint64_t ScriptRuns();
+    EXPORT static uint64_t ScriptMicroseconds();
+
     chaiscript::ChaiScript* const chai;
 };
 
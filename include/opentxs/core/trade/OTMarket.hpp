@@ -48,22 +48,27 @@
 #include "opentxs/core/Identifier.hpp"
 #include "opentxs/core/OTStorage.hpp"
 #include "opentxs/core/cron/OTCron.hpp"
+#include "opentxs/core/crypto/OTASCIIArmor.hpp"
+#include "opentxs/core/trade/OTMarketJournal.hpp"
 #include "opentxs/core/trade/OTOffer.hpp"
+#include "opentxs/core/trade/OTOrderBook.hpp"
 #include "opentxs/core/util/Common.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <set>
 #include <string>
 
 namespace opentxs
 {
 
 class Account;
-class OTASCIIArmor;
 class OTCron;
 class OTOffer;
 class OTTrade;
 class String;
+class Tag;
 namespace OTDB {
 class OfferListNym;
 class TradeListMarket;
@@ -72,13 +77,9 @@ class TradeListMarket;
 #define MAX_MARKET_QUERY_DEPTH                                                 \
     50 // todo add this to the ini file. (Now that we actually have one.)
 
-// Multiple offers, mapped by price limit.
-// Using multi-map since there will be more than one offer for each single
-// price.
-// (Map would only allow a single item on the map for each price.)
-typedef std::multimap<int64_t, OTOffer*> mapOfOffers;
-
-// The same offers are also mapped (uniquely) to transaction number.
+// The offers are kept in an order book for each side, grouped by price (see
+// OTOrderBook.) The same offers are also mapped (uniquely) to transaction
+// number.
 typedef std::map<int64_t, OTOffer*> mapOfOffersTrnsNum;
 
 class OTMarket : public Contract
@@ -91,8 +92,8 @@ private:
 
     OTDB::TradeListMarket* m_pTradeList;
 
-    mapOfOffers m_mapBids; // The buyers, ordered by price limit
-    mapOfOffers m_mapAsks; // The sellers, ordered by price limit
+    OTOrderBook m_Bids; // The buyers, ordered by price limit
+    OTOrderBook m_Asks; // The sellers, ordered by price limit
 
     mapOfOffersTrnsNum m_mapOffers; // All of the offers on a single list,
                                     // ordered by transaction number.
@@ -118,6 +119,32 @@ private:
     int64_t m_lLastSalePrice;
     std::string m_strLastSaleDate;
 
+    // Changes since the last signed snapshot of the market are appended to a
+    // journal instead of rewriting the whole market every time.
+    OTMarketJournal m_Journal;
+    std::set<int64_t> m_setChangedOffers; // Not yet on the journal.
+    int64_t m_lJournalSequence; // The last journal record in the snapshot.
+    bool m_bHaveSnapshot;
+
+    // Changes every time the offers or the recent trades change. The packed
+    // replies to market data requests are kept until it does. (Requests for a
+    // given market are serialized by the market ID in RequestLocks.)
+    class CachedList
+    {
+    public:
+        int64_t version_ = 0;
+        // Identifies this version of an offer list at this depth, so a
+        // client's copy at one depth is never taken as current for another.
+        int64_t token_ = 0;
+        int32_t count_ = 0;
+        OTASCIIArmor payload_;
+    };
+
+    int64_t m_lVersion;
+    int64_t m_lNextOfferListToken;
+    std::map<int64_t, CachedList> m_mapOfferListCache; // By depth.
+    CachedList m_RecentTradesCache;
+
     // The server stores a map of markets, one for each unique combination of
     // instrument definitions.
     // That's what this market class represents: one instrument definition being
@@ -144,6 +171,23 @@ private:
                                 Account& p2, bool b2, const int64_t& a2,
                                 Account& p3, bool b3, const int64_t& a3,
                                 Account& p4, bool b4, const int64_t& a4);
+    void NotifyCron();
+    static int64_t initial_version();
+    void save_offer(Tag& parent, const OTOffer& theOffer) const;
+    bool remove_offer(const int64_t& lTransactionNum);
+    void record_trade(const int64_t& lTransactionNum, const std::string& strDate,
+                      const int64_t& lPrice, const int64_t& lAmountSold);
+    bool open_journal();
+    void journal_changed_offers();
+    bool replay_journal();
+    bool replay_record(const std::string& strRecord);
+    bool sign_journal(const std::string& strGroup, std::string& strSignature);
+    bool verify_journal(const std::string& strGroup,
+                        const std::string& strSignature);
+    bool pack_offer_list(OTASCIIArmor& ascOutput, int64_t lDepth,
+                         int32_t& nOfferCount);
+    bool pack_recent_trade_list(OTASCIIArmor& ascOutput,
+                                int32_t& nTradeCount);
 
 public:
     bool ValidateOfferForMarket(OTOffer& theOffer, String* pReason = nullptr);
@@ -152,9 +196,22 @@ public:
     bool AddOffer(OTTrade* pTrade, OTOffer& theOffer, bool bSaveFile = true,
                   time64_t tDateAddedToMarket = OT_TIME_ZERO);
     bool RemoveOffer(const int64_t& lTransactionNum);
-    // returns general information about offers on the market
+    const mapOfOffersTrnsNum& GetOffers() const
+    {
+        return m_mapOffers;
+    }
+    // Clients can send this back to ask for market data only if it changed.
+    int64_t GetVersion() const
+    {
+        return m_lVersion;
+    }
+    // returns general information about offers on the market. lToken is set
+    // to what a client sends back to ask for the same list only if it
+    // changed.
     EXPORT bool GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
-                             int32_t& nOfferCount);
+                             int32_t& nOfferCount, int64_t& lToken);
+    // True if lToken came with the current offer list at lDepth.
+    bool IsOfferListCurrent(int64_t lDepth, const int64_t& lToken) const;
     EXPORT bool GetRecentTradeList(OTASCIIArmor& ascOutput,
                                    int32_t& nTradeCount);
 
@@ -176,13 +233,13 @@ public:
     int64_t GetHighestBidPrice();
     int64_t GetLowestAskPrice();
 
-    mapOfOffers::size_type GetBidCount()
+    std::size_t GetBidCount() const
     {
-        return m_mapBids.size();
+        return m_Bids.Count();
     }
-    mapOfOffers::size_type GetAskCount()
+    std::size_t GetAskCount() const
     {
-        return m_mapAsks.size();
+        return m_Asks.Count();
     }
     void SetInstrumentDefinitionID(const Identifier& INSTRUMENT_DEFINITION_ID)
     {
@@ -255,8 +312,23 @@ public:
     {
         return m_pCron;
     }
+    // Loads the last snapshot and replays the journal on top of it.
     bool LoadMarket();
+    // Commits the changes since the last call to the journal. Once enough
+    // changes have piled up, a full snapshot is saved instead. (Unless Cron
+    // is holding saves back until the end of its round.)
     bool SaveMarket();
+    // Re-signs and saves the whole market, and empties the journal.
+    EXPORT bool SaveSnapshot();
+    bool HasPendingChanges() const
+    {
+        return !m_setChangedOffers.empty() || m_Journal.HasPending();
+    }
+    // The journal has grown enough that the next save should be a snapshot.
+    bool SnapshotDue() const;
+    // For when an offer on the market has been changed (say, re-signed)
+    // from outside, so the next SaveMarket() includes it.
+    void OfferChanged(const OTOffer& theOffer);
 
     void InitMarket();
 
@@ -0,0 +1,142 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_TRADE_OTMARKETJOURNAL_HPP
+#define OPENTXS_CORE_TRADE_OTMARKETJOURNAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace opentxs
+{
+
+class String;
+
+/** Write-ahead journal of the changes made to a market since its last signed
+ *  snapshot.
+ *
+ *  Records are queued in memory by Append() and written together, with one
+ *  fsync, by Commit(). Every record carries a sequence number and a checksum,
+ *  so a record cut short by a crash is detected (and dropped) the next time
+ *  the journal is read. Each group written by Commit() ends with a signature
+ *  over the whole group, which Read() checks before returning any of it.
+ *
+ *  The journal is kept next to the market file, as "<market ID>.journal".
+ */
+class OTMarketJournal
+{
+public:
+    typedef std::vector<std::pair<int64_t, std::string>> vectorOfRecords;
+    // Signs the bytes of a group of records.
+    typedef std::function<bool(const std::string&, std::string&)> Signer;
+    // Checks a group of records against its signature.
+    typedef std::function<bool(const std::string&, const std::string&)>
+        Verifier;
+
+private:
+    std::string folder_;
+    std::string file_;
+    int fd_ = -1;
+    std::string pending_;         // Framed records which aren't written yet.
+    std::size_t pending_count_ = 0;
+    std::size_t count_ = 0;       // Records already in the file.
+    int64_t sequence_ = 0;        // The last sequence number handed out.
+
+    static uint32_t checksum(const char* data, const std::size_t size);
+    static void frame(std::string& output, const int64_t& lSequence,
+                      const std::string& strData);
+
+    OTMarketJournal(const OTMarketJournal&) = delete;
+    OTMarketJournal& operator=(const OTMarketJournal&) = delete;
+
+public:
+    OTMarketJournal() = default;
+    ~OTMarketJournal();
+
+    bool IsOpen() const
+    {
+        return -1 != fd_;
+    }
+    bool HasPending() const
+    {
+        return 0 < pending_count_;
+    }
+    // Records since the last snapshot, including the ones not committed yet.
+    std::size_t Count() const
+    {
+        return count_ + pending_count_;
+    }
+    int64_t Sequence() const
+    {
+        return sequence_;
+    }
+    // Sequence numbers continue from here (if it is higher than the last one
+    // in the file.)
+    void SkipTo(const int64_t& lSequence)
+    {
+        if (lSequence > sequence_) sequence_ = lSequence;
+    }
+
+    bool Open(const String& strMarketID);
+    void Close();
+
+    // Reads every record in the file, oldest first. A group which is torn,
+    // or was never signed, at the end is cut off. Fails if the signature of
+    // any other group doesn't verify.
+    bool Read(vectorOfRecords& theRecords, const Verifier& verify);
+
+    // Returns the sequence number given to the record.
+    int64_t Append(const std::string& strRecord);
+    bool Commit(const Signer& sign);
+    // Empties the journal, pending records included. (Once a snapshot holds
+    // everything they describe.)
+    bool Clear();
+    // Replaces strFile, in the markets folder, with strContents. A crash
+    // leaves either the old or the new contents, and once this returns the
+    // new contents survive one. Snapshots are written this way so the
+    // journal can be emptied right after.
+    bool WriteFile(const std::string& strFile, const std::string& strContents);
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_TRADE_OTMARKETJOURNAL_HPP
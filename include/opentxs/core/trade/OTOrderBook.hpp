@@ -0,0 +1,138 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_CORE_TRADE_OTORDERBOOK_HPP
+#define OPENTXS_CORE_TRADE_OTORDERBOOK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace opentxs
+{
+
+class OTOffer;
+
+/** One side (the bids or the asks) of a market.
+ *
+ *  Limit orders are grouped into price levels, each holding its offers in the
+ *  order they were added along with the total amount they have available.
+ *  The levels are kept in a sorted vector with the best price at the back, so
+ *  the best price is read in constant time and the levels that usually come
+ *  and go (the ones near the top of the book) are cheap to add and remove.
+ *
+ *  Market orders have no price, so they wait in their own queue instead of
+ *  sitting below (or above) every real price.
+ *
+ *  The book doesn't own the offers; the market does.
+ */
+class OTOrderBook
+{
+public:
+    typedef std::deque<OTOffer*> dequeOfOffers;
+
+    class PriceLevel
+    {
+    public:
+        int64_t price_ = 0;
+        int64_t quantity_ = 0; // Sum of the amount available on every offer.
+        dequeOfOffers offers_; // First in line at the front.
+
+        explicit PriceLevel(const int64_t price)
+            : price_(price)
+        {
+        }
+    };
+
+private:
+    bool bids_ = false;
+    std::vector<PriceLevel> levels_; // Worst price first, best price last.
+    dequeOfOffers market_orders_;
+    std::size_t count_ = 0;
+
+    bool better(const int64_t lhs, const int64_t rhs) const;
+    std::vector<PriceLevel>::iterator find_level(const int64_t price);
+
+    OTOrderBook() = delete;
+    OTOrderBook(const OTOrderBook&) = delete;
+    OTOrderBook& operator=(const OTOrderBook&) = delete;
+
+public:
+    explicit OTOrderBook(const bool bids);
+
+    bool IsBids() const
+    {
+        return bids_;
+    }
+    // Number of offers, market orders included.
+    std::size_t Count() const
+    {
+        return count_;
+    }
+    std::size_t LevelCount() const
+    {
+        return levels_.size();
+    }
+    // Level 0 is the best price.
+    const PriceLevel& Level(const std::size_t index) const
+    {
+        return levels_[levels_.size() - 1 - index];
+    }
+    const dequeOfOffers& MarketOrders() const
+    {
+        return market_orders_;
+    }
+
+    // Returns 0 if there are no limit orders.
+    int64_t BestPrice() const;
+    // Total amount available across the whole side, market orders included.
+    int64_t TotalAvailable() const;
+
+    // The offer goes to the back of the line for its price.
+    void Add(OTOffer& theOffer);
+    // Must be called whenever an offer on the book trades, so the level
+    // total stays correct.
+    void Filled(const OTOffer& theOffer, const int64_t& lAmount);
+    bool Remove(const OTOffer& theOffer);
+    void Release();
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_CORE_TRADE_OTORDERBOOK_HPP
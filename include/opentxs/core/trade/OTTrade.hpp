@@ -207,6 +207,8 @@ public:
     // Return False if expired or otherwise should be removed.
     virtual bool ProcessCron(); // OTCron calls this regularly, which is my
                                 // chance to expire, etc.
+    virtual time64_t GetNextWakeTime() const;
+    virtual bool GetCronResources(std::set<std::string>& output) const;
     virtual bool CanRemoveItemFromCron(Nym& nym);
 
     // From OTScriptable, we override this function. OTScriptable now does fancy
@@ -0,0 +1,87 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_LATENCYHISTOGRAM_HPP
+#define OPENTXS_SERVER_LATENCYHISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace opentxs
+{
+
+// Counts how long something took, in power of two buckets of microseconds.
+// Bucket 0 holds zero, and bucket i holds [2^(i-1), 2^i). Recording only
+// uses relaxed atomics, so worker threads never wait on each other, and a
+// reader may see a sample in one counter a moment before the others.
+class LatencyHistogram
+{
+public:
+    static const std::size_t Buckets = 40;
+
+    LatencyHistogram();
+
+    void Record(uint64_t microseconds);
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Total() const { return total_.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t Bucket(std::size_t bucket) const;
+
+    // The smallest bucket bound, in microseconds, that at least fraction of
+    // the samples fall under.
+    uint64_t Percentile(double fraction) const;
+
+    // Largest value that falls in a bucket.
+    static uint64_t UpperBound(std::size_t bucket);
+
+private:
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    std::array<std::atomic<uint64_t>, Buckets> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> max_;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_LATENCYHISTOGRAM_HPP
@@ -39,8 +39,11 @@
 #ifndef OPENTXS_SERVER_MESSAGEPROCESSOR_HPP
 #define OPENTXS_SERVER_MESSAGEPROCESSOR_HPP
 
+#include "opentxs/server/RequestLocks.hpp"
+
 #include <czmq.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -52,6 +55,7 @@ typedef struct _zpoller_t zpoller_t;
 namespace opentxs
 {
 
+class Message;
 class ServerLoader;
 class OTServer;
 
@@ -63,15 +67,28 @@ public:
     EXPORT void run();
 
 private:
+    // Commands which may only write to the sender's own Nymfile and boxes,
+    // and to the Nym or account explicitly named in the request
+    static bool isSharedCommand(const Message& message);
+    static RequestLocks::Keys requestKeys(const Message& message);
+
     void init(int port, zcert_t* transportKey);
+    void forward(zsock_t* from, zsock_t* to);
     bool processMessage(const std::string& messageString, std::string& reply);
-    void processSocket();
+    void processSocket(zsock_t* socket);
+    void runCron();
+    void runWorker();
 
 private:
     OTServer* server_;
-    zsock_t* zmqSocket_;
+    // Clients connect to the ROUTER frontend, requests are fanned out to the
+    // worker threads through the DEALER backend.
+    zsock_t* zmqFrontend_;
+    zsock_t* zmqBackend_;
     zactor_t* zmqAuth_;
     zpoller_t* zmqPoller_;
+    RequestLocks locks_;
+    std::atomic<bool> running_;
 };
 
 } // namespace opentxs
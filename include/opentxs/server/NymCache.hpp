@@ -0,0 +1,146 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_NYMCACHE_HPP
+#define OPENTXS_SERVER_NYMCACHE_HPP
+
+#include "opentxs/core/Nym.hpp"
+#include "opentxs/core/String.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+// Keeps the Nyms of recent clients loaded between requests, so that a
+// returning client doesn't cost a credential load, a pseudonym verification
+// and a signed nymfile load every time. Entries are checked out one request
+// at a time through Lock. Saving a nymfile through a different Nym object
+// evicts the cached copy, and so does a request that leaves the cached Nym
+// different from what was last saved.
+class NymCache
+{
+private:
+    class Entry
+    {
+    public:
+        explicit Entry(const String& nymID);
+
+        std::mutex lock_;
+        Nym nym_;
+        String saved_;
+        bool loaded_;
+        std::atomic<bool> stale_;
+        std::list<std::string>::iterator lru_;
+    };
+
+public:
+    // Holds one Nym for the length of a request.
+    class Lock
+    {
+    public:
+        Nym& It() { return entry_->nym_; }
+
+        // True when the Nym was already loaded and verified by an earlier
+        // request.
+        bool IsLoaded() const { return entry_->loaded_; }
+
+        // Called once the Nym has been loaded and verified, so the next
+        // request for it can skip that work.
+        void Loaded();
+
+        ~Lock();
+
+    private:
+        friend class NymCache;
+
+        Lock(NymCache& cache, const std::string& nymID,
+             const std::shared_ptr<Entry>& entry);
+
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+
+        NymCache& cache_;
+        std::string nymID_;
+        std::shared_ptr<Entry> entry_;
+        std::unique_lock<std::mutex> lock_;
+    };
+
+    explicit NymCache(std::size_t capacity);
+    ~NymCache();
+
+    // Blocks while another request is using the same Nym.
+    std::unique_ptr<Lock> Get(const String& nymID);
+
+    // Drops the cached copy of a Nym, if there is one.
+    void Invalidate(const String& nymID);
+
+    uint64_t Hits() const { return hits_; }
+    uint64_t Misses() const { return misses_; }
+    uint64_t Evictions() const { return evictions_; }
+    uint64_t Invalidations() const { return invalidations_; }
+
+private:
+    NymCache(const NymCache&) = delete;
+    NymCache& operator=(const NymCache&) = delete;
+
+    void Saved(const Nym& nym, const String& contents);
+    void erase(const std::string& nymID, const std::shared_ptr<Entry>& entry);
+
+    const std::size_t capacity_;
+    std::mutex lock_;
+    std::map<std::string, std::shared_ptr<Entry>> nyms_;
+    // Most recently used at the front.
+    std::list<std::string> lru_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> evictions_;
+    std::atomic<uint64_t> invalidations_;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_NYMCACHE_HPP
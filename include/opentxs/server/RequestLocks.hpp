@@ -0,0 +1,112 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_REQUESTLOCKS_HPP
+#define OPENTXS_SERVER_REQUESTLOCKS_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace opentxs
+{
+
+// Serializes server work on a per-resource basis.
+//
+// Each request processed by a MessageProcessor worker names the resources
+// (Nym IDs and account IDs) it touches. Requests whose key sets are disjoint
+// run concurrently, and requests sharing any key are serialized.
+//
+// Work which may touch arbitrary resources (cron, and commands which write to
+// accounts or Nymfiles belonging to other parties) instead takes the table
+// exclusively, which waits for all in-flight requests to finish and blocks
+// new ones until it is released.
+//
+// Keys are acquired all-or-nothing under a single mutex, so overlapping key
+// sets can never deadlock regardless of the order they are listed in.
+class RequestLocks
+{
+public:
+    typedef std::set<std::string> Keys;
+
+    // RAII holder for either a set of keys or the exclusive lock
+    class Lock
+    {
+    public:
+        Lock(RequestLocks& parent, const Keys& keys);
+        explicit Lock(RequestLocks& parent);
+        ~Lock();
+
+    private:
+        RequestLocks& parent_;
+        const Keys keys_;
+        const bool exclusive_;
+
+        Lock() = delete;
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    RequestLocks() = default;
+
+    void Acquire(const Keys& keys);
+    void AcquireExclusive();
+    void Release(const Keys& keys);
+    void ReleaseExclusive();
+
+private:
+    std::mutex lock_;
+    std::condition_variable released_;
+    Keys held_;
+    // number of requests currently holding a (possibly empty) key set
+    uint32_t active_ = 0;
+    // number of threads waiting for exclusive access
+    uint32_t waiting_exclusive_ = 0;
+    bool exclusive_ = false;
+
+    bool Available(const Keys& keys) const;
+
+    RequestLocks(const RequestLocks&) = delete;
+    RequestLocks& operator=(const RequestLocks&) = delete;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_REQUESTLOCKS_HPP
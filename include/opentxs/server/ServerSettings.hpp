@@ -77,6 +77,46 @@ struct ServerSettings
         __heartbeat_ms_between_beats = value;
     }
 
+    static int32_t GetWorkerThreads()
+    {
+        return __worker_threads;
+    }
+
+    static void SetWorkerThreads(int32_t value)
+    {
+        __worker_threads = value;
+    }
+
+    static int64_t GetTransactionNumberBlock()
+    {
+        return __transaction_number_block;
+    }
+
+    static void SetTransactionNumberBlock(int64_t value)
+    {
+        __transaction_number_block = value;
+    }
+
+    static int64_t GetNymCacheSize()
+    {
+        return __nym_cache_size;
+    }
+
+    static void SetNymCacheSize(int64_t value)
+    {
+        __nym_cache_size = value;
+    }
+
+    static int64_t GetWorkingSetSize()
+    {
+        return __working_set_size;
+    }
+
+    static void SetWorkingSetSize(int64_t value)
+    {
+        __working_set_size = value;
+    }
+
     static const std::string& GetOverrideNymID()
     {
         return __override_nym_id;
@@ -92,6 +132,18 @@ struct ServerSettings
     static int32_t __heartbeat_no_requests;
     static int32_t __heartbeat_ms_between_beats;
 
+    // The number of threads processing client requests in parallel.
+    static int32_t __worker_threads;
+
+    // How many transaction numbers are reserved in the notary file at once.
+    static int64_t __transaction_number_block;
+
+    // How many client Nyms are kept loaded between requests. 0 disables it.
+    static int64_t __nym_cache_size;
+
+    // Megabytes of account and box files kept in memory. 0 disables it.
+    static int64_t __working_set_size;
+
     // The Nym who's allowed to do certain commands even if they are turned off.
     static std::string __override_nym_id;
     // Are usage credits REQUIRED in order to use this server?
@@ -146,6 +198,8 @@ struct ServerSettings
     static bool __transact_cancel_cron_item;
     static bool __transact_smart_contract;
     static bool __cmd_trigger_clause;
+    // Per command latency. Off by default, so only the override Nym sees it.
+    static bool __cmd_get_command_stats;
 };
 
 } // namespace opentxs
@@ -0,0 +1,88 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_SERVER_TRANSACTIONNUMBERLEASE_HPP
+#define OPENTXS_SERVER_TRANSACTIONNUMBERLEASE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace opentxs
+{
+
+// Issues transaction numbers from memory, reserving them in blocks. Lease()
+// is the highest number reserved so far, and is what has to be durable: when
+// the lease runs out, the next block is reserved and saved BEFORE any number
+// from it is handed out, so a number is never issued twice, even across a
+// restart. Next() may be called from several threads.
+class TransactionNumberLease
+{
+public:
+    // Makes the current Lease() durable. Called with the lock held.
+    typedef std::function<bool()> SaveLease;
+
+    explicit TransactionNumberLease(const SaveLease& save);
+
+    // Issues the number after Last(), first reserving blockSize more numbers
+    // if the lease has run out. Returns false if the new lease wasn't saved.
+    bool Next(int64_t blockSize, int64_t& number);
+
+    // Used when loading a saved lease. Numbers are issued starting just past
+    // it, since any numbers below it may already have been handed out.
+    void Reset(int64_t lease);
+
+    // The last number issued.
+    int64_t Last() const { return last_; }
+    int64_t Lease() const { return lease_; }
+
+private:
+    TransactionNumberLease(const TransactionNumberLease&) = delete;
+    TransactionNumberLease& operator=(const TransactionNumberLease&) = delete;
+
+    SaveLease save_;
+    // Both are atomic because save_ typically reads them while lock_ is held.
+    std::atomic<int64_t> last_;
+    std::atomic<int64_t> lease_;
+    std::mutex lock_;
+};
+
+} // namespace opentxs
+
+#endif // OPENTXS_SERVER_TRANSACTIONNUMBERLEASE_HPP
@@ -40,6 +40,7 @@
 #define OPENTXS_SERVER_TRANSACTOR_HPP
 
 #include "opentxs/core/AccountList.hpp"
+#include "opentxs/server/TransactionNumberLease.hpp"
 
 #include <cstdint>
 #include <map>
@@ -74,12 +75,22 @@ public:
 
     int64_t transactionNumber() const
     {
-        return transactionNumber_;
+        return transactionNumbers_.Last();
     }
 
+    // Used when loading the notary file. Numbers are issued starting just
+    // past the saved lease, since any numbers between the last one issued
+    // and the lease may already have been handed out before a restart.
     void transactionNumber(int64_t value)
     {
-        transactionNumber_ = value;
+        transactionNumbers_.Reset(value);
+    }
+
+    // The highest transaction number reserved so far. This is what the
+    // notary file stores.
+    int64_t transactionNumberLease() const
+    {
+        return transactionNumbers_.Lease();
     }
 
     bool addBasketAccountID(const Identifier& basketId,
@@ -133,8 +144,9 @@ private:
     typedef std::map<std::string, std::string> BasketsMap;
 
 private:
-    // This stores the last VALID AND ISSUED transaction number.
-    int64_t transactionNumber_;
+    // Numbers are reserved in blocks: the notary file is only saved when
+    // the last VALID AND ISSUED transaction number would pass the lease.
+    TransactionNumberLease transactionNumbers_;
     // maps basketId with basketAccountId
     BasketsMap idToBasketMap_;
     // basket issuer account ID, which is *different* on each server, using the
@@ -39,10 +39,21 @@
 #ifndef OPENTXS_SERVER_USERCOMMANDPROCESSOR_HPP
 #define OPENTXS_SERVER_USERCOMMANDPROCESSOR_HPP
 
+#include "opentxs/server/LatencyHistogram.hpp"
+#include "opentxs/server/NymCache.hpp"
+
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace opentxs
 {
+enum class MessageEncoding : std::uint8_t;
+
 class String;
 class Message;
 class Nym;
@@ -55,10 +66,56 @@ class UserCommandProcessor
 public:
     UserCommandProcessor(OTServer* server);
 
+    // Called once the server config is loaded.
+    void Init();
+
     bool ProcessUserCommand(Message& msgIn, Message& msgOut,
                             ClientConnection* connection, Nym* nym);
 
+    // Records one request and its reply, from decoding the request to
+    // encoding the reply.
+    void RecordWire(MessageEncoding encoding, std::size_t requestBytes,
+                    std::size_t replyBytes, uint64_t microseconds);
+
 private:
+    typedef void (UserCommandProcessor::*Handler)(Nym&, Message&, Message&);
+
+    class WireStats
+    {
+    public:
+        WireStats();
+
+        LatencyHistogram latency_;
+        std::atomic<uint64_t> requestBytes_;
+        std::atomic<uint64_t> replyBytes_;
+
+    private:
+        WireStats(const WireStats&) = delete;
+        WireStats& operator=(const WireStats&) = delete;
+    };
+
+    class Command
+    {
+    public:
+        std::string name_;
+        Handler handler_;
+        // The Nym needs all of these, unless it's the override Nym.
+        std::vector<const bool*> permissions_;
+        // For commands whose permission depends on the request. Returning
+        // null means there is nothing to do.
+        const bool* (*permission_)(const Message&);
+    };
+
+    // Every command the server knows, indexed by command id.
+    static const std::vector<Command>& Commands();
+    // Command ids, by name.
+    static const std::unordered_map<std::string, std::size_t>& CommandIDs();
+    static const bool* BoxReceiptPermission(const Message& msgIn);
+
+    bool processUserCommand(const Command* command, Message& msgIn,
+                            Message& msgOut, ClientConnection* connection,
+                            Nym* nym);
+
     bool SendMessageToNym(const Identifier& notaryID,
                           const Identifier& senderNymID,
                           const Identifier& recipientNymID,
@@ -82,14 +139,15 @@ private:
     void UserCmdRegisterInstrumentDefinition(Nym& nym, Message& msgIn,
                                              Message& msgOut);
     void UserCmdIssueBasket(Nym& nym, Message& msgIn, Message& msgOut);
-    void UserCmdGetBoxReceipt(Message& msgIn, Message& msgOut);
+    void UserCmdGetBoxReceipt(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdDeleteUser(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdDeleteAssetAcct(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdRegisterAccount(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdNotarizeTransaction(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdGetNymbox(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdGetAccountData(Nym& nym, Message& msgIn, Message& msgOut);
-    void UserCmdGetInstrumentDefinition(Message& msgIn, Message& msgOut);
+    void UserCmdGetInstrumentDefinition(Nym& nym, Message& msgIn,
+                                        Message& msgOut);
     void UserCmdGetMint(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdProcessInbox(Nym& nym, Message& msgIn, Message& msgOut);
     void UserCmdProcessNymbox(Nym& nym, Message& msgIn, Message& msgOut);
@@ -113,8 +171,17 @@ private:
     // Get the offers that a specific Nym has placed on a specific market.
     void UserCmdGetNymMarketOffers(Nym& nym, Message& msgIn, Message& msgOut);
 
+    // Per command processing time, for the server operator.
+    void UserCmdGetCommandStats(Nym& nym, Message& msgIn, Message& msgOut);
+
 private:
     OTServer* server_;
+    // Verified client Nyms kept between requests. Null when disabled.
+    std::unique_ptr<NymCache> nymCache_;
+    // Processing time of each command, indexed by command id.
+    std::vector<LatencyHistogram> latency_;
+    // Bytes and time per request, indexed by MessageEncoding.
+    WireStats wire_[2];
 };
 
 } // namespace opentxs
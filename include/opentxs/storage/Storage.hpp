@@ -40,6 +40,7 @@
 #define OPENTXS_STORAGE_STORAGE_HPP
 
 #include "opentxs/core/Proto.hpp"
+#include "opentxs/storage/StorageCache.hpp"
 #include "opentxs/storage/StorageConfig.hpp"
 
 #include <atomic>
@@ -54,6 +55,8 @@
 #include <string>
 #include <thread>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -107,6 +110,9 @@ bool LoadProto(
         return false;
     }
 
+    // Objects are immutable, so a cached copy is always current
+    if (cache_.Get(hash, serialized)) { return true; }
+
     bool attemptFirst;
     if (gc_running_.load() ) {
         attemptFirst = !current_bucket_;
@@ -146,7 +152,13 @@ bool LoadProto(
                   << "Size: " << data.size() << std::endl;
     }
 
-    return (foundInPrimary || foundInSecondary);
+    if (foundInPrimary || foundInSecondary) {
+        cache_.Insert(hash, *serialized, data.size());
+
+        return true;
+    }
+
+    return false;
 }
 
 template<class T>
@@ -193,8 +205,47 @@ private:
      */
     typedef std::map<std::string, Metadata> Index;
 
+    /** Index tree node types, which determine how garbage collection finds
+     *  the children of a node */
+    enum class GCNode : uint8_t {
+        ITEMS,
+        CREDENTIALS,
+        NYMLIST,
+        NYM,
+        SEEDS,
+        SERVERS,
+        UNITS,
+        LEAF
+    };
+
+    /** A unit of garbage collection work
+     *  * string: hash of the object to migrate
+     *  * GCNode: type of the object
+     */
+    typedef std::pair<std::string, GCNode> GCWork;
+
+    // Groups every backend write made during its lifetime into a single
+    // backend transaction. Must only be constructed while holding
+    // write_lock_. Nested instances join the outermost batch.
+    class Batch
+    {
+    public:
+        explicit Batch(Storage& storage);
+        ~Batch();
+
+    private:
+        Storage& storage_;
+
+        Batch() = delete;
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+
     static Storage* instance_pointer_;
 
+    uint32_t batch_depth_ = 0; // protected by write_lock_
+    bool batch_open_ = false; // protected by write_lock_
+
     std::thread* gc_thread_ = nullptr;
     int64_t gc_interval_ = std::numeric_limits<int64_t>::max();
 
@@ -202,6 +253,11 @@ private:
     Storage& operator=(const Storage&) = delete;
 
     void CollectGarbage();
+    // Push the children of an index node onto the garbage collection stack
+    bool ExpandGCNode(const GCWork& work, std::vector<GCWork>& stack);
+    // Persist and retrieve the position of an interrupted collection run
+    bool LoadGCCursor(const std::string& gcroot, uint64_t& position) const;
+    bool StoreGCCursor(const std::string& gcroot, const uint64_t position);
     bool MigrateKey(const std::string& key);
     // Regenerate in-memory indices by recursively loading index objects
     // starting from the root hash
@@ -268,6 +324,8 @@ protected:
     std::mutex unit_lock_; // ensures atomic writes to units_
     std::mutex write_lock_; // ensure atomic writes
 
+    StorageCache cache_;
+
     std::string root_hash_;
     std::string old_gc_root_; // used if a previous run of gc did not finish
     std::string items_;
@@ -294,6 +352,10 @@ protected:
     // Pure virtual functions for implementation by child classes
     virtual std::string LoadRoot() const = 0;
     virtual bool StoreRoot(const std::string& hash) = 0;
+    // The garbage collection cursor changes in place, so like the root hash
+    // it is kept outside the content-addressed buckets
+    virtual std::string LoadCursor() const = 0;
+    virtual bool StoreCursor(const std::string& cursor) = 0;
     virtual bool Load(
         const std::string& key,
         std::string& value,
@@ -304,6 +366,14 @@ protected:
         const bool bucket) const = 0;
     virtual bool EmptyBucket(const bool bucket) = 0;
 
+    // Optional write batching for backends which support transactions.
+    // All Store() and StoreRoot() calls made between BeginBatch() and
+    // CommitBatch() should become durable together. If CommitBatch() fails
+    // none of them should. CommitBatch() is only called if BeginBatch()
+    // succeeded.
+    virtual bool BeginBatch() { return true; }
+    virtual bool CommitBatch() { return true; }
+
 public:
     /** A list of object IDs and their associated aliases
      *  * string: id of the stored object
@@ -316,6 +386,12 @@ public:
         const Digest& hash,
         const Random& random,
         const StorageConfig& config);
+    // Creates a separate instance of the configured backend, e.g. for a test
+    // or a tool which must not share the singleton. The caller owns it.
+    static Storage* Instantiate(
+        const Digest& hash,
+        const Random& random,
+        const StorageConfig& config);
 
     std::string DefaultSeed();
     bool Load(
@@ -358,6 +434,8 @@ public:
         std::shared_ptr<proto::UnitDefinition>& contract,
         std::string& alias,
         const bool checking = false); // If true, suppress "not found" errors
+    uint64_t CacheHits() const { return cache_.Hits(); }
+    uint64_t CacheMisses() const { return cache_.Misses(); }
     void MapPublicNyms(NymLambda& lambda);
     void MapServers(ServerLambda& lambda);
     void MapUnitDefinitions(UnitLambda& lambda);
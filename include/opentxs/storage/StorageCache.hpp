@@ -0,0 +1,145 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGECACHE_HPP
+#define OPENTXS_STORAGE_STORAGECACHE_HPP
+
+#include <google/protobuf/message_lite.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace opentxs
+{
+
+// Size-bounded cache of deserialized, validated storage objects
+//
+// Stored objects are immutable and keyed by the hash of their serialized
+// form, so a cached entry never needs to be invalidated: a modified object
+// has a different key.
+//
+// The cache is split into shards, each with its own lock and LRU list, so
+// that concurrent readers of different objects do not contend. Each shard is
+// bounded to an equal part of the total capacity, measured in serialized
+// bytes.
+//
+// Cached objects are never handed out directly. Callers receive a copy,
+// since several Storage methods modify loaded index objects in place.
+class StorageCache
+{
+public:
+    typedef std::shared_ptr<const ::google::protobuf::MessageLite> Object;
+
+    explicit StorageCache(const std::size_t capacity);
+
+    template<class T>
+    bool Get(const std::string& hash, std::shared_ptr<T>& output)
+    {
+        if (0 == capacity_) { return false; }
+
+        auto typed = std::dynamic_pointer_cast<const T>(Find(hash));
+
+        if (!typed) {
+            misses_++;
+
+            return false;
+        }
+
+        hits_++;
+        output.reset(new T(*typed));
+
+        return true;
+    }
+
+    template<class T>
+    void Insert(const std::string& hash, const T& object, const std::size_t size)
+    {
+        if (0 == capacity_) { return; }
+
+        Add(hash, Object(new T(object)), size);
+    }
+
+    void Clear();
+    uint64_t Hits() const { return hits_.load(); }
+    uint64_t Misses() const { return misses_.load(); }
+
+private:
+    static const std::size_t SHARD_COUNT = 16;
+
+    /** A cached object
+     *  * string: hash of the object
+     *  * Object: the deserialized object
+     *  * size_t: serialized size of the object
+     */
+    typedef std::tuple<std::string, Object, std::size_t> Entry;
+    typedef std::list<Entry> LRU;
+
+    struct Shard {
+        std::mutex lock_;
+        // most recently used entries are at the front
+        LRU lru_;
+        std::unordered_map<std::string, LRU::iterator> index_;
+        std::size_t size_ = 0;
+    };
+
+    const std::size_t capacity_;
+    const std::size_t shard_capacity_;
+    std::array<Shard, SHARD_COUNT> shards_;
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+
+    Shard& GetShard(const std::string& hash);
+    void Add(const std::string& hash, const Object& object, std::size_t size);
+    Object Find(const std::string& hash);
+
+    StorageCache() = delete;
+    StorageCache(const StorageCache&) = delete;
+    StorageCache& operator=(const StorageCache&) = delete;
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGECACHE_HPP
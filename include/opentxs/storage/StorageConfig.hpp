@@ -39,6 +39,7 @@
 #ifndef OPENTXS_STORAGE_STORAGECONFIG_HPP
 #define OPENTXS_STORAGE_STORAGECONFIG_HPP
 
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -53,7 +54,13 @@ public:
     bool auto_publish_nyms_ = true;
     bool auto_publish_servers_ = true;
     bool auto_publish_units_ = true;
+    // maximum size in bytes of the cache of loaded objects (0 to disable)
+    int64_t cache_size_ = 32 * 1024 * 1024;
     int64_t gc_interval_ = 60 * 60 * 1;
+    // maximum number of objects garbage collection copies per step
+    int64_t gc_step_size_ = 1000;
+    // milliseconds garbage collection pauses between steps
+    int64_t gc_step_delay_ = 100;
     std::string path_;
     InsertCB dht_callback_;
 
@@ -61,6 +68,14 @@ public:
     std::string fs_primary_bucket_ = "a";
     std::string fs_secondary_bucket_ = "b";
     std::string fs_root_file_ = "root";
+    std::string fs_gc_cursor_file_ = "gc_cursor";
+#endif
+
+#ifdef OT_STORAGE_LOG
+    std::string log_primary_bucket_ = "a.log";
+    std::string log_secondary_bucket_ = "b.log";
+    std::string log_root_file_ = "root";
+    std::string log_gc_cursor_file_ = "gc_cursor";
 #endif
 
 #ifdef OT_STORAGE_SQLITE
@@ -68,6 +83,7 @@ public:
     std::string sqlite3_secondary_bucket_ = "b";
     std::string sqlite3_control_table_ = "control";
     std::string sqlite3_root_key_ = "a";
+    std::string sqlite3_gc_cursor_key_ = "gc_cursor";
     std::string sqlite3_db_file_ = "opentxs.sqlite3";
 #endif
 };
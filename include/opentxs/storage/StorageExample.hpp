@@ -82,8 +82,10 @@ class StorageConfig;
  *  methods. Ensure these methods are thread safe.
  *
  *  \par Root Hash
- *  The root hash is the only exception to the general rule of immutable values.
- *  See the description of the \ref LoadRoot and \ref StoreRoot methods for details.
+ *  The root hash and the garbage collection cursor are the only exceptions to
+ *  the general rule of immutable values. See the description of the
+ *  \ref LoadRoot, \ref StoreRoot, \ref LoadCursor and \ref StoreCursor
+ *  methods for details.
  *
  *  \par Configuration
  *  Define all needed runtime configuration parameters in the
@@ -173,6 +175,26 @@ public:
      */
     bool StoreRoot(const std::string& hash) override;
 
+    /** Obtain the most current value of the garbage collection cursor
+     *  \returns The value most recently provided to the \ref StoreCursor
+     *           method, or an empty string
+     *
+     *  \par Implementation
+     *  The cursor is overwritten while a collection run progresses, so it
+     *  must be stored the same way as the root hash rather than in a bucket.
+     */
+    std::string LoadCursor() const override;
+
+    /** Record a new value for the garbage collection cursor
+     *  \param[in] cursor the new cursor
+     *  \returns true if the new value has been stored in the backend
+     *
+     *  \par Implementation
+     *  Objects stored before this call must be durable before the new value
+     *  is.
+     */
+    bool StoreCursor(const std::string& cursor) override;
+
     using ot_super::Load; // Required for overload resolution
 
     /** Retrieve a previously-stored value
@@ -72,11 +72,16 @@ private:
 
     void Init_StorageFS();
     void Purge(const std::string& path);
+    // Read or replace a control file (root hash, gc cursor) in folder_
+    std::string ReadFile(const std::string& name) const;
+    bool WriteFile(const std::string& name, const std::string& value);
 
     void Cleanup_StorageFS();
 public:
     std::string LoadRoot() const override;
     bool StoreRoot(const std::string& hash) override;
+    std::string LoadCursor() const override;
+    bool StoreCursor(const std::string& cursor) override;
     using ot_super::Load;
     bool Load(
         const std::string& key,
@@ -0,0 +1,168 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifndef OPENTXS_STORAGE_STORAGELOG_HPP
+#define OPENTXS_STORAGE_STORAGELOG_HPP
+
+#include "opentxs/storage/Storage.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace opentxs
+{
+
+class StorageConfig;
+
+// Log-structured implementation of opentxs::storage
+//
+// Each bucket is a single append-only segment file of records:
+//
+//   [magic (4 bytes)][key size (4 bytes)][value size (4 bytes)][key][value]
+//
+// The segment is memory mapped for reads, and an in-memory hash index of
+// key -> (offset, size) is rebuilt by scanning the mapped segment on startup.
+// Since keys are content hashes, a key which is already present is never
+// appended twice.
+//
+// Compaction happens through the normal garbage collection cycle: live
+// objects are migrated into the other bucket's segment, after which
+// EmptyBucket() truncates the old segment to zero.
+//
+// A partially written record at the end of a segment (from a crash) is
+// discarded when the segment is opened. The segments are synced before the
+// root hash is replaced, so the root never refers to unsynced data. Only
+// segments with appends since their last sync are synced again.
+class StorageLog : public Storage
+{
+private:
+    typedef Storage ot_super;
+
+    friend Storage;
+
+    /** Location of a value in a segment
+     *  * size_t: offset of the value from the start of the segment
+     *  * size_t: size of the value
+     */
+    typedef std::pair<std::size_t, std::size_t> Position;
+
+    struct Segment {
+        std::mutex lock_;
+        std::string filename_;
+        int fd_ = -1;
+        // bytes of complete records in the file
+        std::size_t size_ = 0;
+        // the file has changed since it was last synced
+        bool dirty_ = false;
+        const char* map_ = nullptr;
+        std::size_t mapped_ = 0;
+        std::unordered_map<std::string, Position> index_;
+    };
+
+    static const uint32_t RECORD_MAGIC = 0x4f544c47; // "OTLG"
+    static const std::size_t HEADER_SIZE = 3 * sizeof(uint32_t);
+    // Segments are mapped in multiples of this size so that appends do not
+    // require remapping on every read
+    static const std::size_t MAP_INCREMENT = 64 * 1024 * 1024;
+
+    std::string folder_;
+    mutable std::array<Segment, 2> segments_;
+
+    Segment& GetSegment(const bool bucket) const
+    {
+        return segments_[bucket ? 1 : 0];
+    }
+
+    StorageLog() = delete;
+    StorageLog(
+        const StorageConfig& config,
+        const Digest& hash,
+        const Random& random);
+    StorageLog(const StorageLog&) = delete;
+    StorageLog& operator=(const StorageLog&) = delete;
+
+    bool Append(
+        Segment& segment,
+        const std::string& key,
+        const std::string& value) const;
+    void Close(Segment& segment) const;
+    bool Open(Segment& segment, const std::string& filename) const;
+    bool Remap(Segment& segment, const std::size_t size) const;
+    // Read or atomically replace a control file (root hash, gc cursor)
+    std::string ReadFile(const std::string& name) const;
+    bool ReplaceFile(const std::string& name, const std::string& value);
+    bool Sync(Segment& segment) const;
+    bool SyncFolder() const;
+    bool Write(
+        const int fd,
+        const std::string& data,
+        const std::string& filename) const;
+
+    void Init_StorageLog();
+
+    void Cleanup_StorageLog();
+
+public:
+    std::string LoadRoot() const override;
+    bool StoreRoot(const std::string& hash) override;
+    std::string LoadCursor() const override;
+    bool StoreCursor(const std::string& cursor) override;
+    using ot_super::Load;
+    bool Load(
+        const std::string& key,
+        std::string& value,
+        const bool bucket) const override;
+    using ot_super::Store;
+    bool Store(
+        const std::string& key,
+        const std::string& value,
+        const bool bucket) const override;
+    bool EmptyBucket(const bool bucket) override;
+    bool CommitBatch() override;
+
+    void Cleanup() override;
+    ~StorageLog();
+};
+
+}  // namespace opentxs
+#endif // OPENTXS_STORAGE_STORAGELOG_HPP
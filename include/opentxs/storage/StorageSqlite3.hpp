@@ -41,6 +41,9 @@
 
 #include "opentxs/storage/Storage.hpp"
 
+#include <map>
+#include <mutex>
+#include <string>
 
 extern "C"
 {
@@ -60,9 +63,28 @@ private:
 
     friend Storage;
 
+    /** Prepared statements for a query, keyed by table name
+     *
+     *  Every statement runs under db_lock_, so one cached statement per table
+     *  is enough.
+     */
+    typedef std::map<std::string, sqlite3_stmt*> StatementCache;
+
     std::string folder_;
     sqlite3* db_ = nullptr;
 
+    /** Serializes statements on db_
+     *
+     *  A transaction belongs to the connection rather than to the thread
+     *  which opened it, so while a batch is open no other thread may run a
+     *  statement on db_. BeginBatch() acquires this lock and CommitBatch()
+     *  releases it, and the batching thread re-enters it for each statement.
+     */
+    mutable std::recursive_mutex db_lock_;
+
+    mutable StatementCache select_statements_;
+    mutable StatementCache upsert_statements_;
+
     std::string GetTableName(const bool bucket) const
     {
         return bucket ?
@@ -88,12 +110,20 @@ private:
         const std::string& value) const;
     bool Create(const std::string& tablename);
     bool Purge(const std::string& tablename);
+    sqlite3_stmt* Statement(
+        StatementCache& cache,
+        const std::string& tablename,
+        const std::string& query) const;
+    void FinalizeStatements(const std::string& tablename);
+    void FinalizeStatements();
 
     void Init_StorageSqlite3();
 
 public:
     std::string LoadRoot() const override;
     bool StoreRoot(const std::string& hash) override;
+    std::string LoadCursor() const override;
+    bool StoreCursor(const std::string& cursor) override;
     using ot_super::Load;
     bool Load(
         const std::string& key,
@@ -105,6 +135,8 @@ public:
         const std::string& value,
         const bool bucket) const override;
     bool EmptyBucket(const bool bucket) override;
+    bool BeginBatch() override;
+    bool CommitBatch() override;
 
     void Cleanup_StorageSqlite3();
     void Cleanup() override;
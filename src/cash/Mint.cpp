@@ -61,6 +61,7 @@
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -846,4 +847,46 @@ void Mint::GenerateNewMint(int32_t nSeries, time64_t VALID_FROM,
     }
 }
 
+// With Lucre, the first token of each denomination unseals its private info,
+// and the rest reuse it. So a purse costs one unsealing per denomination
+// instead of one per token.
+bool Mint::SignTokens(Nym& theNotary, const std::vector<Token*>& theTokens,
+                      std::vector<String>& theOutput, int32_t nTokenIndex)
+{
+    theOutput.clear();
+    theOutput.reserve(theTokens.size());
+
+    for (auto& pToken : theTokens) {
+        OT_ASSERT(nullptr != pToken);
+
+        String strSignature;
+
+        if (!SignToken(theNotary, *pToken, strSignature, nTokenIndex)) {
+            return false;
+        }
+
+        theOutput.push_back(strSignature);
+    }
+
+    return true;
+}
+
+bool Mint::VerifyTokens(Nym& theNotary, std::vector<String>& theCleartextTokens,
+                        const std::vector<int64_t>& theDenominations)
+{
+    if (theCleartextTokens.size() != theDenominations.size()) {
+        otErr << __FUNCTION__ << ": Token and denomination counts differ.\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < theCleartextTokens.size(); ++i) {
+        if (!VerifyToken(theNotary, theCleartextTokens[i],
+                         theDenominations[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace opentxs
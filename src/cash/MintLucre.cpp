@@ -56,7 +56,10 @@
 #include <openssl/ossl_typ.h>
 #include <stdio.h>
 #include <sys/types.h>
+#include <memory>
+#include <mutex>
 #include <ostream>
+#include <string>
 
 #ifdef __APPLE__
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -189,36 +192,62 @@ bool MintLucre::AddDenomination(Nym& theNotary, int64_t lDenomination,
 
 #if defined(OT_CRYPTO_USING_OPENSSL)
 
-// Lucre step 3: the mint signs the token
-//
-bool MintLucre::SignToken(Nym& theNotary, Token& theToken, String& theOutput,
-                          int32_t nTokenIndex)
+// Call with banks_lock_ held. Returns nullptr if the denomination is unknown or
+// its private info cannot be unsealed.
+Bank* MintLucre::GetBank(Nym& theNotary, int64_t lDenomination)
 {
-    bool bReturnValue = false;
+    OTASCIIArmor thePrivate;
 
-    LucreDumper setDumper;
+    if (!GetPrivate(thePrivate, lDenomination)) return nullptr;
 
-    OpenSSL_BIO bioBank = BIO_new(BIO_s_mem());      // input
-    OpenSSL_BIO bioRequest = BIO_new(BIO_s_mem());   // input
-    OpenSSL_BIO bioSignature = BIO_new(BIO_s_mem()); // output
+    const std::string strPrivate(thePrivate.Get());
+    auto it = banks_.find(lDenomination);
 
-    OTASCIIArmor thePrivate;
-    GetPrivate(thePrivate, theToken.GetDenomination());
+    if ((banks_.end() != it) && (it->second.private_ == strPrivate)) {
+        return it->second.bank_.get();
+    }
 
-    // The Mint private info is encrypted in
-    // m_mapPrivates[theToken.GetDenomination()].
+    // The Mint private info is encrypted in m_mapPrivate[lDenomination].
     // So I need to extract that first before I can use it.
     OTEnvelope theEnvelope(thePrivate);
 
     String strContents; // output from opening the envelope.
     // Decrypt the Envelope into strContents
-    if (!theEnvelope.Open(theNotary, strContents)) return false;
+    if (!theEnvelope.Open(theNotary, strContents)) return nullptr;
+
+    OpenSSL_BIO bioBank = BIO_new(BIO_s_mem()); // input
 
     // copy strContents to a BIO
     BIO_puts(bioBank, strContents.Get());
+    strContents.zeroMemory();
 
     // Instantiate the Bank with its private key
-    Bank bank(bioBank);
+    CachedBank& cached = banks_[lDenomination];
+    cached.private_ = strPrivate;
+    cached.bank_.reset(new Bank(bioBank));
+
+    return cached.bank_.get();
+}
+
+// Lucre step 3: the mint signs the token
+//
+bool MintLucre::SignToken(Nym& theNotary, Token& theToken, String& theOutput,
+                          int32_t nTokenIndex)
+{
+    bool bReturnValue = false;
+
+    LucreDumper setDumper;
+
+    OpenSSL_BIO bioRequest = BIO_new(BIO_s_mem());   // input
+    OpenSSL_BIO bioSignature = BIO_new(BIO_s_mem()); // output
+
+    std::lock_guard<std::mutex> lock(banks_lock_);
+
+    Bank* pBank = GetBank(theNotary, theToken.GetDenomination());
+
+    if (nullptr == pBank) return false;
+
+    Bank& bank = *pBank;
 
     // I need the request. the prototoken.
     OTASCIIArmor ascPrototoken;
@@ -301,30 +330,19 @@ bool MintLucre::VerifyToken(Nym& theNotary, String& theCleartextToken,
     bool bReturnValue = false;
     LucreDumper setDumper;
 
-    OpenSSL_BIO bioBank = BIO_new(BIO_s_mem()); // input
     OpenSSL_BIO bioCoin = BIO_new(BIO_s_mem()); // input
 
     // --- copy theCleartextToken to bioCoin so lucre can load it
     BIO_puts(bioCoin, theCleartextToken.Get());
 
-    // --- The Mint private info is encrypted in m_mapPrivate[lDenomination].
-    // So I need to extract that first before I can use it.
-    OTASCIIArmor theArmor;
-    GetPrivate(theArmor, lDenomination);
-    OTEnvelope theEnvelope(theArmor);
-
-    String strContents; // will contain output from opening the envelope.
-    // Decrypt the Envelope into strContents
-    if (theEnvelope.Open(theNotary, strContents)) {
-        // copy strContents to a BIO
-        BIO_puts(bioBank, strContents.Get());
+    std::lock_guard<std::mutex> lock(banks_lock_);
 
-        // ---- Now the bank and coin bios are both ready to go...
+    Bank* pBank = GetBank(theNotary, lDenomination);
 
-        Bank bank(bioBank);
+    if (nullptr != pBank) {
         Coin coin(bioCoin);
 
-        if (bank.Verify(coin)) // Here's the boolean output: coin is verified!
+        if (pBank->Verify(coin)) // Here's the boolean output: coin is verified!
         {
             bReturnValue = true;
 
@@ -0,0 +1,663 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+#include "opentxs/cash/SpentTokenIndex.hpp"
+
+#include "opentxs/core/Identifier.hpp"
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/util/OTDataFolder.hpp"
+#include "opentxs/core/util/OTFolders.hpp"
+#include "opentxs/core/util/OTPaths.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Once this many hashes have been journaled, they are merged into the index.
+#define OT_SPENT_MERGE_THRESHOLD 4096
+// Records read from or written to the index per system call while merging.
+#define OT_SPENT_CHUNK 4096
+#define OT_SPENT_BLOOM_HASHES 7
+#define OT_SPENT_BLOOM_MIN_BITS 65536
+
+namespace opentxs
+{
+
+const std::size_t SpentTokenIndex::HASH_SIZE;
+
+SpentTokenIndex::Series::~Series() { Close(); }
+
+// Ten bits per element keeps the false positive rate near 1%. The filter is
+// sized for twice the current contents so that it stays accurate while the
+// journal fills up, and is rebuilt on every merge.
+uint64_t SpentTokenIndex::Series::Bits(const uint64_t elements)
+{
+    const uint64_t bits = std::max<uint64_t>(
+        OT_SPENT_BLOOM_MIN_BITS, 20 * elements);
+
+    return (bits + 63) & ~static_cast<uint64_t>(63);
+}
+
+void SpentTokenIndex::Series::BloomReset(const uint64_t elements)
+{
+    bloom_bits_ = Bits(elements);
+    bloom_.assign(bloom_bits_ / 64, 0);
+}
+
+// Token hashes are already uniformly distributed, so the probe positions are
+// derived directly from the hash by double hashing.
+void SpentTokenIndex::Series::BloomAdd(const std::string& hash)
+{
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    std::memcpy(&h1, hash.data(), sizeof(h1));
+    std::memcpy(&h2, hash.data() + sizeof(h1), sizeof(h2));
+    h2 |= 1;
+
+    for (uint64_t i = 0; i < OT_SPENT_BLOOM_HASHES; ++i) {
+        const uint64_t bit = (h1 + i * h2) % bloom_bits_;
+        bloom_[bit / 64] |= (static_cast<uint64_t>(1) << (bit % 64));
+    }
+}
+
+bool SpentTokenIndex::Series::BloomCheck(const std::string& hash) const
+{
+    uint64_t h1 = 0;
+    uint64_t h2 = 0;
+    std::memcpy(&h1, hash.data(), sizeof(h1));
+    std::memcpy(&h2, hash.data() + sizeof(h1), sizeof(h2));
+    h2 |= 1;
+
+    for (uint64_t i = 0; i < OT_SPENT_BLOOM_HASHES; ++i) {
+        const uint64_t bit = (h1 + i * h2) % bloom_bits_;
+
+        if (0 == (bloom_[bit / 64] & (static_cast<uint64_t>(1) << (bit % 64))))
+            return false;
+    }
+
+    return true;
+}
+
+void SpentTokenIndex::Series::Close()
+{
+    if (-1 != index_) {
+        close(index_);
+        index_ = -1;
+    }
+
+    if (-1 != log_) {
+        close(log_);
+        log_ = -1;
+    }
+}
+
+bool SpentTokenIndex::Series::LoadIndex()
+{
+    count_ = 0;
+    index_ = open(index_file_.c_str(), O_RDONLY);
+
+    if (-1 == index_) {
+        // A series which has never been merged has no index yet.
+        return true;
+    }
+
+    struct stat info;
+
+    if (0 != fstat(index_, &info)) {
+        otErr << __FUNCTION__ << ": Failed to stat " << index_file_ << "\n";
+
+        return false;
+    }
+
+    const uint64_t size = static_cast<uint64_t>(info.st_size);
+
+    if (0 != (size % HASH_SIZE)) {
+        otErr << __FUNCTION__ << ": Corrupt index " << index_file_ << "\n";
+
+        return false;
+    }
+
+    count_ = size / HASH_SIZE;
+
+    return true;
+}
+
+bool SpentTokenIndex::Series::LoadLog()
+{
+    log_ = open(log_file_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0600);
+
+    if (-1 == log_) {
+        otErr << __FUNCTION__ << ": Failed to open " << log_file_ << "\n";
+
+        return false;
+    }
+
+    std::vector<char> buffer(OT_SPENT_CHUNK * HASH_SIZE);
+    off_t position = 0;
+
+    while (true) {
+        const ssize_t read = pread(log_, &buffer[0], buffer.size(), position);
+
+        if (0 > read) {
+            otErr << __FUNCTION__ << ": Failed to read " << log_file_ << "\n";
+
+            return false;
+        }
+
+        const std::size_t records = static_cast<std::size_t>(read) / HASH_SIZE;
+
+        for (std::size_t i = 0; i < records; ++i) {
+            journal_.insert(std::string(&buffer[i * HASH_SIZE], HASH_SIZE));
+        }
+
+        position += records * HASH_SIZE;
+
+        if (static_cast<std::size_t>(read) < buffer.size()) { break; }
+    }
+
+    // A partial record at the end of the journal was never acknowledged to a
+    // depositor, because the fsync which follows the write did not complete.
+    if (0 != ftruncate(log_, position)) {
+        otErr << __FUNCTION__ << ": Failed to truncate " << log_file_ << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+bool SpentTokenIndex::Series::Read(
+    const uint64_t position,
+    std::string& hash) const
+{
+    hash.resize(HASH_SIZE);
+    const ssize_t read =
+        pread(index_, &hash[0], HASH_SIZE, position * HASH_SIZE);
+
+    return (static_cast<ssize_t>(HASH_SIZE) == read);
+}
+
+bool SpentTokenIndex::Series::Search(const std::string& hash) const
+{
+    uint64_t low = 0;
+    uint64_t high = count_;
+    std::string record;
+
+    while (low < high) {
+        const uint64_t middle = low + (high - low) / 2;
+
+        // Failing to read the index is reported as a match, since the caller
+        // must not accept a token it could not check.
+        if (!Read(middle, record)) { return true; }
+
+        const int compare = record.compare(hash);
+
+        if (0 == compare) {
+            return true;
+        } else if (0 > compare) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return false;
+}
+
+bool SpentTokenIndex::Series::Merge()
+{
+    const std::string temp = index_file_ + ".tmp";
+    const int output = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+
+    if (-1 == output) {
+        otErr << __FUNCTION__ << ": Failed to create " << temp << "\n";
+
+        return false;
+    }
+
+    BloomReset(count_ + journal_.size());
+    std::vector<char> out;
+    out.reserve(OT_SPENT_CHUNK * HASH_SIZE);
+    std::vector<char> in(OT_SPENT_CHUNK * HASH_SIZE);
+    std::size_t inRecords = 0;
+    std::size_t inPosition = 0;
+    uint64_t read = 0;
+    uint64_t written = 0;
+    std::string previous;
+    auto journal = journal_.begin();
+    bool success = true;
+
+    auto append = [&](const std::string& hash) -> bool {
+        // An interrupted merge may leave journaled hashes in the index as
+        // well, so duplicates are dropped here.
+        if (hash == previous) { return true; }
+
+        out.insert(out.end(), hash.begin(), hash.end());
+        BloomAdd(hash);
+        previous = hash;
+        ++written;
+
+        if (out.size() < OT_SPENT_CHUNK * HASH_SIZE) { return true; }
+
+        const bool flushed = (static_cast<ssize_t>(out.size()) ==
+                              write(output, &out[0], out.size()));
+        out.clear();
+
+        return flushed;
+    };
+
+    while (success) {
+        if ((inPosition == inRecords) && (read < count_)) {
+            const uint64_t records =
+                std::min<uint64_t>(OT_SPENT_CHUNK, count_ - read);
+            const ssize_t bytes = pread(
+                index_, &in[0], records * HASH_SIZE, read * HASH_SIZE);
+
+            if (static_cast<ssize_t>(records * HASH_SIZE) != bytes) {
+                success = false;
+                break;
+            }
+
+            read += records;
+            inRecords = records;
+            inPosition = 0;
+        }
+
+        const bool haveIndex = (inPosition < inRecords);
+        const bool haveJournal = (journal != journal_.end());
+
+        if (!haveIndex && !haveJournal) { break; }
+
+        std::string next;
+
+        if (haveIndex) {
+            next.assign(&in[inPosition * HASH_SIZE], HASH_SIZE);
+        }
+
+        if (haveJournal && (!haveIndex || (*journal < next))) {
+            success = append(*journal);
+            ++journal;
+        } else {
+            success = append(next);
+            ++inPosition;
+        }
+    }
+
+    if (success && !out.empty()) {
+        success = (static_cast<ssize_t>(out.size()) ==
+                   write(output, &out[0], out.size()));
+    }
+
+    success = success && (0 == fsync(output));
+    close(output);
+
+    if (!success || (0 != std::rename(temp.c_str(), index_file_.c_str()))) {
+        otErr << __FUNCTION__ << ": Failed to write " << index_file_ << "\n";
+        std::remove(temp.c_str());
+        // The journal still holds everything, so only the filter needs to be
+        // brought back in line with the old index.
+        BloomReset(count_ + journal_.size());
+        std::string record;
+
+        for (uint64_t i = 0; i < count_; ++i) {
+            if (Read(i, record)) { BloomAdd(record); }
+        }
+
+        for (const auto& hash : journal_) { BloomAdd(hash); }
+
+        return false;
+    }
+
+    if (-1 != index_) { close(index_); }
+
+    index_ = open(index_file_.c_str(), O_RDONLY);
+    count_ = written;
+    journal_.clear();
+
+    if ((0 != ftruncate(log_, 0)) || (0 != fsync(log_))) {
+        // Harmless: the journal is replayed into a set which is already
+        // contained in the index, and dropped again by the next merge.
+        otErr << __FUNCTION__ << ": Failed to truncate " << log_file_ << "\n";
+    }
+
+    return (-1 != index_);
+}
+
+bool SpentTokenIndex::Series::Open(
+    const std::string& folder,
+    const std::string& name)
+{
+    index_file_ = folder + name + ".index";
+    log_file_ = folder + name + ".log";
+    const std::string legacy = folder + name;
+
+    if (!LoadIndex() || !LoadLog()) {
+        Close();
+
+        return false;
+    }
+
+    BloomReset(count_ + journal_.size());
+    std::vector<char> buffer(OT_SPENT_CHUNK * HASH_SIZE);
+
+    for (uint64_t position = 0; position < count_;) {
+        const uint64_t records =
+            std::min<uint64_t>(OT_SPENT_CHUNK, count_ - position);
+        const ssize_t bytes = pread(
+            index_, &buffer[0], records * HASH_SIZE, position * HASH_SIZE);
+
+        if (static_cast<ssize_t>(records * HASH_SIZE) != bytes) {
+            otErr << __FUNCTION__ << ": Failed to read " << index_file_
+                  << "\n";
+            Close();
+
+            return false;
+        }
+
+        for (uint64_t i = 0; i < records; ++i) {
+            BloomAdd(std::string(&buffer[i * HASH_SIZE], HASH_SIZE));
+        }
+
+        position += records;
+    }
+
+    for (const auto& hash : journal_) { BloomAdd(hash); }
+
+    // Series recorded as one file per token are imported once, and the
+    // result merged right away so that the next open finds an index.
+    if ((-1 == index_) && OTPaths::FolderExists(legacy.c_str())) {
+        std::vector<std::string> hashes;
+
+        if (!LegacyHashes(legacy, hashes) || !Insert(hashes) || !Merge()) {
+            otErr << __FUNCTION__ << ": Failed to import " << legacy << "\n";
+            Close();
+
+            return false;
+        }
+
+        otOut << __FUNCTION__ << ": Imported " << hashes.size()
+              << " spent tokens from " << legacy << "\n";
+    }
+
+    return true;
+}
+
+bool SpentTokenIndex::Series::Contains(const std::string& hash) const
+{
+    if (!BloomCheck(hash)) { return false; }
+
+    if (journal_.end() != journal_.find(hash)) { return true; }
+
+    if (-1 == index_) { return false; }
+
+    return Search(hash);
+}
+
+bool SpentTokenIndex::Series::Insert(const std::vector<std::string>& hashes)
+{
+    std::set<std::string> added;
+    std::vector<char> buffer;
+
+    for (const auto& hash : hashes) {
+        if (Contains(hash) || !added.insert(hash).second) { continue; }
+
+        buffer.insert(buffer.end(), hash.begin(), hash.end());
+    }
+
+    if (buffer.empty()) { return true; }
+
+    const off_t end = lseek(log_, 0, SEEK_END);
+
+    // One write and one fsync for the whole group.
+    if ((-1 == end) ||
+        (static_cast<ssize_t>(buffer.size()) !=
+         write(log_, &buffer[0], buffer.size())) ||
+        (0 != fsync(log_))) {
+        otErr << __FUNCTION__ << ": Failed to write " << log_file_ << "\n";
+
+        if ((-1 != end) && (0 != ftruncate(log_, end))) {
+            otErr << __FUNCTION__ << ": Failed to roll back " << log_file_
+                  << "\n";
+        }
+
+        return false;
+    }
+
+    for (const auto& hash : added) {
+        journal_.insert(hash);
+        BloomAdd(hash);
+    }
+
+    if (OT_SPENT_MERGE_THRESHOLD <= journal_.size()) {
+        // The hashes are already durable in the journal, so a failed merge
+        // does not fail the insert.
+        Merge();
+    }
+
+    return true;
+}
+
+SpentTokenIndex& SpentTokenIndex::It()
+{
+    static SpentTokenIndex instance;
+
+    return instance;
+}
+
+SpentTokenIndex::SpentTokenIndex(const std::string& folder)
+    : folder_(folder)
+{
+}
+
+bool SpentTokenIndex::Folder(std::string& folder) const
+{
+    if (!folder_.empty()) {
+        folder = folder_;
+
+        return true;
+    }
+
+    String dataFolder;
+
+    if (!OTDataFolder::Get(dataFolder)) { return false; }
+
+    String spent;
+
+    if (!OTPaths::AppendFolder(spent, dataFolder, OTFolders::Spent())) {
+        return false;
+    }
+
+    bool created = false;
+
+    if (!OTPaths::BuildFolderPath(spent, created)) { return false; }
+
+    folder = spent.Get();
+
+    return true;
+}
+
+bool SpentTokenIndex::Hash(const Identifier& tokenHash, std::string& hash)
+{
+    if (HASH_SIZE != tokenHash.GetSize()) { return false; }
+
+    hash.assign(static_cast<const char*>(tokenHash.GetPointer()), HASH_SIZE);
+
+    return true;
+}
+
+bool SpentTokenIndex::LegacyHashes(
+    const std::string& folder,
+    std::vector<std::string>& hashes)
+{
+    DIR* directory = opendir(folder.c_str());
+
+    if (nullptr == directory) { return false; }
+
+    while (struct dirent* entry = readdir(directory)) {
+        const std::string filename = entry->d_name;
+
+        if (filename.empty() || ('.' == filename[0])) { continue; }
+
+        // The old format named each file after the encoded token hash.
+        const Identifier tokenHash(filename);
+        std::string hash;
+
+        if (!Hash(tokenHash, hash)) {
+            otErr << __FUNCTION__ << ": Skipping " << folder << filename
+                  << "\n";
+
+            continue;
+        }
+
+        hashes.push_back(hash);
+    }
+
+    closedir(directory);
+
+    return true;
+}
+
+SpentTokenIndex::Series* SpentTokenIndex::GetSeries(const String& series)
+{
+    const std::string name = series.Get();
+    auto it = series_.find(name);
+
+    if (series_.end() != it) { return it->second.get(); }
+
+    std::string folder;
+
+    if (!Folder(folder)) {
+        otErr << __FUNCTION__ << ": Unable to locate the spent folder.\n";
+
+        return nullptr;
+    }
+
+    std::unique_ptr<Series> opened(new Series);
+
+    if (!opened->Open(folder, name)) { return nullptr; }
+
+    return (series_[name] = std::move(opened)).get();
+}
+
+bool SpentTokenIndex::IsSpent(const String& series, const Identifier& tokenHash)
+{
+    std::string hash;
+
+    if (!Hash(tokenHash, hash)) { return true; }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    Series* spent = GetSeries(series);
+
+    if (nullptr == spent) { return true; }
+
+    return spent->Contains(hash);
+}
+
+bool SpentTokenIndex::Record(
+    const String& series,
+    const std::vector<Identifier>& tokenHashes)
+{
+    std::vector<std::string> hashes;
+
+    for (const auto& tokenHash : tokenHashes) {
+        std::string hash;
+
+        if (!Hash(tokenHash, hash)) { return false; }
+
+        hashes.push_back(hash);
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    Series* spent = GetSeries(series);
+
+    if (nullptr == spent) { return false; }
+
+    return spent->Insert(hashes);
+}
+
+bool SpentTokenIndex::Record(const String& series, const Identifier& tokenHash)
+{
+    return Record(series, std::vector<Identifier>{tokenHash});
+}
+
+int32_t SpentTokenIndex::Migrate()
+{
+    std::string folder;
+
+    if (!Folder(folder)) { return 1; }
+
+    DIR* directory = opendir(folder.c_str());
+
+    if (nullptr == directory) { return 1; }
+
+    std::vector<String> legacy;
+
+    while (struct dirent* entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+
+        if (name.empty() || ('.' == name[0])) { continue; }
+
+        if (OTPaths::FolderExists((folder + name).c_str())) {
+            legacy.push_back(name.c_str());
+        }
+    }
+
+    closedir(directory);
+    int32_t failed = 0;
+    std::lock_guard<std::mutex> lock(lock_);
+
+    // Opening a series imports it if it has no index yet.
+    for (const auto& series : legacy) {
+        if (nullptr == GetSeries(series)) { ++failed; }
+    }
+
+    return failed;
+}
+} // namespace opentxs
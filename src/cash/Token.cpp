@@ -40,6 +40,7 @@
 
 #include "opentxs/cash/Mint.hpp"
 #include "opentxs/cash/Purse.hpp"
+#include "opentxs/cash/SpentTokenIndex.hpp"
 #if defined(OT_CASH_USING_LUCRE)
 #include "opentxs/cash/TokenLucre.hpp"
 #endif
@@ -470,24 +471,22 @@ bool Token::IsTokenAlreadySpent(String& theCleartextToken)
 {
     String strInstrumentDefinitionID(GetInstrumentDefinitionID());
 
-    // Calculate the filename (a hash of the Lucre cleartext token ID)
+    // Calculate the index key (a hash of the Lucre cleartext token ID)
     Identifier theTokenHash;
     theTokenHash.CalculateDigest(theCleartextToken);
 
-    // Grab the new hash into a string (for use as a filename)
-    String strTokenHash(theTokenHash);
-
     String strAssetFolder;
     strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
                           GetSeries());
 
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
+    // Errors inside the spent token index also return true.
+    bool bTokenIsPresent =
+        SpentTokenIndex::It().IsSpent(strAssetFolder, theTokenHash);
 
     if (bTokenIsPresent) {
         otOut << "\nToken::IsTokenAlreadySpent: Token was already spent: "
               << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
+              << Log::PathSeparator() << String(theTokenHash) << "\n";
         return true; // all errors must return true in this function.
                      // But this is not an error. Token really WAS already
     }                // spent, and this true is for real. The others are just
@@ -504,55 +503,35 @@ bool Token::RecordTokenAsSpent(String& theCleartextToken)
 {
     String strInstrumentDefinitionID(GetInstrumentDefinitionID());
 
-    // Calculate the filename (a hash of the Lucre cleartext token ID)
+    // Calculate the index key (a hash of the Lucre cleartext token ID)
     Identifier theTokenHash;
     theTokenHash.CalculateDigest(theCleartextToken);
 
-    // Grab the new hash into a string (for use as a filename)
-    String strTokenHash(theTokenHash);
-
     String strAssetFolder;
     strAssetFolder.Format("%s.%d", strInstrumentDefinitionID.Get(),
                           GetSeries());
 
-    // See if the spent token file ALREADY EXISTS...
-    bool bTokenIsPresent = OTDB::Exists(
-        OTFolders::Spent().Get(), strAssetFolder.Get(), strTokenHash.Get());
+    SpentTokenIndex& spent = SpentTokenIndex::It();
 
+    // See if the token is ALREADY recorded...
     // If so, we're trying to record a token that was already recorded...
-    if (bTokenIsPresent) {
+    if (spent.IsSpent(strAssetFolder, theTokenHash)) {
         otErr << "Token::RecordTokenAsSpent: Trying to record token as spent,"
                  " but it was already recorded: " << OTFolders::Spent()
               << Log::PathSeparator() << strAssetFolder << Log::PathSeparator()
-              << strTokenHash << "\n";
+              << String(theTokenHash) << "\n";
         return false;
     }
 
-    // FINISHED:
-    //
-    // We actually save the token itself into the file, which is named based
-    // on a hash of the Lucre data.
-    // The success of that operation is also now the success of this one.
-
-    String strFinal;
-    OTASCIIArmor ascTemp(m_strRawFile);
+    // Only the hash is kept. The journal write is fsynced before this
+    // returns, and its success is the success of this operation.
+    const bool bSaved = spent.Record(strAssetFolder, theTokenHash);
 
-    if (false ==
-        ascTemp.WriteArmoredString(strFinal, m_strContractType.Get())) {
-        otErr << "Token::RecordTokenAsSpent: Error recording token as "
-                 "spent (failed writing armored string):\n"
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
-        return false;
-    }
-
-    const bool bSaved =
-        OTDB::StorePlainString(strFinal.Get(), OTFolders::Spent().Get(),
-                               strAssetFolder.Get(), strTokenHash.Get());
     if (!bSaved) {
-        otErr << "Token::RecordTokenAsSpent: Error saving file: "
-              << OTFolders::Spent() << Log::PathSeparator() << strAssetFolder
-              << Log::PathSeparator() << strTokenHash << "\n";
+        otErr << "Token::RecordTokenAsSpent: Error saving to the spent token "
+                 "index: " << OTFolders::Spent() << Log::PathSeparator()
+              << strAssetFolder << Log::PathSeparator()
+              << String(theTokenHash) << "\n";
     }
 
     return bSaved;
@@ -2411,6 +2411,12 @@ int32_t OTAPI_Wrap::getMarketList(const std::string& NOTARY_ID,
     return Exec()->getMarketList(NOTARY_ID, NYM_ID);
 }
 
+int32_t OTAPI_Wrap::getCommandStats(const std::string& NOTARY_ID,
+                                    const std::string& NYM_ID)
+{
+    return Exec()->getCommandStats(NOTARY_ID, NYM_ID);
+}
+
 int32_t OTAPI_Wrap::getMarketOffers(const std::string& NOTARY_ID,
                                     const std::string& NYM_ID,
                                     const std::string& MARKET_ID,
@@ -4998,6 +4998,9 @@ bool OTClient::processServerReplyGetMarketOffers(const Message& theReply)
     String strOfferDatafile;
     strOfferDatafile.Format("%s.bin", strMarketID.Get());
 
+    // The stored offers are still current.
+    if (theReply.m_bBool) return true;
+
     OTDB::Storage* pStorage = OTDB::GetDefaultStorage();
     OT_ASSERT(nullptr != pStorage);
 
@@ -5076,6 +5079,9 @@ bool OTClient::processServerReplyGetMarketRecentTrades(const Message& theReply)
     String strTradeDatafile;
     strTradeDatafile.Format("%s.bin", strMarketID.Get());
 
+    // The stored trades are still current.
+    if (theReply.m_bBool) return true;
+
     OTDB::Storage* pStorage = OTDB::GetDefaultStorage();
     OT_ASSERT(nullptr != pStorage);
 
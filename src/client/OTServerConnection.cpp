@@ -43,12 +43,14 @@
 #include "opentxs/core/Message.hpp"
 #include "opentxs/core/Nym.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/app/App.hpp"
+#include "opentxs/core/app/Settings.hpp"
 #include "opentxs/core/contract/ServerContract.hpp"
-#include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/util/Assert.hpp"
 
 #include <stddef.h>
 #include <stdint.h>
+#include <zframe.h>
 #include <zsock.h>
 #include <memory>
 #include <string>
@@ -100,12 +102,31 @@ OTServerConnection::OTServerConnection(
     , m_pServerContract(nullptr)
     , m_pClient(theClient)
     , m_endpoint(endpoint)
+    , encoding_(MessageEncoding::XML)
+    , negotiated_(false)
 {
     if (!zsys_has_curve()) {
         Log::vError("Error: libzmq has no libsodium support");
         OT_FAIL;
     }
 
+    std::string encoding;
+    bool notUsed = false;
+    App::Me().Config().CheckSet_str(
+        "Connection",
+        "wire_encoding",
+        "xml",
+        encoding,
+        notUsed,
+        "xml or protobuf");
+    App::Me().Config().Save();
+
+    if ("protobuf" == encoding) {
+        encoding_ = MessageEncoding::PROTOBUF;
+    }
+
+    Message::SetDefaultEncoding(encoding_);
+
     zsock_set_linger(socket_zmq, OTServerConnection::getLinger());
     zsock_set_sndtimeo(socket_zmq, OTServerConnection::getSendTimeout());
     zsock_set_rcvtimeo(socket_zmq, OTServerConnection::getRecvTimeout());
@@ -202,8 +223,15 @@ void OTServerConnection::send(
     const Nym* pServerNym = pServerContract->GetContractPublicNym();
     OT_ASSERT(nullptr != pServerNym);*/
 
-    String strContents;
-    theMessage.SaveContractRaw(strContents);
+    if (!negotiate()) return;
+
+    std::string request;
+
+    if (!encode(*pNym, theMessage, request)) {
+        otErr << __FUNCTION__ << ": Failed encoding " << theMessage.m_strCommand
+              << " message.\n";
+        return;
+    }
 
     otOut << "\n=====>BEGIN Sending " << theMessage.m_strCommand
           << " message via ZMQ... Request number: "
@@ -211,7 +239,33 @@ void OTServerConnection::send(
 
     m_pServerContract = pServerContract;
     m_pNym = pNym;
-    send(strContents);
+
+    std::string rawServerReply;
+
+    if (!send(request, rawServerReply)) return;
+
+    // The notary may have processed the request before failing, so it is
+    // never sent again from here.
+    if (Message::IsWireErrorReply(rawServerReply)) {
+        otErr << __FUNCTION__ << ": Notary failed to answer "
+              << theMessage.m_strCommand << " message.\n";
+        return;
+    }
+
+    // todo: use a unique_ptr  soon as feasible.
+    std::shared_ptr<Message> pServerReply(new Message());
+    OT_ASSERT(nullptr != pServerReply);
+
+    if (pServerReply->LoadWire(rawServerReply)) {
+        // Now the fully-loaded message object (from the server,
+        // this time) can be processed by the OT library...
+        // Client takes ownership and will
+        m_pClient->processServerReply(pServerReply);
+    } else {
+        otErr << __FUNCTION__ << ": Error loading server reply ("
+              << rawServerReply.size() << " bytes).\n";
+        return;
+    }
 
     otWarn << "<=====END Finished sending " << theMessage.m_strCommand
            << " message (and hopefully receiving "
@@ -219,17 +273,59 @@ void OTServerConnection::send(
            << theMessage.m_strRequestNum << "\n\n";
 }
 
-bool OTServerConnection::send(const String& theString)
+bool OTServerConnection::negotiate()
 {
-    OTASCIIArmor ascEnvelope(theString);
+    if (negotiated_ || (MessageEncoding::PROTOBUF != encoding_)) return true;
 
-    if (!ascEnvelope.Exists()) {
-        return false;
+    std::string reply;
+
+    if (!send(Message::WireProbe(), reply)) return false;
+
+    // An empty answer is safe to act on here, since the probe itself does
+    // nothing on any notary.
+    if (!Message::ProbeReplySupports(reply, MessageEncoding::PROTOBUF)) {
+        otOut << __FUNCTION__ << ": Notary does not read the binary "
+                                 "encoding. Using XML.\n";
+        encoding_ = MessageEncoding::XML;
+        Message::SetDefaultEncoding(encoding_);
     }
 
+    negotiated_ = true;
+
+    return true;
+}
+
+bool OTServerConnection::encode(
+    const Nym& nym,
+    const Message& theMessage,
+    std::string& request) const
+{
+    // New messages start in this connection's encoding, so they are already
+    // signed in the form that is sent.
+    if (theMessage.Encoding() == encoding_) {
+        return theMessage.SaveWire(request);
+    }
+
+    // Only a request built before the encoding was known (the first one, or
+    // one built before the notary turned the binary encoding down) has to be
+    // encoded again, from the same fields, and signed again.
+    String strContents;
+    theMessage.SaveContractRaw(strContents);
+    Message encoded;
+
+    if (!encoded.LoadContractFromString(strContents)) return false;
+
+    encoded.SetEncoding(encoding_);
+
+    return encoded.SignContract(nym) && encoded.SaveWire(request);
+}
+
+bool OTServerConnection::send(const std::string& request, std::string& reply)
+{
     s_bNetworkFailure = false;
 
-    int rc = zstr_send(socket_zmq, ascEnvelope.Get());
+    zframe_t* frame = zframe_new(request.data(), request.size());
+    int rc = zframe_send(&frame, socket_zmq, 0);
 
     if (rc != 0) {
         s_bNetworkFailure = true;
@@ -240,11 +336,8 @@ bool OTServerConnection::send(const String& theString)
 
         return false;
     }
-    //  else
-    //      otErr << __FUNCTION__ << ": DEBUGGING!!!! SUCCESSFULLY SENT. \n";
 
-    std::string rawServerReply;
-    bool bSuccessReceiving = receive(rawServerReply);
+    bool bSuccessReceiving = receive(reply);
 
     if (!bSuccessReceiving) {
         s_bNetworkFailure = true;
@@ -255,41 +348,17 @@ bool OTServerConnection::send(const String& theString)
 
         return false;
     }
-    //    else
-    //        otErr << __FUNCTION__ << ": DEBUGGING!!!! SUCCESSFULLY RECEIVED.
-    //        \n";
-
-    OTASCIIArmor ascServerReply;
-    ascServerReply.Set(rawServerReply.c_str());
-
-    String strServerReply;
-    bool bRetrievedReply = ascServerReply.GetString(strServerReply);
-
-    // todo: use a unique_ptr  soon as feasible.
-    std::shared_ptr<Message> pServerReply(new Message());
-    OT_ASSERT(nullptr != pServerReply);
-
-    if (bRetrievedReply && strServerReply.Exists() &&
-        pServerReply->LoadContractFromString(strServerReply)) {
-        // Now the fully-loaded message object (from the server,
-        // this time) can be processed by the OT library...
-        // Client takes ownership and will
-        m_pClient->processServerReply(pServerReply);
-    } else {
-        otErr << __FUNCTION__ << ": Error loading server reply from string:\n\n"
-              << rawServerReply << "\n\n";
-        return false;
-    }
 
     return true;
 }
 
 bool OTServerConnection::receive(std::string& serverReply)
 {
-    char* msg = zstr_recv(socket_zmq);
-    if (msg == nullptr) return false;
-    serverReply.assign(msg);
-    zstr_free(&msg);
+    zframe_t* frame = zframe_recv(socket_zmq);
+    if (frame == nullptr) return false;
+    serverReply.assign(
+        reinterpret_cast<const char*>(zframe_data(frame)), zframe_size(frame));
+    zframe_destroy(&frame);
     return true;
 }
 
@@ -12024,6 +12024,57 @@ int32_t OT_API::getMarketList(
     return SendMessage(pServer.get(), pNym, theMessage, lRequestNumber);
 }
 
+/// GET THE SERVER'S PER COMMAND LATENCY
+///
+/// Only the server's override Nym may ask, unless the operator allows
+/// everyone. The reply payload is a plain text table.
+///
+int32_t OT_API::getCommandStats(
+    const Identifier& NOTARY_ID,
+    const Identifier& NYM_ID) const
+{
+    Nym* pNym = GetOrLoadPrivateNym(
+        NYM_ID, false, __FUNCTION__);  // This ASSERTs and logs already.
+    if (nullptr == pNym) return (-1);
+    // By this point, pNym is a good pointer, and is on the wallet.
+    //  (No need to cleanup.)
+    auto pServer =
+        GetServer(NOTARY_ID, __FUNCTION__);  // This ASSERTs and logs already.
+    if (!pServer) return (-1);
+    // By this point, pServer is a good pointer.  (No need to cleanup.)
+    Message theMessage;
+
+    String strNotaryID(NOTARY_ID);
+    // (0) Set up the REQUEST NUMBER and then INCREMENT IT
+    int64_t lRequestNumber = 0;
+    pNym->GetCurrentRequestNum(strNotaryID, lRequestNumber);
+    theMessage.m_strRequestNum.Format(
+        "%" PRId64, lRequestNumber);                // Always have to send this.
+    pNym->IncrementRequestNum(*pNym, strNotaryID);  // since I used it for a
+                                                    // server request, I have to
+                                                    // increment it
+
+    String strNymID(NYM_ID);
+
+    // (1) Set up member variables
+    theMessage.m_strCommand = "getCommandStats";
+    theMessage.m_strNymID = strNymID;
+    theMessage.m_strNotaryID = strNotaryID;
+    theMessage.SetAcknowledgments(*pNym);  // Must be called AFTER
+    // theMessage.m_strNotaryID is already
+    // set. (It uses it.)
+
+    // (2) Sign the Message
+    theMessage.SignContract(*pNym);
+
+    // (3) Save the Message (with signatures and all, back to its internal
+    // member m_strRawFile.)
+    theMessage.SaveContract();
+
+    // (Send it)
+    return SendMessage(pServer.get(), pNym, theMessage, lRequestNumber);
+}
+
 /// GET ALL THE OFFERS ON A SPECIFIC MARKET
 ///
 /// A specific Nym is requesting the Server to send a list of the offers on a
@@ -12035,7 +12086,8 @@ int32_t OT_API::getMarketOffers(
     const Identifier& NOTARY_ID,
     const Identifier& NYM_ID,
     const Identifier& MARKET_ID,
-    const int64_t& lDepth) const
+    const int64_t& lDepth,
+    const int64_t& lKnownVersion) const
 {
     Nym* pNym = GetOrLoadPrivateNym(
         NYM_ID, false, __FUNCTION__);  // This ASSERTs and logs already.
@@ -12070,6 +12122,7 @@ int32_t OT_API::getMarketOffers(
 
     theMessage.m_strNymID2 = strMarketID;
     theMessage.m_lDepth = lDepth;
+    theMessage.m_lTransactionNum = lKnownVersion;
 
     // (2) Sign the Message
     theMessage.SignContract(*pNym);
@@ -12098,7 +12151,8 @@ int32_t OT_API::getMarketOffers(
 int32_t OT_API::getMarketRecentTrades(
     const Identifier& NOTARY_ID,
     const Identifier& NYM_ID,
-    const Identifier& MARKET_ID) const
+    const Identifier& MARKET_ID,
+    const int64_t& lKnownVersion) const
 {
     Nym* pNym = GetOrLoadPrivateNym(
         NYM_ID, false, __FUNCTION__);  // This ASSERTs and logs already.
@@ -12131,6 +12185,7 @@ int32_t OT_API::getMarketRecentTrades(
     // set. (It uses it.)
 
     theMessage.m_strNymID2 = strMarketID;
+    theMessage.m_lTransactionNum = lKnownVersion;
 
     // (2) Sign the Message
     theMessage.SignContract(*pNym);
@@ -57,6 +57,8 @@
 #include "opentxs/core/util/Tag.hpp"
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
 #include <irrxml/irrXML.hpp>
@@ -1198,13 +1200,140 @@ bool Contract::LoadContractFromString(const String& theStr)
     return bSuccess;
 }
 
+namespace
+{
+const char* OT_CONTRACT_WHITESPACE = " \t\f\v\n\r";
+
+bool starts_with(const char* line, const std::size_t size, const char* prefix)
+{
+    const std::size_t length = strlen(prefix);
+
+    return (size >= length) && (0 == memcmp(line, prefix, length));
+}
+
+bool contains(const char* line, const std::size_t size, const char* token)
+{
+    const char* end = line + size;
+
+    return end != std::search(line, end, token, token + strlen(token));
+}
+
+// Walks the lines of a buffer in place. A line does not include its newline.
+class RawLines
+{
+public:
+    RawLines(const char* begin, const char* end)
+        : position_(begin)
+        , end_(end)
+    {
+    }
+
+    bool AtEnd() const { return position_ >= end_; }
+
+    bool Next(const char*& line, std::size_t& size, bool& newline)
+    {
+        if (AtEnd()) return false;
+
+        const char* found = static_cast<const char*>(memchr(
+            position_, '\n', static_cast<std::size_t>(end_ - position_)));
+        line = position_;
+        newline = (nullptr != found);
+
+        if (newline) {
+            size = static_cast<std::size_t>(found - position_);
+            position_ = found + 1;
+        } else {
+            size = static_cast<std::size_t>(end_ - position_);
+            position_ = end_;
+        }
+
+        return true;
+    }
+
+    /** Discards the next line. Returns false if there was no such line, or
+     * if nothing follows it. */
+    bool Skip()
+    {
+        const char* line = nullptr;
+        std::size_t size = 0;
+        bool newline = false;
+
+        return Next(line, size, newline) && !AtEnd();
+    }
+
+private:
+    const char* position_{nullptr};
+    const char* end_{nullptr};
+};
+
+// Collects the lines of one section of a contract, each followed by a
+// newline. The lines of a section are normally one unbroken run of the raw
+// file, so they are copied once, when the section is complete.
+class RawSection
+{
+public:
+    void Add(const char* line, const std::size_t size, const bool newline)
+    {
+        if (newline && (line == end_)) {
+            end_ = line + size + 1;
+
+            return;
+        }
+
+        flush();
+
+        if (newline) {
+            begin_ = line;
+            end_ = line + size + 1;
+        } else {
+            copy_.append(line, size);
+            copy_.push_back('\n');
+        }
+    }
+
+    void AppendTo(String& output)
+    {
+        if (!copy_.empty()) { flush(); }
+
+        const char* data = copy_.empty() ? begin_ : copy_.data();
+        const std::size_t size =
+            copy_.empty() ? static_cast<std::size_t>(end_ - begin_)
+                          : copy_.size();
+
+        if (0 < size) {
+            if (output.Exists()) {
+                String section;
+                section.Set(data, static_cast<uint32_t>(size));
+                output.Concatenate(section);
+            } else {
+                output.Set(data, static_cast<uint32_t>(size));
+            }
+        }
+
+        begin_ = nullptr;
+        end_ = nullptr;
+        copy_.clear();
+    }
+
+private:
+    const char* begin_{nullptr};
+    const char* end_{nullptr};
+    std::string copy_;
+
+    void flush()
+    {
+        if (begin_ != end_) { copy_.append(begin_, end_); }
+
+        begin_ = nullptr;
+        end_ = nullptr;
+    }
+};
+}  // namespace
+
 bool Contract::ParseRawFile()
 {
-    char buffer1[2100];  // a bit bigger than 2048, just for safety reasons.
     OTSignature* pSig = nullptr;
 
-    std::string line;
-
     bool bSignatureMode = false;           // "currently in signature mode"
     bool bContentMode = false;             // "currently in content mode"
     bool bHaveEnteredContentMode = false;  // "have yet to enter content mode"
@@ -1216,38 +1345,53 @@ bool Contract::ParseRawFile()
         return false;
     }
 
-    // This is redundant (I thought) but the problem hasn't cleared up yet.. so
-    // trying to really nail it now.
-    std::string str_Trim(m_strRawFile.Get());
-    std::string str_Trim2 = String::trim(str_Trim);
-    m_strRawFile.Set(str_Trim2.c_str());
+    // Contracts written by AddBookendsAroundContent are already trimmed, so
+    // m_strRawFile is only rewritten when there is something to remove.
+    const char* raw = m_strRawFile.Get();
+    std::size_t first = 0;
+    std::size_t last = m_strRawFile.GetLength();
 
-    bool bIsEOF = false;
-    m_strRawFile.reset();
+    while ((first < last) &&
+           (nullptr != strchr(OT_CONTRACT_WHITESPACE, raw[first]))) {
+        ++first;
+    }
 
-    do {
-        // Just a fresh start at the top of the loop block... probably
-        // unnecessary.
-        memset(
-            buffer1, 0, 2100);  // todo remove this in optimization. (might be
-                                // removed already...)
+    while ((last > first) &&
+           (nullptr != strchr(OT_CONTRACT_WHITESPACE, raw[last - 1]))) {
+        --last;
+    }
 
-        // the call returns true if there's more to read, and false if there
-        // isn't.
-        bIsEOF = !(m_strRawFile.sgets(buffer1, 2048));
+    if ((0 != first) || (m_strRawFile.GetLength() != last)) {
+        String strTrimmed;
 
-        line = buffer1;
-        const char* pBuf = line.c_str();
+        if (first < last) {
+            strTrimmed.Set(raw + first, static_cast<uint32_t>(last - first));
+        }
+
+        m_strRawFile.swap(strTrimmed);
+        raw = m_strRawFile.Get();
+    }
+
+    RawLines lines(raw, raw + m_strRawFile.GetLength());
+    RawSection content;
+    RawSection signature;
+    const char* pBuf = nullptr;
+    std::size_t size = 0;
+    bool newline = false;
+
+    while (lines.Next(pBuf, size, newline)) {
+        const bool bIsEOF = lines.AtEnd();
 
-        if (line.length() < 2) {
+        if (size < 2) {
             if (bSignatureMode) continue;
         }
 
         // if we're on a dashed line...
-        else if (line.at(0) == '-') {
+        else if (pBuf[0] == '-') {
             if (bSignatureMode) {
                 // we just reached the end of a signature
-                //    otErr << "%s\n", pSig->Get());
+                OT_ASSERT(nullptr != pSig);
+                signature.AppendTo(*pSig);
                 pSig = nullptr;
                 bSignatureMode = false;
                 continue;
@@ -1260,32 +1404,19 @@ bool Contract::ParseRawFile()
             // a. I have not yet even entered content mode, and just now
             // entering it for the first time.
             if (!bHaveEnteredContentMode) {
-                if ((line.length() > 3) &&
-                    (line.find("BEGIN") != std::string::npos) &&
-                    line.at(1) == '-' && line.at(2) == '-' &&
-                    line.at(3) == '-') {
-                    //                    otErr << "\nProcessing contract...
-                    // \n";
+                if ((size > 3) && contains(pBuf, size, "BEGIN") &&
+                    starts_with(pBuf, size, "----")) {
                     bHaveEnteredContentMode = true;
                     bContentMode = true;
-                    continue;
-                } else {
-                    continue;
                 }
 
+                continue;
             }
 
             // b. I am now entering signature mode!
             else if (
-                line.length() > 3 &&
-                line.find("SIGNATURE") != std::string::npos &&
-                line.at(1) == '-' && line.at(2) == '-' && line.at(3) == '-') {
-                // if (bContentMode)
-                //    otLog3 << "Finished reading contract.\n\nReading a
-                // signature at the bottom of the contract...\n");
-                // else
-                //    otLog3 << "Reading another signature...\n");
-
+                (size > 3) && contains(pBuf, size, "SIGNATURE") &&
+                starts_with(pBuf, size, "----")) {
                 bSignatureMode = true;
                 bContentMode = false;
 
@@ -1302,8 +1433,7 @@ bool Contract::ParseRawFile()
                 continue;
             }
             // c. There is an error in the file!
-            else if (
-                line.length() < 3 || line.at(1) != ' ' || line.at(2) != '-') {
+            else if (size < 3 || pBuf[1] != ' ' || pBuf[2] != '-') {
                 otOut
                     << "Error in contract " << m_strFilename
                     << ": a dash at the beginning of the "
@@ -1311,34 +1441,18 @@ bool Contract::ParseRawFile()
                     << m_strRawFile << "\n";
                 return false;
             }
-            // d. It is an escaped dash, and therefore kosher, so I merely
-            // remove the escape and add it.
-            // I've decided not to remove the dashes but to keep them as part of
-            // the signed content.
-            // It's just much easier to deal with that way. The input code will
-            // insert the extra dashes.
-            // pBuf += 2;
+            // d. It is an escaped dash, and therefore kosher. The escape is
+            // kept as part of the signed content.
         }
 
         // Else we're on a normal line, not a dashed line.
         else {
             if (bHaveEnteredContentMode) {
                 if (bSignatureMode) {
-                    if (line.length() < 2) {
-                        otLog3 << "Skipping short line...\n";
-
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
-                            otOut << "Error in signature for contract "
-                                  << m_strFilename
-                                  << ": Unexpected EOF after short line.\n";
-                            return false;
-                        }
-
-                        continue;
-                    } else if (line.compare(0, 8, "Version:") == 0) {
+                    if (starts_with(pBuf, size, "Version:")) {
                         otLog3 << "Skipping version section...\n";
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !lines.Skip()) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Version:\"\n";
@@ -1346,10 +1460,10 @@ bool Contract::ParseRawFile()
                         }
 
                         continue;
-                    } else if (line.compare(0, 8, "Comment:") == 0) {
+                    } else if (starts_with(pBuf, size, "Comment:")) {
                         otLog3 << "Skipping comment section...\n";
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !lines.Skip()) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Comment:\"\n";
@@ -1358,11 +1472,11 @@ bool Contract::ParseRawFile()
 
                         continue;
                     }
-                    if (line.compare(0, 5, "Meta:") == 0) {
+                    if (starts_with(pBuf, size, "Meta:")) {
                         otLog3 << "Collecting signature metadata...\n";
 
-                        if (line.length() != 13)  // "Meta:    knms" (It will
-                                                  // always be exactly 13
+                        if (size != 13)  // "Meta:    knms" (It will
+                                         // always be exactly 13
                         // characters int64_t.) knms represents the
                         // first characters of the Key type, NymID,
                         // Master Cred ID, and ChildCred ID. Key type is
@@ -1377,20 +1491,20 @@ bool Contract::ParseRawFile()
                         OT_ASSERT(nullptr != pSig);
                         if (false ==
                             pSig->getMetaData().SetMetadata(
-                                line.at(9),
-                                line.at(10),
-                                line.at(11),
-                                line.at(12)))  // "knms" from "Meta:    knms"
+                                pBuf[9],
+                                pBuf[10],
+                                pBuf[11],
+                                pBuf[12]))  // "knms" from "Meta:    knms"
                         {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected metadata in the \"Meta:\" "
                                      "comment.\nLine: "
-                                  << line << "\n";
+                                  << std::string(pBuf, size) << "\n";
                             return false;
                         }
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !lines.Skip()) {
                             otOut << "Error in signature for contract "
                                   << m_strFilename
                                   << ": Unexpected EOF after \"Meta:\"\n";
@@ -1401,18 +1515,17 @@ bool Contract::ParseRawFile()
                     }
                 }
                 if (bContentMode) {
-                    if (line.compare(0, 6, "Hash: ") == 0) {
+                    if (starts_with(pBuf, size, "Hash: ")) {
                         otLog3 << "Collecting message digest algorithm from "
                                   "contract header...\n";
 
-                        std::string strTemp = line.substr(6);
-                        String strHashType = strTemp.c_str();
+                        String strHashType(std::string(pBuf + 6, size - 6));
                         strHashType.ConvertToUpperCase();
 
                         m_strSigHashType =
                             CryptoHash::StringToHashType(strHashType);
 
-                        if (bIsEOF || !m_strRawFile.sgets(buffer1, 2048)) {
+                        if (bIsEOF || !lines.Skip()) {
                             otOut << "Error in contract " << m_strFilename
                                   << ": Unexpected EOF after \"Hash:\"\n";
                             return false;
@@ -1430,12 +1543,13 @@ bool Contract::ParseRawFile()
                 "processing signature, in "
                 "Contract::ParseRawFile");
 
-            pSig->Concatenate("%s\n", pBuf);
+            signature.Add(pBuf, size, newline);
         } else if (bContentMode)
-            m_xmlUnsigned.Concatenate("%s\n", pBuf);
-    } while (!bIsEOF);
-    //    while(!bIsEOF && (!bHaveEnteredContentMode || bContentMode ||
-    // bSignatureMode));
+            content.Add(pBuf, size, newline);
+    }
+
+    content.AppendTo(m_xmlUnsigned);
+
 
     if (!bHaveEnteredContentMode) {
         otErr << "Error in Contract::ParseRawFile: Found no BEGIN for signed "
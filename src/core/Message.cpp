@@ -47,20 +47,39 @@
 #include "opentxs/core/OTStringXML.hpp"
 #include "opentxs/core/OTTransaction.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/OTData.hpp"
+#include "opentxs/core/crypto/CryptoAsymmetric.hpp"
+#include "opentxs/core/crypto/CryptoHash.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/crypto/OTAsymmetricKey.hpp"
+#include "opentxs/core/crypto/OTPasswordData.hpp"
+#include "opentxs/core/crypto/OTSignature.hpp"
+#include "opentxs/core/crypto/OTSignatureMetadata.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/Common.hpp"
 #include "opentxs/core/util/Tag.hpp"
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <irrxml/irrXML.hpp>
 #include <map>
 #include <memory>
+#include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 
+#ifndef _WIN32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#endif
+#include "NotaryMessage.pb.h"
+#ifndef _WIN32
+#pragma GCC diagnostic pop
+#endif
+
 // PROTOCOL DOCUMENT
 
 // --- This is the file that implements the entire message protocol.
@@ -73,6 +92,60 @@
 namespace opentxs
 {
 
+namespace
+{
+
+// Leads a binary message on the wire. Armored text never contains it.
+const char OT_WIRE_PROTOBUF = '\0';
+// Follow the wire tag. Neither parses as a SignedNotaryMessagePB.
+const char* OT_WIRE_PROBE = "OT WIRE PROBE";
+const char* OT_WIRE_ENCODINGS = "OT WIRE ENCODINGS:";
+
+const char* OT_BEGIN_PROTOBUF_MESSAGE = "-----BEGIN OT PROTOBUF MESSAGE-----";
+const char* OT_END_PROTOBUF_MESSAGE = "-----END OT PROTOBUF MESSAGE-----";
+
+// The bytes under an armored field's base64 layer. Armored strings are
+// compressed underneath, so they stay compressed, just not base64 encoded.
+bool raw_bytes(const OTASCIIArmor& armor, std::string& output)
+{
+    output.clear();
+
+    if (!armor.Exists()) return true;
+
+    OTData data;
+
+    if (!armor.GetData(data)) return false;
+
+    output.assign(static_cast<const char*>(data.GetPointer()), data.GetSize());
+
+    return true;
+}
+
+bool set_raw_bytes(OTASCIIArmor& armor, const std::string& input)
+{
+    armor.Release();
+
+    if (input.empty()) return true;
+
+    return armor.SetData(
+        OTData(input.data(), static_cast<uint32_t>(input.size())));
+}
+
+// How a signed envelope looks inside receipts and the Nymbox.
+void bookend_envelope(const void* data, std::size_t size, String& output)
+{
+    const OTASCIIArmor armor(OTData(data, static_cast<uint32_t>(size)));
+    std::string text(OT_BEGIN_PROTOBUF_MESSAGE);
+    text += "\n";
+    text.append(armor.Get(), armor.GetLength());
+    text += OT_END_PROTOBUF_MESSAGE;
+    text += "\n";
+
+    output.Set(text.c_str());
+}
+
+}  // namespace
+
 OTMessageStrategyManager Message::messageStrategyManager;
 
 bool Message::HarvestTransactionNumbers(
@@ -226,6 +299,12 @@ void Message::UpdateContents()
 
     m_lTime = OTTimeGetCurrentTime();
 
+    if (MessageEncoding::PROTOBUF == encoding_) {
+        updateCanonical();
+
+        return;
+    }
+
     Tag tag("notaryMessage");
 
     tag.add_attribute("version", m_strVersion.Get());
@@ -274,6 +353,208 @@ void Message::UpdateContents()
     m_xmlUnsigned.Concatenate("%s", str_result.c_str());
 }
 
+// Every field is carried, whatever the command, so the other side loads
+// exactly the members that were signed.
+void Message::updateCanonical()
+{
+    canonical_.Release();
+
+    OTDB::NotaryMessagePB message;
+    message.set_version(m_strVersion.Get());
+    message.set_date_signed(m_lTime);
+    message.set_command(m_strCommand.Get());
+
+    if (m_strNotaryID.Exists()) message.set_notary_id(m_strNotaryID.Get());
+    if (m_strNymID.Exists()) message.set_nym_id(m_strNymID.Get());
+    if (m_strNymboxHash.Exists())
+        message.set_nymbox_hash(m_strNymboxHash.Get());
+    if (m_strInboxHash.Exists()) message.set_inbox_hash(m_strInboxHash.Get());
+    if (m_strOutboxHash.Exists())
+        message.set_outbox_hash(m_strOutboxHash.Get());
+    if (m_strNymID2.Exists()) message.set_nym_id2(m_strNymID2.Get());
+    if (m_strNymPublicKey.Exists())
+        message.set_nym_public_key(m_strNymPublicKey.Get());
+    if (m_strInstrumentDefinitionID.Exists())
+        message.set_instrument_definition_id(
+            m_strInstrumentDefinitionID.Get());
+    if (m_strAcctID.Exists()) message.set_acct_id(m_strAcctID.Get());
+    if (m_strType.Exists()) message.set_type(m_strType.Get());
+    if (m_strRequestNum.Exists())
+        message.set_request_num(m_strRequestNum.Get());
+
+    std::string bytes;
+
+    if (!raw_bytes(m_ascInReferenceTo, bytes)) {
+        otErr << __FUNCTION__ << ": Failed decoding inReferenceTo.\n";
+        return;
+    }
+    if (!bytes.empty()) message.set_in_reference_to(bytes);
+
+    if (!raw_bytes(m_ascPayload, bytes)) {
+        otErr << __FUNCTION__ << ": Failed decoding payload.\n";
+        return;
+    }
+    if (!bytes.empty()) message.set_payload(bytes);
+
+    if (!raw_bytes(m_ascPayload2, bytes)) {
+        otErr << __FUNCTION__ << ": Failed decoding payload2.\n";
+        return;
+    }
+    if (!bytes.empty()) message.set_payload2(bytes);
+
+    if (!raw_bytes(m_ascPayload3, bytes)) {
+        otErr << __FUNCTION__ << ": Failed decoding payload3.\n";
+        return;
+    }
+    if (!bytes.empty()) message.set_payload3(bytes);
+
+    std::set<int64_t> acknowledged;
+    m_AcknowledgedReplies.Output(acknowledged);
+
+    for (const auto& it : acknowledged) {
+        message.add_acknowledged_replies(it);
+    }
+
+    if (0 != m_lNewRequestNum) message.set_new_request_num(m_lNewRequestNum);
+    if (0 != m_lDepth) message.set_depth(m_lDepth);
+    if (0 != m_lTransactionNum)
+        message.set_transaction_num(m_lTransactionNum);
+    if (0 != keytypeAuthent_) message.set_keytype_authent(keytypeAuthent_);
+    if (0 != keytypeEncrypt_) message.set_keytype_encrypt(keytypeEncrypt_);
+
+    message.set_success(m_bSuccess);
+    message.set_flag(m_bBool);
+
+    if (!message.SerializeToString(&bytes)) {
+        otErr << __FUNCTION__ << ": Failed serializing message.\n";
+        return;
+    }
+
+    canonical_.Assign(bytes.data(), static_cast<uint32_t>(bytes.size()));
+}
+
+bool Message::loadEnvelope(const void* data, std::size_t size)
+{
+    OTDB::SignedNotaryMessagePB envelope;
+    OTDB::NotaryMessagePB message;
+
+    if (!envelope.ParseFromArray(data, static_cast<int>(size)) ||
+        !message.ParseFromString(envelope.message())) {
+        otErr << __FUNCTION__ << ": Failed parsing message envelope.\n";
+        return false;
+    }
+
+    encoding_ = MessageEncoding::PROTOBUF;
+    canonical_.Assign(
+        envelope.message().data(),
+        static_cast<uint32_t>(envelope.message().size()));
+
+    if (envelope.has_hash_type()) {
+        m_strSigHashType = CryptoHash::StringToHashType(
+            String(envelope.hash_type().c_str()));
+    }
+
+    ReleaseSignatures();
+
+    for (const auto& it : envelope.signature()) {
+        std::unique_ptr<OTSignature> pSig(new OTSignature());
+        const std::string& metadata = it.metadata();
+
+        if ((4 == metadata.size()) &&
+            !pSig->getMetaData().SetMetadata(
+                metadata[0], metadata[1], metadata[2], metadata[3])) {
+            otErr << __FUNCTION__ << ": Bad signature metadata.\n";
+            return false;
+        }
+
+        if (!pSig->SetData(OTData(
+                it.signature().data(),
+                static_cast<uint32_t>(it.signature().size())))) {
+            return false;
+        }
+
+        m_listSignatures.push_back(pSig.release());
+    }
+
+    m_strVersion.Set(message.version().c_str());
+    m_lTime = message.date_signed();
+    m_strCommand.Set(message.command().c_str());
+    m_strNotaryID.Set(message.notary_id().c_str());
+    m_strNymID.Set(message.nym_id().c_str());
+    m_strNymboxHash.Set(message.nymbox_hash().c_str());
+    m_strInboxHash.Set(message.inbox_hash().c_str());
+    m_strOutboxHash.Set(message.outbox_hash().c_str());
+    m_strNymID2.Set(message.nym_id2().c_str());
+    m_strNymPublicKey.Set(message.nym_public_key().c_str());
+    m_strInstrumentDefinitionID.Set(
+        message.instrument_definition_id().c_str());
+    m_strAcctID.Set(message.acct_id().c_str());
+    m_strType.Set(message.type().c_str());
+    m_strRequestNum.Set(message.request_num().c_str());
+
+    if (!set_raw_bytes(m_ascInReferenceTo, message.in_reference_to()) ||
+        !set_raw_bytes(m_ascPayload, message.payload()) ||
+        !set_raw_bytes(m_ascPayload2, message.payload2()) ||
+        !set_raw_bytes(m_ascPayload3, message.payload3())) {
+        otErr << __FUNCTION__ << ": Failed encoding a payload.\n";
+        return false;
+    }
+
+    m_AcknowledgedReplies.Release();
+
+    for (const auto& it : message.acknowledged_replies()) {
+        m_AcknowledgedReplies.Add(it);
+    }
+
+    m_lNewRequestNum = message.new_request_num();
+    m_lDepth = message.depth();
+    m_lTransactionNum = message.transaction_num();
+    keytypeAuthent_ = message.keytype_authent();
+    keytypeEncrypt_ = message.keytype_encrypt();
+    m_bSuccess = message.success();
+    m_bBool = message.flag();
+
+    return true;
+}
+
+bool Message::saveEnvelope(std::string& output) const
+{
+    output.clear();
+
+    if (canonical_.IsEmpty()) {
+        otErr << __FUNCTION__ << ": Message was never signed.\n";
+        return false;
+    }
+
+    OTDB::SignedNotaryMessagePB envelope;
+    envelope.set_message(canonical_.GetPointer(), canonical_.GetSize());
+    envelope.set_hash_type(
+        CryptoHash::HashTypeToString(m_strSigHashType).Get());
+
+    for (const auto& it : m_listSignatures) {
+        OT_ASSERT(nullptr != it);
+
+        OTData signature;
+
+        if (!it->GetData(signature)) return false;
+
+        OTDB::NotarySignaturePB* pSig = envelope.add_signature();
+        pSig->set_signature(signature.GetPointer(), signature.GetSize());
+
+        const OTSignatureMetadata& metadata = it->getMetaData();
+
+        if (metadata.HasMetadata()) {
+            const char meta[] = {metadata.GetKeyType(),
+                                 metadata.FirstCharNymID(),
+                                 metadata.FirstCharMasterCredID(),
+                                 metadata.FirstCharChildCredID()};
+            pSig->set_metadata(meta, sizeof(meta));
+        }
+    }
+
+    return envelope.SerializeToString(&output);
+}
+
 bool Message::updateContentsByType(Tag& parent)
 {
     OTMessageStrategy* strategy =
@@ -400,6 +681,36 @@ bool Message::SignContract(const Nym& theNym, const OTPasswordData* pPWData)
     ReleaseSignatures();  // Note: this might change with credentials. We might
                           // require multiple signatures.
 
+    if (MessageEncoding::PROTOBUF == encoding_) {
+        // The signature is detached: it covers canonical_, not m_xmlUnsigned.
+        const OTAsymmetricKey& theKey = theNym.GetPrivateAuthKey();
+        std::unique_ptr<OTSignature> pSig(new OTSignature());
+
+        if (nullptr != theKey.m_pMetadata) {
+            pSig->getMetaData() = *(theKey.m_pMetadata);
+        }
+
+        UpdateContents();
+
+        OTData signature;
+        m_bIsSigned = !canonical_.IsEmpty() &&
+                      theKey.engine().Sign(
+                          canonical_,
+                          theKey,
+                          m_strSigHashType,
+                          signature,
+                          pPWData) &&
+                      pSig->SetData(signature);
+
+        if (m_bIsSigned) {
+            m_listSignatures.push_back(pSig.release());
+        } else {
+            otWarn << "Failure signing " << m_strCommand << " message.\n";
+        }
+
+        return m_bIsSigned;
+    }
+
     // Use the authentication key instead of the signing key.
     //
     m_bIsSigned = Contract::SignContractAuthent(theNym, pPWData);
@@ -433,7 +744,263 @@ bool Message::VerifySignature(const Nym& theNym, const OTPasswordData* pPWData)
     // probably be
     // the same way. (Maybe it already is, by the time you are reading this.)
     //
-    return VerifySigAuthent(theNym, pPWData);
+    if (MessageEncoding::PROTOBUF != encoding_) {
+        return VerifySigAuthent(theNym, pPWData);
+    }
+
+    String strNymID;
+    theNym.GetIdentifier(strNymID);
+    char cNymID = '0';
+    uint32_t uIndex = 3;
+    const bool bNymID = strNymID.At(uIndex, cNymID);
+    OTPasswordData thePWData("Message::VerifySignature");
+
+    for (auto& it : m_listSignatures) {
+        OTSignature* pSig = it;
+        OT_ASSERT(nullptr != pSig);
+
+        if (bNymID && pSig->getMetaData().HasMetadata() &&
+            (pSig->getMetaData().FirstCharNymID() != cNymID)) {
+            continue;
+        }
+
+        listOfAsymmetricKeys listOutput;
+        theNym.GetPublicKeysBySignature(listOutput, *pSig, 'A');
+
+        for (auto& key : listOutput) {
+            OT_ASSERT(nullptr != key);
+
+            if (verifyCanonical(
+                    *key,
+                    *pSig,
+                    (nullptr != pPWData) ? pPWData : &thePWData)) {
+                return true;
+            }
+        }
+
+        // Like VerifySigAuthent, fall back to the default authentication
+        // key.
+        if (verifyCanonical(
+                theNym.GetPublicAuthKey(),
+                *pSig,
+                (nullptr != pPWData) ? pPWData : &thePWData)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// virtual (Contract)
+bool Message::VerifyWithKey(
+    const OTAsymmetricKey& theKey,
+    const OTPasswordData* pPWData) const
+{
+    if (MessageEncoding::PROTOBUF != encoding_) {
+        return Contract::VerifyWithKey(theKey, pPWData);
+    }
+
+    OTPasswordData thePWData("Message::VerifyWithKey");
+
+    for (auto& it : m_listSignatures) {
+        OT_ASSERT(nullptr != it);
+
+        if (verifyCanonical(
+                theKey, *it, (nullptr != pPWData) ? pPWData : &thePWData)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Message::verifyCanonical(
+    const OTAsymmetricKey& theKey,
+    const OTSignature& theSignature,
+    const OTPasswordData* pPWData) const
+{
+    if ((nullptr != theKey.m_pMetadata) && theKey.m_pMetadata->HasMetadata() &&
+        theSignature.getMetaData().HasMetadata() &&
+        (theSignature.getMetaData() != *(theKey.m_pMetadata))) {
+        return false;
+    }
+
+    OTData signature;
+
+    if (canonical_.IsEmpty() || !theSignature.GetData(signature)) {
+        return false;
+    }
+
+    return theKey.engine().Verify(
+        canonical_, theKey, signature, m_strSigHashType, pPWData);
+}
+
+// virtual (Contract)
+bool Message::LoadContractFromString(const String& theStr)
+{
+    encoding_ = MessageEncoding::XML;
+    canonical_.Release();
+
+    const char* szBegin = std::strstr(theStr.Get(), OT_BEGIN_PROTOBUF_MESSAGE);
+
+    if (nullptr == szBegin) {
+        return Contract::LoadContractFromString(theStr);
+    }
+
+    Release();
+
+    szBegin += std::strlen(OT_BEGIN_PROTOBUF_MESSAGE);
+    const char* szEnd = std::strstr(szBegin, OT_END_PROTOBUF_MESSAGE);
+
+    if (nullptr == szEnd) {
+        otErr << __FUNCTION__ << ": Missing end of protobuf message.\n";
+        return false;
+    }
+
+    OTASCIIArmor armor;
+    armor.MemSet(szBegin, static_cast<uint32_t>(szEnd - szBegin));
+    OTData envelope;
+
+    if (!armor.GetData(envelope) ||
+        !loadEnvelope(envelope.GetPointer(), envelope.GetSize())) {
+        return false;
+    }
+
+    m_strRawFile.Set(theStr);
+
+    return true;
+}
+
+// virtual (Contract)
+bool Message::SaveContract()
+{
+    if (MessageEncoding::PROTOBUF != encoding_) {
+        return Contract::SaveContract();
+    }
+
+    std::string envelope;
+
+    if (!saveEnvelope(envelope)) return false;
+
+    bookend_envelope(envelope.data(), envelope.size(), m_strRawFile);
+
+    return true;
+}
+
+void Message::SetEncoding(MessageEncoding encoding) { encoding_ = encoding; }
+
+std::atomic<MessageEncoding> Message::default_encoding_{MessageEncoding::XML};
+
+// static
+void Message::SetDefaultEncoding(MessageEncoding encoding)
+{
+    default_encoding_.store(encoding);
+}
+
+bool Message::SaveWire(std::string& output) const
+{
+    output.clear();
+
+    if (MessageEncoding::PROTOBUF == encoding_) {
+        std::string envelope;
+
+        if (!saveEnvelope(envelope)) return false;
+
+        output.reserve(envelope.size() + 1);
+        output.push_back(OT_WIRE_PROTOBUF);
+        output.append(envelope);
+
+        return true;
+    }
+
+    String strContents;
+    SaveContractRaw(strContents);
+    const OTASCIIArmor ascContents(strContents);
+
+    if (!ascContents.Exists()) return false;
+
+    output.assign(ascContents.Get(), ascContents.GetLength());
+
+    return true;
+}
+
+bool Message::LoadWire(const std::string& input)
+{
+    if (input.empty()) return false;
+
+    if (OT_WIRE_PROTOBUF != input[0]) {
+        OTASCIIArmor ascMessage;
+        ascMessage.MemSet(input.data(), static_cast<uint32_t>(input.size()));
+        String strContents;
+
+        return ascMessage.GetString(strContents) && strContents.Exists() &&
+               LoadContractFromString(strContents);
+    }
+
+    Release();
+
+    if (!loadEnvelope(input.data() + 1, input.size() - 1)) return false;
+
+    bookend_envelope(input.data() + 1, input.size() - 1, m_strRawFile);
+
+    return true;
+}
+
+// static
+std::string Message::WireProbe()
+{
+    return std::string(1, OT_WIRE_PROTOBUF) + OT_WIRE_PROBE;
+}
+
+// static
+bool Message::IsWireProbe(const std::string& input)
+{
+    return WireProbe() == input;
+}
+
+// static
+std::string Message::WireProbeReply()
+{
+    return std::string(1, OT_WIRE_PROTOBUF) + OT_WIRE_ENCODINGS +
+           " xml protobuf";
+}
+
+// static
+bool Message::ProbeReplySupports(
+    const std::string& reply,
+    MessageEncoding encoding)
+{
+    const std::string prefix = std::string(1, OT_WIRE_PROTOBUF) +
+                               OT_WIRE_ENCODINGS;
+
+    if (0 != reply.compare(0, prefix.size(), prefix)) return false;
+
+    std::istringstream encodings(reply.substr(prefix.size()));
+    const std::string wanted =
+        (MessageEncoding::PROTOBUF == encoding) ? "protobuf" : "xml";
+    std::string name;
+
+    while (encodings >> name) {
+        if (wanted == name) return true;
+    }
+
+    return false;
+}
+
+// static
+std::string Message::WireErrorReply(const std::string& request)
+{
+    if (!request.empty() && (OT_WIRE_PROTOBUF == request[0])) {
+        return std::string(1, OT_WIRE_PROTOBUF);
+    }
+
+    return "";
+}
+
+// static
+bool Message::IsWireErrorReply(const std::string& reply)
+{
+    return reply.empty() || (std::string(1, OT_WIRE_PROTOBUF) == reply);
 }
 
 // Unlike other contracts, which do not change over time, and thus calculate
@@ -452,6 +1019,8 @@ bool Message::VerifyContractID() const { return true; }
 Message::Message()
     : Contract()
     , m_bIsSigned(false)
+    , encoding_(default_encoding_.load())
+    , canonical_()
     , m_lNewRequestNum(0)
     , m_lDepth(0)
     , m_lTransactionNum(0)
@@ -491,6 +1060,7 @@ public:
         pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
         pTag->add_attribute("marketID", m.m_strNymID2.Get());
         pTag->add_attribute("depth", formatLong(m.m_lDepth));
+        pTag->add_attribute("marketVersion", formatLong(m.m_lTransactionNum));
 
         parent.add_tag(pTag);
     }
@@ -507,6 +1077,12 @@ public:
 
         if (strDepth.GetLength() > 0) m.m_lDepth = strDepth.ToLong();
 
+        // Optional: the version of the offers the client already has.
+        String strMarketVersion = xml->getAttributeValue("marketVersion");
+
+        if (strMarketVersion.GetLength() > 0)
+            m.m_lTransactionNum = strMarketVersion.ToLong();
+
         otWarn << "\nCommand: " << m.m_strCommand
                << "\nNymID:    " << m.m_strNymID
                << "\nNotaryID: " << m.m_strNotaryID
@@ -534,6 +1110,8 @@ public:
         pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
         pTag->add_attribute("depth", formatLong(m.m_lDepth));
         pTag->add_attribute("marketID", m.m_strNymID2.Get());
+        pTag->add_attribute("marketVersion", formatLong(m.m_lTransactionNum));
+        pTag->add_attribute("notModified", formatBool(m.m_bBool));
 
         if (m.m_bSuccess && (m.m_ascPayload.GetLength() > 2) &&
             (m.m_lDepth > 0)) {
@@ -559,6 +1137,16 @@ public:
 
         if (strDepth.GetLength() > 0) m.m_lDepth = strDepth.ToLong();
 
+        // If notModified is true, the client already has the current version
+        // and there is no payload.
+        String strMarketVersion = xml->getAttributeValue("marketVersion");
+
+        if (strMarketVersion.GetLength() > 0)
+            m.m_lTransactionNum = strMarketVersion.ToLong();
+
+        m.m_bBool =
+            String(xml->getAttributeValue("notModified")).Compare("true");
+
         const char* pElementExpected = nullptr;
         if (m.m_bSuccess && (m.m_lDepth > 0))
             pElementExpected = "messagePayload";
@@ -617,6 +1205,7 @@ public:
         pTag->add_attribute("nymID", m.m_strNymID.Get());
         pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
         pTag->add_attribute("marketID", m.m_strNymID2.Get());
+        pTag->add_attribute("marketVersion", formatLong(m.m_lTransactionNum));
 
         parent.add_tag(pTag);
     }
@@ -629,6 +1218,12 @@ public:
         m.m_strRequestNum = xml->getAttributeValue("requestNum");
         m.m_strNymID2 = xml->getAttributeValue("marketID");
 
+        // Optional: the version of the trades the client already has.
+        String strMarketVersion = xml->getAttributeValue("marketVersion");
+
+        if (strMarketVersion.GetLength() > 0)
+            m.m_lTransactionNum = strMarketVersion.ToLong();
+
         otWarn << "\nCommand: " << m.m_strCommand
                << "\nNymID:    " << m.m_strNymID
                << "\nNotaryID: " << m.m_strNotaryID
@@ -656,6 +1251,8 @@ public:
         pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
         pTag->add_attribute("depth", formatLong(m.m_lDepth));
         pTag->add_attribute("marketID", m.m_strNymID2.Get());
+        pTag->add_attribute("marketVersion", formatLong(m.m_lTransactionNum));
+        pTag->add_attribute("notModified", formatBool(m.m_bBool));
 
         if (m.m_bSuccess && (m.m_ascPayload.GetLength() > 2) &&
             (m.m_lDepth > 0)) {
@@ -681,6 +1278,16 @@ public:
 
         if (strDepth.GetLength() > 0) m.m_lDepth = strDepth.ToLong();
 
+        // If notModified is true, the client already has the current version
+        // and there is no payload.
+        String strMarketVersion = xml->getAttributeValue("marketVersion");
+
+        if (strMarketVersion.GetLength() > 0)
+            m.m_lTransactionNum = strMarketVersion.ToLong();
+
+        m.m_bBool =
+            String(xml->getAttributeValue("notModified")).Compare("true");
+
         const char* pElementExpected = nullptr;
         if (m.m_bSuccess && (m.m_lDepth > 0))
             pElementExpected = "messagePayload";
@@ -3879,4 +4486,100 @@ RegisterStrategy StrategyGetMarketListResponse::reg(
     "getMarketListResponse",
     new StrategyGetMarketListResponse());
 
+class StrategyGetCommandStats : public OTMessageStrategy
+{
+public:
+    virtual void writeXml(Message& m, Tag& parent)
+    {
+        TagPtr pTag(new Tag(m.m_strCommand.Get()));
+
+        pTag->add_attribute("requestNum", m.m_strRequestNum.Get());
+        pTag->add_attribute("nymID", m.m_strNymID.Get());
+        pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
+
+        parent.add_tag(pTag);
+    }
+
+    virtual int32_t processXml(Message& m, irr::io::IrrXMLReader*& xml)
+    {
+        m.m_strCommand = xml->getNodeName();  // Command
+        m.m_strNymID = xml->getAttributeValue("nymID");
+        m.m_strNotaryID = xml->getAttributeValue("notaryID");
+        m.m_strRequestNum = xml->getAttributeValue("requestNum");
+
+        otWarn << "\nCommand: " << m.m_strCommand
+               << "\nNymID:    " << m.m_strNymID
+               << "\nNotaryID: " << m.m_strNotaryID
+               << "\nRequest #: " << m.m_strRequestNum << "\n";
+
+        return 1;
+    }
+    static RegisterStrategy reg;
+};
+RegisterStrategy StrategyGetCommandStats::reg(
+    "getCommandStats",
+    new StrategyGetCommandStats());
+
+class StrategyGetCommandStatsResponse : public OTMessageStrategy
+{
+public:
+    virtual int32_t processXml(Message& m, irr::io::IrrXMLReader*& xml)
+    {
+        processXmlSuccess(m, xml);
+
+        m.m_strCommand = xml->getNodeName();  // Command
+        m.m_strRequestNum = xml->getAttributeValue("requestNum");
+        m.m_strNymID = xml->getAttributeValue("nymID");
+        m.m_strNotaryID = xml->getAttributeValue("notaryID");
+
+        const char* pElementExpected =
+            m.m_bSuccess ? "messagePayload" : "inReferenceTo";
+        OTASCIIArmor ascTextExpected;
+
+        if (!Contract::LoadEncodedTextFieldByName(
+                xml, ascTextExpected, pElementExpected)) {
+            otErr << "Error in OTMessage::ProcessXMLNode: "
+                     "Expected "
+                  << pElementExpected << " element with text field, for "
+                  << m.m_strCommand << ".\n";
+            return (-1);  // error condition
+        }
+
+        if (m.m_bSuccess)
+            m.m_ascPayload.Set(ascTextExpected);
+        else
+            m.m_ascInReferenceTo.Set(ascTextExpected);
+
+        otWarn << "\nCommand: " << m.m_strCommand << "   "
+               << (m.m_bSuccess ? "SUCCESS" : "FAILED")
+               << "\nNymID:    " << m.m_strNymID
+               << "\n NotaryID: " << m.m_strNotaryID << "\n\n";
+
+        return 1;
+    }
+
+    virtual void writeXml(Message& m, Tag& parent)
+    {
+        TagPtr pTag(new Tag(m.m_strCommand.Get()));
+
+        pTag->add_attribute("success", formatBool(m.m_bSuccess));
+        pTag->add_attribute("requestNum", m.m_strRequestNum.Get());
+        pTag->add_attribute("nymID", m.m_strNymID.Get());
+        pTag->add_attribute("notaryID", m.m_strNotaryID.Get());
+
+        if (m.m_bSuccess) {
+            pTag->add_tag("messagePayload", m.m_ascPayload.Get());
+        } else {
+            pTag->add_tag("inReferenceTo", m.m_ascInReferenceTo.Get());
+        }
+
+        parent.add_tag(pTag);
+    }
+
+    static RegisterStrategy reg;
+};
+RegisterStrategy StrategyGetCommandStatsResponse::reg(
+    "getCommandStatsResponse",
+    new StrategyGetCommandStatsResponse());
+
 }  // namespace opentxs
@@ -82,6 +82,13 @@
 namespace opentxs
 {
 
+Nym::NymfileSaved Nym::nymfile_saved_;
+
+void Nym::SetNymfileSavedCallback(NymfileSaved callback)
+{
+    nymfile_saved_ = callback;
+}
+
 // static
 void Nym::SetAsPrivate(bool isPrivate) { m_bPrivate = isPrivate; }
 
@@ -4366,6 +4373,8 @@ bool Nym::SaveSignedNymfile(Nym& SIGNER_NYM)
             otErr << __FUNCTION__
                   << ": Failed while calling theNymfile.SaveFile() for Nym "
                   << strNymID << " using Signer Nym " << strSignerNymID << "\n";
+        } else if (nymfile_saved_) {
+            nymfile_saved_(*this, theNymfile.GetFilePayload());
         }
 
         return bSaved;
@@ -41,6 +41,7 @@
 #include "opentxs/core/Log.hpp"
 #include "opentxs/core/OTData.hpp"
 #include "opentxs/core/OTStoragePB.hpp"
+#include "opentxs/core/WorkingSet.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/stdafx.hpp"
 #include "opentxs/core/util/OTDataFolder.hpp"
@@ -520,6 +521,12 @@ bool Exists(
         return false;
     }
 
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if ((nullptr != workingSet) && workingSet->Handles(strFolder)) {
+        return workingSet->Exists(strFolder, oneStr, twoStr, threeStr);
+    }
+
     return pStorage->Exists(strFolder, oneStr, twoStr, threeStr);
 }
 
@@ -652,6 +659,13 @@ bool StorePlainString(
         return false;
     }
 
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if ((nullptr != workingSet) && workingSet->Handles(strFolder)) {
+        return workingSet->Store(
+            strContents, strFolder, oneStr, twoStr, threeStr);
+    }
+
     return pStorage->StorePlainString(
         strContents, strFolder, oneStr, twoStr, threeStr);
 }
@@ -686,6 +700,12 @@ std::string QueryPlainString(
         return std::string("");
     }
 
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if ((nullptr != workingSet) && workingSet->Handles(strFolder)) {
+        return workingSet->Query(strFolder, oneStr, twoStr, threeStr);
+    }
+
     return pStorage->QueryPlainString(strFolder, oneStr, twoStr, threeStr);
 }
 
@@ -798,6 +818,12 @@ bool EraseValueByKey(
         return false;
     }
 
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if ((nullptr != workingSet) && workingSet->Handles(strFolder)) {
+        return workingSet->Erase(strFolder, oneStr, twoStr, threeStr);
+    }
+
     return pStorage->EraseValueByKey(strFolder, oneStr, twoStr, threeStr);
 }
 
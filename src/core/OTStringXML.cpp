@@ -40,6 +40,9 @@
 
 #include "opentxs/core/String.hpp"
 
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
 #include <irrxml/irrXML.hpp>
 
 namespace opentxs
@@ -113,16 +116,15 @@ OTStringXML::operator irr::io::IFileReadCallBack*()
 
 int32_t OTStringXML::read(void* buffer, uint32_t sizeToRead)
 {
-    if (buffer && sizeToRead && Exists()) {
-        char* pBuf = static_cast<char*>(buffer);
-
-        int32_t nBytesToCopy =
-            (sizeToRead > GetLength() ? GetLength() : sizeToRead);
-        int32_t i;
-        for (i = 0; i < nBytesToCopy; i++) {
-            pBuf[i] = sgetc();
-        }
-        return i;
+    if (buffer && sizeToRead && Exists() && (position_ < length_)) {
+        // irrXML reads the whole document in one call, so hand it the
+        // remaining contents in a single copy.
+        const uint32_t nBytesToCopy =
+            std::min(sizeToRead, length_ - position_);
+        memcpy(buffer, data_ + position_, nBytesToCopy);
+        position_ += nBytesToCopy;
+
+        return static_cast<int32_t>(nBytesToCopy);
     }
     else {
         return 0;
@@ -45,8 +45,10 @@
 #include "opentxs/core/Ledger.hpp"
 #include "opentxs/core/Log.hpp"
 #include "opentxs/core/NumList.hpp"
+#include "opentxs/core/Nym.hpp"
 #include "opentxs/core/OTTransaction.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/WorkingSet.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/util/Assert.hpp"
 
@@ -313,12 +315,25 @@ bool OTTransactionType::VerifyAccount(const Nym& theNym)
                  "OTTransactionType::VerifyAccount\n";
         return false;
     }
-    else if (!VerifySignature(theNym)) {
+    // The server's working set remembers files that already verified, so a
+    // hot account or box is only checked again once it changes.
+    WorkingSet* workingSet = WorkingSet::It();
+    const bool bVerified =
+        (nullptr != workingSet) &&
+        workingSet->IsVerified(m_strFoldername, m_strFilename, m_strRawFile,
+                               theNym.ID());
+
+    if (!bVerified && !VerifySignature(theNym)) {
         otErr << "Error verifying signature in "
                  "OTTransactionType::VerifyAccount.\n";
         return false;
     }
 
+    if (!bVerified && (nullptr != workingSet)) {
+        workingSet->Verified(m_strFoldername, m_strFilename, m_strRawFile,
+                             theNym.ID());
+    }
+
     otLog4 << "\nWe now know that...\n"
               "1) The expected Account ID matches the ID that was found on the "
               "object.\n"
@@ -0,0 +1,527 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/core/WorkingSet.hpp"
+
+#include "opentxs/core/Identifier.hpp"
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/OTStorage.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/util/OTFolders.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace opentxs
+{
+
+std::unique_ptr<WorkingSet> WorkingSet::it_;
+
+WorkingSet::Request::Request()
+    : outer_(false)
+{
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if (nullptr != workingSet) {
+        outer_ = workingSet->begin();
+    }
+}
+
+WorkingSet::Request::~Request()
+{
+    WorkingSet* workingSet = WorkingSet::It();
+
+    if (outer_ && (nullptr != workingSet)) {
+        workingSet->commit();
+    }
+}
+
+WorkingSet::Entry::Entry()
+    : exists_(false)
+    , dirty_(false)
+    , generation_(0)
+{
+}
+
+WorkingSet::WorkingSet(std::size_t capacity)
+    : capacity_(capacity)
+    , folders_({OTFolders::Account().Get(), OTFolders::Inbox().Get(),
+                OTFolders::Outbox().Get(), OTFolders::Nymbox().Get()})
+    , size_(0)
+    , hits_(0)
+    , misses_(0)
+    , commits_(0)
+    , coalesced_(0)
+    , verifications_(0)
+{
+}
+
+WorkingSet::~WorkingSet()
+{
+    otInfo << "WorkingSet: " << hits_ << " hits, " << misses_ << " misses, "
+           << commits_ << " files committed, " << coalesced_
+           << " writes coalesced, " << verifications_
+           << " verifications skipped.\n";
+}
+
+void WorkingSet::Start(std::size_t capacity)
+{
+    if (0 == capacity) {
+        it_.reset();
+    } else {
+        it_.reset(new WorkingSet(capacity));
+    }
+}
+
+void WorkingSet::Stop() { it_.reset(); }
+
+WorkingSet* WorkingSet::It() { return it_.get(); }
+
+std::string WorkingSet::key(const std::string& folder, const std::string& one,
+                            const std::string& two, const std::string& three)
+{
+    std::string output(folder);
+
+    for (const auto* part : {&one, &two, &three}) {
+        if (!part->empty()) {
+            output += '/';
+            output += *part;
+        }
+    }
+
+    return output;
+}
+
+std::string WorkingSet::contract_key(const String& folder,
+                                     const String& filename)
+{
+    // Contracts keep their path with the platform's separator.
+    std::string output(filename.Get());
+    std::replace(output.begin(), output.end(), Log::PathSeparator()[0], '/');
+
+    return std::string(folder.Get()) + '/' + output;
+}
+
+bool WorkingSet::Handles(const std::string& folder) const
+{
+    return folders_.end() !=
+           std::find(folders_.begin(), folders_.end(), folder);
+}
+
+bool WorkingSet::begin()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    return requests_.insert({std::this_thread::get_id(), {}}).second;
+}
+
+// Called with lock_ held. Records the file against the request open on this
+// thread, if there is one.
+bool WorkingSet::pending(const std::string& key)
+{
+    auto it = requests_.find(std::this_thread::get_id());
+
+    if (requests_.end() == it) {
+        return false;
+    }
+
+    it->second.push_back(key);
+
+    return true;
+}
+
+// Called with lock_ held.
+WorkingSet::Entry& WorkingSet::insert(const std::string& key,
+                                      const std::string& folder,
+                                      const std::string& one,
+                                      const std::string& two,
+                                      const std::string& three)
+{
+    auto it = files_.find(key);
+
+    if (files_.end() != it) {
+        touch(it->second);
+
+        return it->second;
+    }
+
+    Entry& entry = files_[key];
+    entry.folder_ = folder;
+    entry.one_ = one;
+    entry.two_ = two;
+    entry.three_ = three;
+    lru_.push_front(key);
+    entry.lru_ = lru_.begin();
+
+    return entry;
+}
+
+// Called with lock_ held.
+void WorkingSet::touch(Entry& entry)
+{
+    lru_.splice(lru_.begin(), lru_, entry.lru_);
+}
+
+// Called with lock_ held.
+void WorkingSet::drop(std::map<std::string, Entry>::iterator it)
+{
+    size_ -= it->second.Size();
+    lru_.erase(it->second.lru_);
+    files_.erase(it);
+}
+
+std::mutex& WorkingSet::write_lock(const std::string& key)
+{
+    return write_locks_[std::hash<std::string>()(key) % WRITE_LOCKS];
+}
+
+// Called with lock_ held. Files waiting to be committed are never dropped.
+void WorkingSet::trim()
+{
+    auto it = lru_.end();
+
+    while ((size_ > capacity_) && (lru_.begin() != it)) {
+        --it;
+        auto file = files_.find(*it);
+
+        if (file->second.dirty_) {
+            continue;
+        }
+
+        ++it;
+        drop(file);
+    }
+}
+
+bool WorkingSet::Exists(const std::string& folder, const std::string& one,
+                        const std::string& two, const std::string& three)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = files_.find(key(folder, one, two, three));
+
+        if (files_.end() != it) {
+            return it->second.exists_;
+        }
+    }
+
+    OTDB::Storage* storage = OTDB::details::s_pStorage;
+
+    return (nullptr != storage) && storage->Exists(folder, one, two, three);
+}
+
+std::string WorkingSet::Query(const std::string& folder,
+                              const std::string& one, const std::string& two,
+                              const std::string& three)
+{
+    const std::string id = key(folder, one, two, three);
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = files_.find(id);
+
+        if (files_.end() != it) {
+            ++hits_;
+            touch(it->second);
+
+            return it->second.exists_ ? it->second.contents_ : "";
+        }
+    }
+
+    ++misses_;
+    OTDB::Storage* storage = OTDB::details::s_pStorage;
+
+    if (nullptr == storage) {
+        return "";
+    }
+
+    // Read outside the lock so other requests aren't held up by storage.
+    // Whoever wrote the file in the meantime already left their copy here.
+    const std::string contents =
+        storage->QueryPlainString(folder, one, two, three);
+
+    if (!contents.empty()) {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        if (files_.end() == files_.find(id)) {
+            Entry& entry = insert(id, folder, one, two, three);
+            entry.contents_ = contents;
+            entry.exists_ = true;
+            size_ += entry.Size();
+            trim();
+        }
+    }
+
+    return contents;
+}
+
+bool WorkingSet::Store(const std::string& contents, const std::string& folder,
+                       const std::string& one, const std::string& two,
+                       const std::string& three)
+{
+    const std::string id = key(folder, one, two, three);
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        if (pending(id)) {
+            Entry& entry = insert(id, folder, one, two, three);
+
+            if (entry.dirty_) {
+                ++coalesced_;
+            }
+
+            size_ -= entry.Size();
+            entry.contents_ = contents;
+            entry.exists_ = true;
+            entry.dirty_ = true;
+            ++entry.generation_;
+            size_ += entry.Size();
+            trim();
+
+            return true;
+        }
+    }
+
+    OTDB::Storage* storage = OTDB::details::s_pStorage;
+    std::lock_guard<std::mutex> writeLock(write_lock(id));
+    const bool stored =
+        (nullptr != storage) &&
+        storage->StorePlainString(contents, folder, one, two, three);
+
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (stored) {
+        Entry& entry = insert(id, folder, one, two, three);
+        size_ -= entry.Size();
+        entry.contents_ = contents;
+        entry.exists_ = true;
+        // This write supersedes any copy a request is still holding back.
+        entry.dirty_ = false;
+        ++entry.generation_;
+        size_ += entry.Size();
+        trim();
+    } else {
+        auto it = files_.find(id);
+
+        if (files_.end() != it) {
+            drop(it);
+        }
+    }
+
+    return stored;
+}
+
+bool WorkingSet::Erase(const std::string& folder, const std::string& one,
+                       const std::string& two, const std::string& three)
+{
+    const std::string id = key(folder, one, two, three);
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        if (pending(id)) {
+            Entry& entry = insert(id, folder, one, two, three);
+            size_ -= entry.Size();
+            entry.contents_.clear();
+            entry.verified_.clear();
+            entry.exists_ = false;
+            entry.dirty_ = true;
+            ++entry.generation_;
+            size_ += entry.Size();
+
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> writeLock(write_lock(id));
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = files_.find(id);
+
+        if (files_.end() != it) {
+            drop(it);
+        }
+    }
+
+    OTDB::Storage* storage = OTDB::details::s_pStorage;
+
+    return (nullptr != storage) &&
+           storage->EraseValueByKey(folder, one, two, three);
+}
+
+bool WorkingSet::IsVerified(const String& folder, const String& filename,
+                            const String& contents, const Identifier& signer)
+{
+    const String signerID(signer);
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = files_.find(contract_key(folder, filename));
+
+    if (files_.end() == it) {
+        return false;
+    }
+
+    const Entry& entry = it->second;
+
+    if ((entry.signer_ != signerID.Get()) ||
+        (entry.verified_ != contents.Get())) {
+        return false;
+    }
+
+    ++verifications_;
+
+    return true;
+}
+
+void WorkingSet::Verified(const String& folder, const String& filename,
+                          const String& contents, const Identifier& signer)
+{
+    const String signerID(signer);
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = files_.find(contract_key(folder, filename));
+
+    if (files_.end() == it) {
+        return;
+    }
+
+    Entry& entry = it->second;
+    size_ -= entry.Size();
+    entry.signer_ = signerID.Get();
+    entry.verified_ = contents.Get();
+    size_ += entry.Size();
+    trim();
+}
+
+// Writes one held back file, unless it was written since it was saved.
+bool WorkingSet::write(const std::string& id)
+{
+    std::lock_guard<std::mutex> writeLock(write_lock(id));
+    Entry file;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = files_.find(id);
+
+        if ((files_.end() == it) || !it->second.dirty_) {
+            return true;
+        }
+
+        file = it->second;
+    }
+
+    OTDB::Storage* storage = OTDB::details::s_pStorage;
+    bool done = false;
+
+    if (nullptr != storage) {
+        done = file.exists_
+                   ? storage->StorePlainString(file.contents_, file.folder_,
+                                               file.one_, file.two_,
+                                               file.three_)
+                   : storage->EraseValueByKey(file.folder_, file.one_,
+                                              file.two_, file.three_);
+    }
+
+    ++commits_;
+
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = files_.find(id);
+
+    // Saved again while it was being written: the newer copy stays dirty
+    // for whoever saved it.
+    if ((files_.end() == it) || (it->second.generation_ != file.generation_)) {
+        return done;
+    }
+
+    // A file that failed to write, or was erased, is read from storage
+    // next time.
+    if (!done || !file.exists_) {
+        drop(it);
+    } else {
+        it->second.dirty_ = false;
+    }
+
+    return done;
+}
+
+// Writes everything the request on this thread left behind, in the order it
+// was first saved.
+void WorkingSet::commit()
+{
+    std::vector<std::string> ids;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto request = requests_.find(std::this_thread::get_id());
+
+        if (requests_.end() == request) {
+            return;
+        }
+
+        // Later saves of the same file replaced it in place, so each file is
+        // written once.
+        for (const auto& id : request->second) {
+            if (ids.end() == std::find(ids.begin(), ids.end(), id)) {
+                ids.push_back(id);
+            }
+        }
+
+        requests_.erase(request);
+    }
+
+    for (const auto& id : ids) {
+        if (!write(id)) {
+            otErr << "WorkingSet::commit: Failed writing " << id << "\n";
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+    trim();
+}
+
+} // namespace opentxs
@@ -44,6 +44,7 @@
 #include "opentxs/core/app/Dht.hpp"
 #include "opentxs/core/app/Settings.hpp"
 #include "opentxs/core/crypto/CryptoEngine.hpp"
+#include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/Common.hpp"
 #include "opentxs/core/util/OTDataFolder.hpp"
@@ -74,6 +75,7 @@ void App::Init()
 {
     shutdown_.store(false);
     Init_Config();
+    Init_Armor();
     Init_Contracts();
     Init_Crypto();
     Init_Identity();
@@ -89,6 +91,32 @@ void App::Init_Config()
     config_ = new Settings(strConfigFilePath);
 }
 
+void App::Init_Armor()
+{
+    std::string codec;
+    int64_t level = 0;
+    bool notUsed;
+
+    Config().CheckSet_str(
+        "armor", "compression", "zlib", codec, notUsed, "zlib or zstd");
+    Config().CheckSet_long(
+        "armor",
+        "compression_level",
+        OTASCIIArmor::CompressionLevel(),
+        level,
+        notUsed,
+        "zlib: 0-9, zstd: 1-22");
+
+    const ArmorCompression compression =
+        ("zstd" == codec) ? ArmorCompression::ZSTD : ArmorCompression::ZLIB;
+
+    if (!OTASCIIArmor::SetCompression(
+            compression, static_cast<int32_t>(level))) {
+        otErr << __FUNCTION__ << ": Unsupported armor compression " << codec
+              << " at level " << level << ". Using the default.\n";
+    }
+}
+
 void App::Init_Contracts() { contract_manager_.reset(new class Wallet); }
 
 void App::Init_Crypto() { crypto_ = &CryptoEngine::It(); }
@@ -139,12 +167,30 @@ void App::Init_Storage()
         config.auto_publish_units_,
         config.auto_publish_units_,
         notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "cache_size",
+        config.cache_size_,
+        config.cache_size_,
+        notUsed);
     Config().CheckSet_long(
         "storage",
         "gc_interval",
         config.gc_interval_,
         config.gc_interval_,
         notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "gc_step_size",
+        config.gc_step_size_,
+        config.gc_step_size_,
+        notUsed);
+    Config().CheckSet_long(
+        "storage",
+        "gc_step_delay",
+        config.gc_step_delay_,
+        config.gc_step_delay_,
+        notUsed);
     Config().CheckSet_str(
         "storage", "path", String(config.path_), config.path_, notUsed);
 #ifdef OT_STORAGE_FS
@@ -166,6 +212,38 @@ void App::Init_Storage()
         String(config.fs_root_file_),
         config.fs_root_file_,
         notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "fs_gc_cursor_file",
+        String(config.fs_gc_cursor_file_),
+        config.fs_gc_cursor_file_,
+        notUsed);
+#endif
+#ifdef OT_STORAGE_LOG
+    Config().CheckSet_str(
+        "storage",
+        "log_primary",
+        String(config.log_primary_bucket_),
+        config.log_primary_bucket_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "log_secondary",
+        String(config.log_secondary_bucket_),
+        config.log_secondary_bucket_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "log_root_file",
+        String(config.log_root_file_),
+        config.log_root_file_,
+        notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "log_gc_cursor_file",
+        String(config.log_gc_cursor_file_),
+        config.log_gc_cursor_file_,
+        notUsed);
 #endif
 #ifdef OT_STORAGE_SQLITE
     Config().CheckSet_str(
@@ -192,6 +270,12 @@ void App::Init_Storage()
         String(config.sqlite3_root_key_),
         config.sqlite3_root_key_,
         notUsed);
+    Config().CheckSet_str(
+        "storage",
+        "sqlite3_gc_cursor_key",
+        String(config.sqlite3_gc_cursor_key_),
+        config.sqlite3_gc_cursor_key_,
+        notUsed);
     Config().CheckSet_str(
         "storage",
         "sqlite3_db_file",
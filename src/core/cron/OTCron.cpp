@@ -57,12 +57,19 @@
 
 #include <irrxml/irrXML.hpp>
 #include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <set>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -79,6 +86,12 @@ int32_t OTCron::__cron_ms_between_process = 10000; // The number of milliseconds
 int32_t OTCron::__cron_max_items_per_nym = 10; // The maximum number of cron
                                                // items any given Nym can have
                                                // active at the same time.
+int32_t OTCron::__cron_max_threads = 4; // The number of threads processing
+                                        // independent cron items at once.
+int32_t OTCron::__cron_market_snapshot_interval = 1000; // The number of
+                                                        // journaled changes
+                                                        // between market
+                                                        // snapshots.
 
 Timer OTCron::tCron(true);
 
@@ -106,6 +119,17 @@ bool OTCron::SaveCron()
 
     OT_ASSERT(nullptr != GetServerNym());
 
+    // Items on other threads may be halfway through changing, so the save
+    // happens once all of them have finished.
+    if (m_bDeferSave.load()) {
+        m_bSavePending.store(true);
+        return true;
+    }
+
+    // The markets are written first, so the cron file never refers to trades
+    // whose market changes could still be lost.
+    CommitMarkets();
+
     ReleaseSignatures();
 
     // Sign it, save it internally to string, and then save that out to the
@@ -120,6 +144,36 @@ bool OTCron::SaveCron()
         return true;
 }
 
+// Writes whatever the markets have queued on their journals.
+void OTCron::CommitMarkets()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
+    for (auto& it : m_mapMarkets) {
+        OTMarket* pMarket = it.second;
+        OT_ASSERT(nullptr != pMarket);
+
+        if (pMarket->HasPendingChanges() || pMarket->SnapshotDue()) {
+            pMarket->SaveMarket();
+        }
+    }
+}
+
+void OTCron::SnapshotMarkets()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
+    for (auto& it : m_mapMarkets) {
+        OTMarket* pMarket = it.second;
+        OT_ASSERT(nullptr != pMarket);
+
+        if (!pMarket->SaveSnapshot()) {
+            otErr << "OTCron::" << __FUNCTION__
+                  << ": Failed saving market: " << it.first << "\n";
+        }
+    }
+}
+
 // Loops through ALL markets, and calls pMarket->GetNym_OfferList(NYM_ID,
 // *pOfferList) for each.
 // Returns a list of all the offers that a specific Nym has on all the markets.
@@ -252,13 +306,11 @@ bool OTCron::GetMarketList(OTASCIIArmor& ascOutput, int32_t& nMarketCount)
 
         pMarketData->last_sale_date = pMarket->GetLastSaleDate();
 
-        const mapOfOffers::size_type theBidCount = pMarket->GetBidCount();
-        const mapOfOffers::size_type theAskCount = pMarket->GetAskCount();
+        const std::size_t theBidCount = pMarket->GetBidCount();
+        const std::size_t theAskCount = pMarket->GetAskCount();
 
-        pMarketData->number_bids =
-            to_string<mapOfOffers::size_type>(theBidCount);
-        pMarketData->number_asks =
-            to_string<mapOfOffers::size_type>(theAskCount);
+        pMarketData->number_bids = to_string<std::size_t>(theBidCount);
+        pMarketData->number_asks = to_string<std::size_t>(theAskCount);
 
         // In the past 24 hours.
         // (I'm not collecting this data yet, (maybe never), so these values
@@ -332,6 +384,8 @@ bool OTCron::GetMarketList(OTASCIIArmor& ascOutput, int32_t& nMarketCount)
 
 int32_t OTCron::GetTransactionCount() const
 {
+    std::lock_guard<std::mutex> lock(m_lockTransactionNumbers);
+
     if (m_listTransactionNumbers.empty()) return 0;
 
     return static_cast<int32_t>(m_listTransactionNumbers.size());
@@ -339,6 +393,7 @@ int32_t OTCron::GetTransactionCount() const
 
 void OTCron::AddTransactionNumber(const int64_t& lTransactionNum)
 {
+    std::lock_guard<std::mutex> lock(m_lockTransactionNumbers);
     m_listTransactionNumbers.push_back(lTransactionNum);
 }
 
@@ -346,6 +401,8 @@ void OTCron::AddTransactionNumber(const int64_t& lTransactionNum)
 // payment plans until the server object replenishes this list.
 int64_t OTCron::GetNextTransactionNumber()
 {
+    std::lock_guard<std::mutex> lock(m_lockTransactionNumbers);
+
     if (m_listTransactionNumbers.empty()) return 0;
 
     int64_t lTransactionNum = m_listTransactionNumbers.front();
@@ -523,6 +580,9 @@ void OTCron::UpdateContents()
     tag.add_attribute("version", m_strVersion.Get());
     tag.add_attribute("notaryID", NOTARY_ID.Get());
 
+    std::lock_guard<std::recursive_mutex> lockMarkets(m_lockMarkets);
+    std::lock_guard<std::mutex> lockNumbers(m_lockTransactionNumbers);
+
     // Save the Market entries (the markets themselves are saved in a markets
     // folder.)
     for (auto& it : m_mapMarkets) {
@@ -610,12 +670,58 @@ void OTCron::ProcessCronItems()
         return;
     }
     bool bNeedToSave = false;
+    const time64_t tNow = OTTimeGetCurrentTime();
+    std::set<std::string> setChangedMarkets;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lockWakeups);
+        setChangedMarkets.swap(m_setChangedMarkets);
+    }
+
+    // A trade resting on a market can only match once that market changes, so
+    // the trades on every market which changed since the last round are due.
+    for (const auto& str_MARKET_ID : setChangedMarkets) {
+        auto it_market = m_mapMarkets.find(str_MARKET_ID);
 
-    // loop through the cron items and tell each one to ProcessCron().
+        if (m_mapMarkets.end() == it_market) continue;
+
+        OT_ASSERT(nullptr != it_market->second);
+
+        for (const auto& it_offer : it_market->second->GetOffers()) {
+            WakeCronItem(it_offer.first);
+        }
+    }
+
+    // Collect the items that are due before processing any of them, since
+    // processing reschedules them (and may wake others.)
+    std::vector<int64_t> vecDue;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lockWakeups);
+
+        for (const auto& it : m_setWakeups) {
+            if (it.first > tNow) break;
+
+            vecDue.push_back(it.second);
+        }
+    }
+
+    std::vector<std::vector<int64_t>> vecPartitions;
+    std::vector<int64_t> vecSerial;
+    PartitionCronItems(vecDue, vecPartitions, vecSerial);
+
+    if (!vecPartitions.empty()) {
+        m_bDeferSave.store(true);
+        ProcessPartitions(vecPartitions, nTwentyPercent);
+        m_bDeferSave.store(false);
+        bNeedToSave = m_bSavePending.exchange(false);
+        CommitMarkets(); // The snapshots held back during the round.
+    }
+
+    // Whatever couldn't be partitioned runs here, one item at a time.
     // If the item returns true, that means leave it on the list. Otherwise,
     // if it returns false, that means "it's done: remove it."
-    for (auto it = m_multimapCronItems.begin();
-         it != m_multimapCronItems.end();) {
+    for (const auto& lTransactionNum : vecSerial) {
         if (GetTransactionCount() <= nTwentyPercent) {
             otErr << "WARNING: Cron has fewer than 20 percent of its normal "
                      "transaction "
@@ -630,32 +736,314 @@ void OTCron::ProcessCronItems()
                      "SCHEDULED FOR THIS ROUND!!!\n\n";
             break;
         }
-        OTCronItem* pItem = it->second;
+        auto it_map = m_mapCronItems.find(lTransactionNum);
+
+        if (m_mapCronItems.end() == it_map) continue;
+
+        OTCronItem* pItem = it_map->second;
         OT_ASSERT(nullptr != pItem);
-        otInfo << "OTCron::" << __FUNCTION__
-               << ": Processing item number: " << pItem->GetTransactionNum()
-               << " \n";
 
-        if (pItem->ProcessCron()) {
-            it++;
+        UnscheduleCronItem(lTransactionNum);
+
+        if (ProcessCronItem(*pItem)) {
+            ScheduleCronItem(lTransactionNum, pItem->GetNextWakeTime());
             continue;
         }
-        pItem->HookRemovalFromCron(nullptr, GetNextTransactionNumber());
-        otOut << "OTCron::" << __FUNCTION__
-              << ": Removing cron item: " << pItem->GetTransactionNum() << "\n";
-        it = m_multimapCronItems.erase(it);
-        auto it_map = FindItemOnMap(pItem->GetTransactionNum());
-        OT_ASSERT(m_mapCronItems.end() != it_map);
-        m_mapCronItems.erase(it_map);
-
-        delete pItem;
-        pItem = nullptr;
 
+        RemoveProcessedItem(lTransactionNum);
         bNeedToSave = true;
     }
     if (bNeedToSave) SaveCron();
 }
 
+// Returns false if the item is done, in which case its removal hooks have
+// already run, and it only remains to take it off the lists.
+bool OTCron::ProcessCronItem(OTCronItem& theItem)
+{
+    otInfo << "OTCron::" << __FUNCTION__
+           << ": Processing item number: " << theItem.GetTransactionNum()
+           << " \n";
+
+    if (theItem.ProcessCron()) return true;
+
+    theItem.HookRemovalFromCron(nullptr, GetNextTransactionNumber());
+    otOut << "OTCron::" << __FUNCTION__
+          << ": Removing cron item: " << theItem.GetTransactionNum() << "\n";
+
+    return false;
+}
+
+void OTCron::RemoveProcessedItem(int64_t lTransactionNum)
+{
+    auto it_map = FindItemOnMap(lTransactionNum);
+    OT_ASSERT(m_mapCronItems.end() != it_map);
+    auto it_multimap = FindItemOnMultimap(lTransactionNum);
+    OT_ASSERT(m_multimapCronItems.end() != it_multimap);
+
+    OTCronItem* pItem = it_map->second;
+    m_multimapCronItems.erase(it_multimap);
+    m_mapCronItems.erase(it_map);
+    UnscheduleCronItem(lTransactionNum);
+
+    delete pItem;
+}
+
+std::string OTCron::MarketResource(const Identifier& INSTRUMENT_DEFINITION_ID,
+                                   const Identifier& CURRENCY_ID)
+{
+    const String strInstrument(INSTRUMENT_DEFINITION_ID),
+        strCurrency(CURRENCY_ID);
+
+    return std::string("market:") + strInstrument.Get() + "/" +
+           strCurrency.Get();
+}
+
+// Groups the due items so that no two groups share an account, Nym or market.
+// A trade can settle against any offer on its market, so the resources of
+// every trade resting on a market belong to that market's group as well.
+// Items which can't list their resources are returned in vecSerial.
+void OTCron::PartitionCronItems(
+    const std::vector<int64_t>& vecDue,
+    std::vector<std::vector<int64_t>>& vecPartitions,
+    std::vector<int64_t>& vecSerial)
+{
+    if (GetCronMaxThreads() < 2) {
+        vecSerial = vecDue;
+        return;
+    }
+
+    std::map<std::string, std::string> mapParent;
+
+    auto find = [&](const std::string& strKey) -> std::string {
+        auto it = mapParent.find(strKey);
+
+        if (mapParent.end() == it) {
+            mapParent[strKey] = strKey;
+            return strKey;
+        }
+
+        std::string strRoot = strKey;
+
+        while (mapParent[strRoot] != strRoot) strRoot = mapParent[strRoot];
+
+        // Point the whole path at the root. Every trade on a market re-roots
+        // the market's group, so without this the path grows with each one.
+        for (std::string strNode = strKey; strNode != strRoot;) {
+            std::string& strParent = mapParent[strNode];
+            const std::string strNext = strParent;
+            strParent = strRoot;
+            strNode = strNext;
+        }
+
+        return strRoot;
+    };
+
+    auto unite = [&](const std::set<std::string>& setKeys) {
+        if (setKeys.empty()) return;
+
+        const std::string strRoot = find(*setKeys.begin());
+
+        for (const auto& strKey : setKeys) {
+            const std::string strOther = find(strKey);
+
+            if (strOther != strRoot) mapParent[strOther] = strRoot;
+        }
+    };
+
+    std::vector<std::pair<int64_t, std::string>> vecKeyed;
+
+    for (const auto& lTransactionNum : vecDue) {
+        auto it_map = m_mapCronItems.find(lTransactionNum);
+
+        if (m_mapCronItems.end() == it_map) continue;
+
+        std::set<std::string> setResources;
+
+        if (!it_map->second->GetCronResources(setResources) ||
+            setResources.empty()) {
+            vecSerial.push_back(lTransactionNum);
+            continue;
+        }
+
+        unite(setResources);
+        vecKeyed.push_back(std::make_pair(lTransactionNum,
+                                          *setResources.begin()));
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
+        for (auto& it : m_mapMarkets) {
+            OTMarket* pMarket = it.second;
+            OT_ASSERT(nullptr != pMarket);
+
+            const std::string strMarket =
+                MarketResource(pMarket->GetInstrumentDefinitionID(),
+                               pMarket->GetCurrencyID());
+
+            if (mapParent.end() == mapParent.find(strMarket)) continue;
+
+            for (const auto& it_offer : pMarket->GetOffers()) {
+                auto it_map = m_mapCronItems.find(it_offer.first);
+
+                if (m_mapCronItems.end() == it_map) continue;
+
+                std::set<std::string> setResources;
+                setResources.insert(strMarket);
+                it_map->second->GetCronResources(setResources);
+                unite(setResources);
+            }
+        }
+    }
+
+    // Due order is kept within each group.
+    std::map<std::string, std::size_t> mapGroups;
+
+    for (const auto& it : vecKeyed) {
+        const std::string strRoot = find(it.second);
+        auto it_group = mapGroups.find(strRoot);
+
+        if (mapGroups.end() == it_group) {
+            it_group =
+                mapGroups.insert(std::make_pair(strRoot, vecPartitions.size()))
+                    .first;
+            vecPartitions.push_back(std::vector<int64_t>());
+        }
+
+        vecPartitions[it_group->second].push_back(it.first);
+    }
+}
+
+// Runs each group on one of up to GetCronMaxThreads() threads. Items are only
+// taken off the cron lists (and rescheduled) once every thread has finished,
+// so those lists don't change while the groups are running.
+void OTCron::ProcessPartitions(
+    const std::vector<std::vector<int64_t>>& vecPartitions,
+    int32_t nMinimumTransactions)
+{
+    // 0: not processed, 1: stays on cron, 2: done.
+    std::vector<std::vector<char>> vecResults(vecPartitions.size());
+
+    for (std::size_t i = 0; i < vecPartitions.size(); ++i) {
+        vecResults[i].assign(vecPartitions[i].size(), 0);
+
+        for (const auto& lTransactionNum : vecPartitions[i]) {
+            UnscheduleCronItem(lTransactionNum);
+        }
+    }
+
+    std::atomic<std::size_t> nNext(0);
+    std::atomic<bool> bOutOfNumbers(false);
+
+    // Every worker signs receipts with the server Nym. Its keys hold their
+    // own locks while they are instantiated and used, so the items of
+    // different partitions only share the Nym, never an EVP_PKEY in flight.
+
+    auto worker = [&]() {
+        for (std::size_t i = nNext++; i < vecPartitions.size(); i = nNext++) {
+            for (std::size_t j = 0; j < vecPartitions[i].size(); ++j) {
+                if (GetTransactionCount() <= nMinimumTransactions) {
+                    if (!bOutOfNumbers.exchange(true))
+                        otErr << "WARNING: Cron has fewer than 20 percent of "
+                                 "its normal transaction number count "
+                                 "available! SKIPPING THE REMAINDER OF THE "
+                                 "CRON ITEMS THAT WERE SCHEDULED FOR THIS "
+                                 "ROUND!!!\n\n";
+                    return;
+                }
+
+                auto it_map = m_mapCronItems.find(vecPartitions[i][j]);
+                OT_ASSERT(m_mapCronItems.end() != it_map);
+
+                vecResults[i][j] = ProcessCronItem(*it_map->second) ? 1 : 2;
+            }
+        }
+    };
+
+    const std::size_t nThreads = std::min(
+        static_cast<std::size_t>(GetCronMaxThreads()), vecPartitions.size());
+    std::vector<std::thread> vecThreads;
+
+    for (std::size_t i = 1; i < nThreads; ++i) {
+        vecThreads.push_back(std::thread(worker));
+    }
+
+    worker();
+
+    for (auto& thread : vecThreads) {
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < vecPartitions.size(); ++i) {
+        for (std::size_t j = 0; j < vecPartitions[i].size(); ++j) {
+            const int64_t lTransactionNum = vecPartitions[i][j];
+            auto it_map = m_mapCronItems.find(lTransactionNum);
+            OT_ASSERT(m_mapCronItems.end() != it_map);
+
+            switch (vecResults[i][j]) {
+                case 0:
+                    ScheduleCronItem(lTransactionNum, OT_TIME_ZERO);
+                    break;
+                case 1:
+                    ScheduleCronItem(
+                        lTransactionNum, it_map->second->GetNextWakeTime());
+                    break;
+                default:
+                    RemoveProcessedItem(lTransactionNum);
+                    m_bSavePending.store(true);
+            }
+        }
+    }
+}
+
+void OTCron::ScheduleCronItem(int64_t lTransactionNum, time64_t tWakeTime)
+{
+    std::lock_guard<std::mutex> lock(m_lockWakeups);
+    auto it = m_mapWakeups.find(lTransactionNum);
+
+    if (m_mapWakeups.end() != it) {
+        m_setWakeups.erase(std::make_pair(it->second, lTransactionNum));
+        it->second = tWakeTime;
+    }
+    else
+        m_mapWakeups[lTransactionNum] = tWakeTime;
+
+    m_setWakeups.insert(std::make_pair(tWakeTime, lTransactionNum));
+}
+
+void OTCron::UnscheduleCronItem(int64_t lTransactionNum)
+{
+    std::lock_guard<std::mutex> lock(m_lockWakeups);
+    auto it = m_mapWakeups.find(lTransactionNum);
+
+    if (m_mapWakeups.end() == it) return;
+
+    m_setWakeups.erase(std::make_pair(it->second, lTransactionNum));
+    m_mapWakeups.erase(it);
+}
+
+// An item which is not scheduled is either not on Cron, or is the one being
+// processed right now (and will be rescheduled once it has finished.)
+void OTCron::WakeCronItem(int64_t lTransactionNum)
+{
+    std::lock_guard<std::mutex> lock(m_lockWakeups);
+    auto it = m_mapWakeups.find(lTransactionNum);
+
+    if (m_mapWakeups.end() == it) return;
+
+    m_setWakeups.erase(std::make_pair(it->second, lTransactionNum));
+    it->second = OT_TIME_ZERO;
+    m_setWakeups.insert(std::make_pair(OT_TIME_ZERO, lTransactionNum));
+}
+
+void OTCron::MarketChanged(const Identifier& MARKET_ID)
+{
+    const String str_MARKET_ID(MARKET_ID);
+
+    std::lock_guard<std::mutex> lock(m_lockWakeups);
+    m_setChangedMarkets.insert(str_MARKET_ID.Get());
+}
+
 // OTCron IS responsible for cleaning up theItem, and takes ownership.
 // So make SURE it is allocated on the HEAP before you pass it in here, and
 // also make sure to delete it again if this call fails!
@@ -706,6 +1094,9 @@ bool OTCron::AddCronItem(OTCronItem& theItem, Nym* pActivator,
             m_multimapCronItems.upper_bound(tDateAdded),
             std::pair<time64_t, OTCronItem*>(tDateAdded, &theItem));
 
+        // New items are due on the next round.
+        ScheduleCronItem(theItem.GetTransactionNum(), OT_TIME_ZERO);
+
         theItem.SetCronPointer(*this);
         theItem.setServerNym(m_pServerNym);
         theItem.setNotaryID(&m_NOTARY_ID);
@@ -795,6 +1186,7 @@ bool OTCron::RemoveCronItem(int64_t lTransactionNum,
 
         m_mapCronItems.erase(it_map);           // Remove from MAP.
         m_multimapCronItems.erase(it_multimap); // Remove from MULTIMAP.
+        UnscheduleCronItem(lTransactionNum);
 
         delete pItem;
 
@@ -938,6 +1330,8 @@ bool OTCron::AddMarket(OTMarket& theMarket, bool bSaveMarketFile)
 {
     OT_ASSERT(nullptr != GetServerNym());
 
+    std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
     theMarket.SetCronPointer(
         *this); // This way every Market has a pointer to Cron.
 
@@ -1002,6 +1396,8 @@ OTMarket* OTCron::GetOrCreateMarket(const Identifier& INSTRUMENT_DEFINITION_ID,
                                     const Identifier& CURRENCY_ID,
                                     const int64_t& lScale)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
     OTMarket* pMarket = new OTMarket(GetNotaryID(), INSTRUMENT_DEFINITION_ID,
                                      CURRENCY_ID, lScale);
 
@@ -1040,6 +1436,8 @@ OTMarket* OTCron::GetOrCreateMarket(const Identifier& INSTRUMENT_DEFINITION_ID,
 // If it is, return a pointer to it, otherwise return nullptr.
 OTMarket* OTCron::GetMarket(const Identifier& MARKET_ID)
 {
+    std::lock_guard<std::recursive_mutex> lock(m_lockMarkets);
+
     String str_MARKET_ID(MARKET_ID);
     std::string std_MARKET_ID = str_MARKET_ID.Get();
 
@@ -1135,6 +1533,10 @@ void OTCron::Release_Cron()
         // same pItems being deleted in the next block.
     }
 
+    m_setWakeups.clear();
+    m_mapWakeups.clear();
+    m_setChangedMarkets.clear();
+
     while (!m_mapCronItems.empty()) {
         OTCronItem* pItem = m_mapCronItems.begin()->second;
         auto it = m_mapCronItems.begin();
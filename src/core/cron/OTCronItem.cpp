@@ -49,6 +49,7 @@
 #include "opentxs/core/OTStorage.hpp"
 #include "opentxs/core/OTTransaction.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/cron/OTCron.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
 #include "opentxs/core/recurring/OTPaymentPlan.hpp"
 #include "opentxs/core/script/OTSmartContract.hpp"
@@ -706,6 +707,30 @@ bool OTCronItem::ProcessCron()
     return true;
 }
 
+void OTCronItem::FlagForRemoval()
+{
+    m_bRemovalFlag = true;
+
+    if (nullptr != m_pCron) m_pCron->WakeCronItem(GetTransactionNum());
+}
+
+// Subclasses skip processing until more than GetProcessInterval() seconds have
+// passed since the last time, so there is no reason to call them sooner.
+// Items which don't track a process date are due on every round.
+time64_t OTCronItem::GetNextWakeTime() const
+{
+    if (IsFlaggedForRemoval() || (OT_TIME_ZERO == GetLastProcessDate()))
+        return OT_TIME_ZERO;
+
+    return OTTimeAddTimeInterval(GetLastProcessDate(),
+                                 GetProcessInterval() + 1);
+}
+
+bool OTCronItem::GetCronResources(std::set<std::string>&) const
+{
+    return false;
+}
+
 // OTCron calls this when a cron item is added.
 // bForTheFirstTime=true means that this cron item is being
 // activated for the very first time. (Versus being re-added
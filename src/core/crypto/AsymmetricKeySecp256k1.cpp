@@ -52,6 +52,7 @@
 #include "opentxs/core/util/Assert.hpp"
 
 #include <sodium/crypto_box.h>
+#include <mutex>
 #include <ostream>
 #include <string>
 
@@ -94,6 +95,9 @@ AsymmetricKeySecp256k1::AsymmetricKeySecp256k1(const String& publicKey)
 
 void AsymmetricKeySecp256k1::ReleaseKeyLowLevel_Hook() const
 {
+    std::lock_guard<std::mutex> lock(parsed_lock_);
+
+    parsed_.reset();
 }
 
 CryptoAsymmetric& AsymmetricKeySecp256k1::engine() const
@@ -45,19 +45,44 @@
 #include "opentxs/core/crypto/CryptoUtil.hpp"
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace opentxs
 {
 
+bool CryptoHash::Digest(
+    const HashType hashType,
+    const void* input,
+    const std::size_t size,
+    std::uint8_t* output,
+    std::size_t& outputSize) const
+{
+    outputSize = 0;
+    std::unique_ptr<Hasher> hasher = Init(hashType);
+
+    if (!hasher) return false;
+
+    return hasher->Update(input, size) && hasher->Final(output, outputSize);
+}
+
 bool CryptoHash::Digest(
     const HashType hashType,
     const String& data,
     OTData& digest)
 {
-    OTData plaintext(data.Get(), data.GetLength());
+    std::uint8_t output[MaxDigestSize];
+    std::size_t size = 0;
+
+    if (!Digest(hashType, data.Get(), data.GetLength(), output, size)) {
+        return false;
+    }
+
+    digest.Assign(output, static_cast<uint32_t>(size));
 
-    return Digest(hashType, plaintext, digest);
+    return true;
 }
 
 bool CryptoHash::Digest(
@@ -65,17 +90,18 @@ bool CryptoHash::Digest(
     const std::string& data,
     std::string& encodedDigest)
 {
-    OTData plaintext(data.c_str(), data.size());
-    OTData result;
+    std::uint8_t output[MaxDigestSize];
+    std::size_t size = 0;
 
-    bool success = Digest(
+    const bool success = Digest(
         static_cast<CryptoHash::HashType>(type),
-        plaintext,
-        result);
+        data.data(),
+        data.size(),
+        output,
+        size);
 
     if (success) {
-        encodedDigest.assign(
-            App::Me().Crypto().Util().Base58CheckEncode(result).Get());
+        encodedDigest = CryptoUtil::Base58CheckEncode(output, size);
     }
 
     return success;
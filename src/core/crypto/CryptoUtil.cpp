@@ -41,13 +41,23 @@
 #include "opentxs/core/OTData.hpp"
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/crypto/OTPassword.hpp"
+#include "opentxs/core/util/Assert.hpp"
 
 #include <bitcoin-base58/base58.h>
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OT_BASE64_X86
+#include <immintrin.h>
+#endif
+
 namespace opentxs
 {
 
@@ -99,6 +109,552 @@ bool CryptoUtil::IsBase62(const std::string& str) const
                "JKLMNOPQRSTUVWXYZ") == std::string::npos;
 }
 
+namespace
+{
+const char OT_BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+// 48 bytes of input fill one 64-character line.
+const std::size_t OT_BASE64_LINE_BYTES = 48;
+
+struct Base64Values {
+    int8_t value_[256];
+
+    Base64Values()
+    {
+        memset(value_, -1, sizeof(value_));
+
+        for (int8_t i = 0; i < 64; ++i) {
+            value_[static_cast<uint8_t>(OT_BASE64_ALPHABET[i])] = i;
+        }
+    }
+};
+
+const Base64Values& base64_values()
+{
+    static const Base64Values values;
+
+    return values;
+}
+
+// Each kernel encodes as many whole 3-byte groups of input as it can and
+// returns the number of bytes used. readable is the number of bytes which may
+// be loaded from input, which can be more than size.
+typedef std::size_t (*EncodeKernel)(
+    const uint8_t* input,
+    const std::size_t size,
+    const std::size_t readable,
+    char* output);
+// Each kernel decodes as many whole 4-character groups as it can, stopping
+// at the first character outside the alphabet, and returns the number of
+// characters used. The SIMD kernels store more bytes than they produce, so
+// they only run while capacity covers the full store.
+typedef std::size_t (*DecodeKernel)(
+    const char* input,
+    const std::size_t size,
+    uint8_t* output,
+    const std::size_t capacity);
+
+std::size_t encode_scalar(
+    const uint8_t* input,
+    const std::size_t size,
+    const std::size_t,
+    char* output)
+{
+    std::size_t used = 0;
+
+    for (; (used + 3) <= size; used += 3) {
+        const uint32_t bits = (uint32_t(input[used]) << 16) |
+                              (uint32_t(input[used + 1]) << 8) |
+                              uint32_t(input[used + 2]);
+
+        *output++ = OT_BASE64_ALPHABET[(bits >> 18) & 0x3f];
+        *output++ = OT_BASE64_ALPHABET[(bits >> 12) & 0x3f];
+        *output++ = OT_BASE64_ALPHABET[(bits >> 6) & 0x3f];
+        *output++ = OT_BASE64_ALPHABET[bits & 0x3f];
+    }
+
+    return used;
+}
+
+std::size_t decode_scalar(
+    const char* input,
+    const std::size_t size,
+    uint8_t* output,
+    const std::size_t)
+{
+    const int8_t* values = base64_values().value_;
+    std::size_t used = 0;
+
+    for (; (used + 4) <= size; used += 4) {
+        const int8_t a = values[static_cast<uint8_t>(input[used])];
+        const int8_t b = values[static_cast<uint8_t>(input[used + 1])];
+        const int8_t c = values[static_cast<uint8_t>(input[used + 2])];
+        const int8_t d = values[static_cast<uint8_t>(input[used + 3])];
+
+        if (0 > (a | b | c | d)) break;
+
+        const uint32_t bits = (uint32_t(a) << 18) | (uint32_t(b) << 12) |
+                              (uint32_t(c) << 6) | uint32_t(d);
+
+        *output++ = uint8_t(bits >> 16);
+        *output++ = uint8_t(bits >> 8);
+        *output++ = uint8_t(bits);
+    }
+
+    return used;
+}
+
+#if defined(OT_BASE64_X86)
+// The vector kernels follow Muła and Lemire, "Faster Base64 Encoding and
+// Decoding using AVX2 Instructions". Both widths share the same per-lane
+// shuffles and lookup tables.
+__attribute__((target("ssse3"))) __m128i encode_reshuffle(__m128i in)
+{
+    in = _mm_shuffle_epi8(
+        in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+    return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3"))) __m128i encode_translate(const __m128i in)
+{
+    const __m128i lut = _mm_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+    indices = _mm_sub_epi8(indices, _mm_cmpgt_epi8(in, _mm_set1_epi8(25)));
+
+    return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
+}
+
+__attribute__((target("ssse3"))) std::size_t encode_ssse3(
+    const uint8_t* input,
+    const std::size_t size,
+    const std::size_t readable,
+    char* output)
+{
+    std::size_t used = 0;
+
+    // each step loads 16 bytes and consumes 12 of them
+    while (((used + 12) <= size) && ((used + 16) <= readable)) {
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + used));
+        block = encode_translate(encode_reshuffle(block));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), block);
+        used += 12;
+        output += 16;
+    }
+
+    return used + encode_scalar(input + used, size - used, 0, output);
+}
+
+__attribute__((target("avx2"))) std::size_t encode_avx2(
+    const uint8_t* input,
+    const std::size_t size,
+    const std::size_t readable,
+    char* output)
+{
+    const __m256i shuffle = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i lut = _mm256_setr_epi8(
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+        65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    std::size_t used = 0;
+
+    // each step loads 12 bytes into each lane, reading 28 bytes in total
+    while (((used + 24) <= size) && ((used + 28) <= readable)) {
+        const __m128i low =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + used));
+        const __m128i high = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input + used + 12));
+        __m256i block =
+            _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        block = _mm256_shuffle_epi8(block, shuffle);
+        const __m256i t0 =
+            _mm256_and_si256(block, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 =
+            _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 =
+            _mm256_and_si256(block, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 =
+            _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        block = _mm256_or_si256(t1, t3);
+        __m256i indices = _mm256_subs_epu8(block, _mm256_set1_epi8(51));
+        indices = _mm256_sub_epi8(
+            indices, _mm256_cmpgt_epi8(block, _mm256_set1_epi8(25)));
+        block = _mm256_add_epi8(block, _mm256_shuffle_epi8(lut, indices));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), block);
+        used += 24;
+        output += 32;
+    }
+
+    return used + encode_ssse3(
+                      input + used, size - used, readable - used, output);
+}
+
+__attribute__((target("ssse3"))) std::size_t decode_ssse3(
+    const char* input,
+    const std::size_t size,
+    uint8_t* output,
+    const std::size_t capacity)
+{
+    const __m128i lut_lo = _mm_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    std::size_t used = 0;
+    std::size_t written = 0;
+
+    // each step decodes 16 characters to 12 bytes, but stores 16
+    while (((used + 16) <= size) && ((written + 16) <= capacity)) {
+        __m128i block =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + used));
+        const __m128i hi_nibbles =
+            _mm_and_si128(_mm_srli_epi32(block, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(block, mask_2f);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+        // leave anything outside the alphabet to the scalar kernel
+        if (0 != _mm_movemask_epi8(_mm_cmpgt_epi8(
+                     _mm_and_si128(lo, hi), _mm_setzero_si128()))) {
+            break;
+        }
+
+        const __m128i eq_2f = _mm_cmpeq_epi8(block, mask_2f);
+        const __m128i roll =
+            _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+        block = _mm_add_epi8(block, roll);
+        block = _mm_maddubs_epi16(block, _mm_set1_epi32(0x01400140));
+        block = _mm_madd_epi16(block, _mm_set1_epi32(0x00011000));
+        block = _mm_shuffle_epi8(
+            block,
+            _mm_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + written), block);
+        used += 16;
+        written += 12;
+    }
+
+    return used + decode_scalar(
+                      input + used, size - used, output + written, 0);
+}
+
+__attribute__((target("avx2"))) std::size_t decode_avx2(
+    const char* input,
+    const std::size_t size,
+    uint8_t* output,
+    const std::size_t capacity)
+{
+    const __m256i lut_lo = _mm256_setr_epi8(
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+        0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+        0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m256i lut_hi = _mm256_setr_epi8(
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+        0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+        0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lut_roll = _mm256_setr_epi8(
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    std::size_t used = 0;
+    std::size_t written = 0;
+
+    // each step decodes 32 characters to 24 bytes, but stores 32
+    while (((used + 32) <= size) && ((written + 32) <= capacity)) {
+        __m256i block =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + used));
+        const __m256i hi_nibbles =
+            _mm256_and_si256(_mm256_srli_epi32(block, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(block, mask_2f);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+
+        if (0 != _mm256_movemask_epi8(_mm256_cmpgt_epi8(
+                     _mm256_and_si256(lo, hi), _mm256_setzero_si256()))) {
+            break;
+        }
+
+        const __m256i eq_2f = _mm256_cmpeq_epi8(block, mask_2f);
+        const __m256i roll =
+            _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+        block = _mm256_add_epi8(block, roll);
+        block = _mm256_maddubs_epi16(block, _mm256_set1_epi32(0x01400140));
+        block = _mm256_madd_epi16(block, _mm256_set1_epi32(0x00011000));
+        block = _mm256_shuffle_epi8(block, pack);
+        // move the 12 bytes of the high lane down next to the low lane's
+        block = _mm256_permutevar8x32_epi32(
+            block, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(output + written), block);
+        used += 32;
+        written += 24;
+    }
+
+    return used + decode_ssse3(
+                      input + used,
+                      size - used,
+                      output + written,
+                      capacity - written);
+}
+#endif
+
+bool cpu_supports(const CryptoUtil::Base64Kernel kernel)
+{
+    switch (kernel) {
+#if defined(OT_BASE64_X86)
+        case CryptoUtil::Base64Kernel::AVX2: {
+            __builtin_cpu_init();
+
+            return __builtin_cpu_supports("avx2");
+        }
+        case CryptoUtil::Base64Kernel::SSSE3: {
+            __builtin_cpu_init();
+
+            return __builtin_cpu_supports("ssse3");
+        }
+#endif
+        case CryptoUtil::Base64Kernel::SCALAR: {
+
+            return true;
+        }
+        default: {
+
+            return false;
+        }
+    }
+}
+
+std::atomic<CryptoUtil::Base64Kernel>& selected_kernel()
+{
+    static std::atomic<CryptoUtil::Base64Kernel> kernel(
+        cpu_supports(CryptoUtil::Base64Kernel::AVX2)
+            ? CryptoUtil::Base64Kernel::AVX2
+            : cpu_supports(CryptoUtil::Base64Kernel::SSSE3)
+                  ? CryptoUtil::Base64Kernel::SSSE3
+                  : CryptoUtil::Base64Kernel::SCALAR);
+
+    return kernel;
+}
+
+EncodeKernel encode_kernel()
+{
+    switch (selected_kernel().load()) {
+#if defined(OT_BASE64_X86)
+        case CryptoUtil::Base64Kernel::AVX2: return encode_avx2;
+        case CryptoUtil::Base64Kernel::SSSE3: return encode_ssse3;
+#endif
+        default: return encode_scalar;
+    }
+}
+
+DecodeKernel decode_kernel()
+{
+    switch (selected_kernel().load()) {
+#if defined(OT_BASE64_X86)
+        case CryptoUtil::Base64Kernel::AVX2: return decode_avx2;
+        case CryptoUtil::Base64Kernel::SSSE3: return decode_ssse3;
+#endif
+        default: return decode_scalar;
+    }
+}
+}  // namespace
+
+// static
+bool CryptoUtil::SetBase64Kernel(const Base64Kernel kernel)
+{
+    if (!cpu_supports(kernel)) return false;
+
+    selected_kernel().store(kernel);
+
+    return true;
+}
+
+// static
+CryptoUtil::Base64Kernel CryptoUtil::SelectedBase64Kernel()
+{
+    return selected_kernel().load();
+}
+
+// static
+std::size_t CryptoUtil::Base64EncodedSize(
+    const std::size_t size,
+    const bool bLineBreaks)
+{
+    const std::size_t characters = ((size + 2) / 3) * 4;
+
+    if (!bLineBreaks) return characters;
+
+    return characters + ((characters + 63) / 64);
+}
+
+// static
+void CryptoUtil::Base64Encode(
+    const uint8_t* input,
+    const std::size_t size,
+    const bool bLineBreaks,
+    char* output)
+{
+    const EncodeKernel kernel = encode_kernel();
+    const std::size_t line = bLineBreaks ? OT_BASE64_LINE_BYTES : size;
+    std::size_t used = 0;
+
+    while (used < size) {
+        const std::size_t length = std::min(line, size - used);
+        const std::size_t whole = length - (length % 3);
+
+        kernel(input + used, whole, size - used, output);
+        output += (whole / 3) * 4;
+
+        if (whole < length) {
+            const std::size_t remaining = length - whole;
+            const uint8_t* tail = input + used + whole;
+            const uint32_t bits =
+                (uint32_t(tail[0]) << 16) |
+                ((1 < remaining) ? uint32_t(tail[1]) << 8 : 0);
+
+            *output++ = OT_BASE64_ALPHABET[(bits >> 18) & 0x3f];
+            *output++ = OT_BASE64_ALPHABET[(bits >> 12) & 0x3f];
+            *output++ =
+                (1 < remaining) ? OT_BASE64_ALPHABET[(bits >> 6) & 0x3f] : '=';
+            *output++ = '=';
+        }
+
+        if (bLineBreaks) { *output++ = '\n'; }
+
+        used += length;
+    }
+}
+
+// static
+std::size_t CryptoUtil::Base64DecodeBlocks(
+    const char* input,
+    const std::size_t size,
+    uint8_t* output)
+{
+    return decode_kernel()(input, size, output, (size / 4) * 3);
+}
+
+// Caller responsible to delete.
+char* CryptoUtil::Base64Encode(
+    const uint8_t* input,
+    int32_t in_len,
+    bool bLineBreaks) const
+{
+    OT_ASSERT_MSG(
+        in_len >= 0, "OT_base64_encode: Abort: in_len is a negative number!");
+
+    const std::size_t size = static_cast<std::size_t>(in_len);
+    const std::size_t length = Base64EncodedSize(size, bLineBreaks);
+    char* buf = new char[length + 1];
+    OT_ASSERT(nullptr != buf);
+
+    Base64Encode(input, size, bLineBreaks, buf);
+    buf[length] = '\0';
+
+    return buf;
+}
+
+// Caller responsible to delete.
+uint8_t* CryptoUtil::Base64Decode(
+    const char* input,
+    size_t* out_len,
+    bool) const
+{
+    OT_ASSERT(nullptr != input);
+    OT_ASSERT(nullptr != out_len);
+
+    const DecodeKernel kernel = decode_kernel();
+    const int8_t* values = base64_values().value_;
+    const std::size_t size = strlen(input);
+    const std::size_t capacity = ((size / 4) + 1) * 3;
+    uint8_t* buf = new uint8_t[capacity];
+    OT_ASSERT(nullptr != buf);
+
+    std::size_t used = 0;
+    std::size_t written = 0;
+    uint32_t bits = 0;
+    std::size_t count = 0;
+    bool padded = false;
+
+    while (used < size) {
+        if ((0 == count) && !padded) {
+            const std::size_t decoded = kernel(
+                input + used, size - used, buf + written, capacity - written);
+            used += decoded;
+            written += (decoded / 4) * 3;
+
+            if (used == size) break;
+        }
+
+        const char c = input[used++];
+
+        if (('\n' == c) || ('\r' == c) || (' ' == c) || ('\t' == c)) {
+            continue;
+        }
+
+        if ('=' == c) {
+            padded = true;
+
+            continue;
+        }
+
+        const int8_t value = values[static_cast<uint8_t>(c)];
+
+        if (padded || (0 > value)) {
+            delete[] buf;
+
+            return nullptr;
+        }
+
+        bits = (bits << 6) | uint32_t(value);
+
+        if (4 == ++count) {
+            buf[written++] = uint8_t(bits >> 16);
+            buf[written++] = uint8_t(bits >> 8);
+            buf[written++] = uint8_t(bits);
+            bits = 0;
+            count = 0;
+        }
+    }
+
+    switch (count) {
+        case 0: {
+        } break;
+        case 2: {
+            buf[written++] = uint8_t(bits >> 4);
+        } break;
+        case 3: {
+            buf[written++] = uint8_t(bits >> 10);
+            buf[written++] = uint8_t(bits >> 2);
+        } break;
+        default: {
+            delete[] buf;
+
+            return nullptr;
+        }
+    }
+
+    *out_len = written;
+
+    return buf;
+}
+
 std::string CryptoUtil::RandomFilename() const { return Nonce(16).Get(); }
 
 String CryptoUtil::Nonce(const uint32_t size) const
@@ -121,20 +677,24 @@ String CryptoUtil::Nonce(const uint32_t size, OTData& rawOutput) const
     return nonce;
 }
 
-String CryptoUtil::Base58CheckEncode(const OTData& input)
+std::string CryptoUtil::Base58CheckEncode(
+    const uint8_t* input,
+    const size_t size)
 {
-    OTPassword transformedInput;
-    transformedInput.setMemory(input);
+    return ::EncodeBase58Check(input, input + size);
+}
 
-    return Base58CheckEncode(transformedInput);
+String CryptoUtil::Base58CheckEncode(const OTData& input)
+{
+    return String(Base58CheckEncode(
+        static_cast<const uint8_t*>(input.GetPointer()), input.GetSize()));
 }
 
 String CryptoUtil::Base58CheckEncode(const OTPassword& input)
 {
-    const uint8_t* inputStart = static_cast<const uint8_t*>(input.getMemory());
-    const uint8_t* inputEnd = inputStart + input.getMemorySize();
-
-    return String(::EncodeBase58Check(inputStart, inputEnd));
+    return String(Base58CheckEncode(
+        static_cast<const uint8_t*>(input.getMemory()),
+        input.getMemorySize()));
 }
 
 bool CryptoUtil::Base58CheckDecode(const String& input, OTPassword& output)
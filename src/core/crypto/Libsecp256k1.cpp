@@ -52,9 +52,12 @@
 #include "opentxs/core/crypto/OTAsymmetricKey.hpp"
 #include "opentxs/core/crypto/OTPassword.hpp"
 #include "opentxs/core/crypto/OTPasswordData.hpp"
+#include "opentxs/core/crypto/PrivateKeyCache.hpp"
 #include "opentxs/core/util/Assert.hpp"
 
 #include <stdint.h>
+#include <cstring>
+#include <mutex>
 #include <ostream>
 
 namespace opentxs
@@ -185,26 +188,37 @@ bool Libsecp256k1::AsymmetricKeyToECDSAPubkey(
         const OTAsymmetricKey& asymmetricKey,
         secp256k1_pubkey& pubkey) const
 {
-    String encodedPubkey;
-    bool havePublicKey = asymmetricKey.GetPublicKey(encodedPubkey);
+    const AsymmetricKeySecp256k1& key =
+        static_cast<const AsymmetricKeySecp256k1&>(asymmetricKey);
 
-    if (havePublicKey) {
-        OTData serializedPubkey;
-        bool pubkeydecoded = CryptoUtil::Base58CheckDecode(encodedPubkey.Get(), serializedPubkey);
+    // Parsing a public key decompresses a curve point, so the result is kept
+    // on the key object and reused by every later verification.
+    std::lock_guard<std::mutex> lock(key.parsed_lock_);
 
-        if (pubkeydecoded) {
-            secp256k1_pubkey parsedPubkey;
+    if (key.parsed_) {
+        OT_ASSERT(sizeof(secp256k1_pubkey) == key.parsed_->GetSize());
 
-            bool pubkeyParsed = secp256k1_ec_pubkey_parse(
-                context_,
-                &parsedPubkey,
-                reinterpret_cast<const unsigned char*>(serializedPubkey.GetPointer()),
-                serializedPubkey.GetSize());
+        std::memcpy(&pubkey, key.parsed_->GetPointer(), sizeof(pubkey));
 
-            if (pubkeyParsed) {
-                pubkey = parsedPubkey;
-                return true;
-            }
+        return true;
+    }
+
+    OTData serializedPubkey;
+    bool havePublicKey = key.GetKey(serializedPubkey);
+
+    if (havePublicKey) {
+        secp256k1_pubkey parsedPubkey;
+
+        bool pubkeyParsed = secp256k1_ec_pubkey_parse(
+            context_,
+            &parsedPubkey,
+            reinterpret_cast<const unsigned char*>(serializedPubkey.GetPointer()),
+            serializedPubkey.GetSize());
+
+        if (pubkeyParsed) {
+            key.parsed_.reset(new OTData(&parsedPubkey, sizeof(parsedPubkey)));
+            pubkey = parsedPubkey;
+            return true;
         }
     }
     return false;
@@ -252,8 +266,21 @@ bool Libsecp256k1::AsymmetricKeyToECDSAPrivkey(
     BinarySecret masterPassword(App::Me().Crypto().AES().InstantiateBinarySecretSP());
 
     if (nullptr == exportPassword) {
+        // Keys encrypted to the master key are cached after their first
+        // decryption, so repeated signatures skip the symmetric decryption.
+        if (PrivateKeyCache::It().Get(asymmetricKey, privkey)) {
+            return true;
+        }
+
         masterPassword = CryptoSymmetric::GetMasterKey(passwordData);
-        return ImportECDSAPrivkey(asymmetricKey, *masterPassword, privkey);
+
+        if (ImportECDSAPrivkey(asymmetricKey, *masterPassword, privkey)) {
+            PrivateKeyCache::It().Insert(asymmetricKey, privkey);
+
+            return true;
+        }
+
+        return false;
     } else {
         return ImportECDSAPrivkey(asymmetricKey, *exportPassword, privkey);
     }
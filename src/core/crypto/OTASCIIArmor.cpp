@@ -52,12 +52,18 @@
 #include <sys/types.h>
 #include <zconf.h>
 #include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <fstream>
 #include <sstream>
-#include <stdexcept>
 #include <string>
 
+#ifdef OT_COMPRESSION_ZSTD
+#include <zstd.h>
+#endif
+
 namespace opentxs
 {
 
@@ -189,94 +195,436 @@ OTASCIIArmor& OTASCIIArmor::operator=(const OTASCIIArmor& strValue)
     return *this;
 }
 
-// Source for these two functions: http://panthema.net/2007/0328-ZLibString.html
+namespace
+{
+const std::size_t OT_ARMOR_CHUNK_SIZE = 16384;
+
+// Untagged payloads are zlib streams, whose first byte always has 8 (deflate)
+// in its low nibble. Any other codec is marked by a leading tag byte which can
+// not be mistaken for one, so armor written by older versions still decodes.
+const uint8_t OT_ARMOR_TAG_ZSTD = 0x01;
+
+// The compressed payload is base64-encoded as it is produced. Whole lines
+// are encoded straight from zlib's buffer and only a partial line is carried
+// between calls, so the result is identical to encoding the whole payload at
+// once.
+class Base64Writer
+{
+public:
+    Base64Writer(std::string& output, bool bLineBreaks)
+        : output_(output)
+        , line_breaks_(bLineBreaks)
+    {
+    }
+
+    void Write(const uint8_t* input, std::size_t size)
+    {
+        if (0 < carried_) {
+            const std::size_t count =
+                std::min(sizeof(carry_) - carried_, size);
+            memcpy(carry_ + carried_, input, count);
+            carried_ += count;
+            input += count;
+            size -= count;
+
+            if (sizeof(carry_) == carried_) {
+                encode(carry_, carried_);
+                carried_ = 0;
+            }
+        }
+
+        const std::size_t lines = size - (size % sizeof(carry_));
+
+        if (0 < lines) {
+            encode(input, lines);
+            input += lines;
+            size -= lines;
+        }
+
+        if (0 < size) {
+            memcpy(carry_ + carried_, input, size);
+            carried_ += size;
+        }
+    }
+
+    void Finish()
+    {
+        if (0 < carried_) {
+            encode(carry_, carried_);
+            carried_ = 0;
+        }
+    }
+
+private:
+    std::string& output_;
+    const bool line_breaks_;
+    // one 64-character line of input
+    uint8_t carry_[48]{};
+    std::size_t carried_{0};
+
+    void encode(const uint8_t* input, const std::size_t size)
+    {
+        const std::size_t offset = output_.size();
+        output_.resize(
+            offset + CryptoUtil::Base64EncodedSize(size, line_breaks_));
+        CryptoUtil::Base64Encode(input, size, line_breaks_, &output_[offset]);
+    }
+};
+
+// Decodes armored text a block at a time for the decompressor. Line breaks
+// and other whitespace are skipped wherever they appear, so the same reader
+// handles armor written with or without them.
+class Base64Reader
+{
+public:
+    Base64Reader(const char* input, std::size_t size)
+        : position_(input)
+        , end_(input + size)
+    {
+    }
+
+    bool Error() const { return error_; }
+
+    /** Returns the number of bytes written to output, which is zero once the
+     * input is exhausted. */
+    std::size_t Read(uint8_t* output, const std::size_t size)
+    {
+        std::size_t written = 0;
+
+        while (!error_ && !padded_ && (position_ < end_) &&
+               ((written + 3) <= size)) {
+            if (0 == count_) {
+                const std::size_t length = std::min(
+                    static_cast<std::size_t>(end_ - position_),
+                    ((size - written) / 3) * 4);
+                const std::size_t decoded = CryptoUtil::Base64DecodeBlocks(
+                    position_, length, output + written);
+                position_ += decoded;
+                written += (decoded / 4) * 3;
+
+                if ((position_ == end_) || ((written + 3) > size)) break;
+            }
+
+            const char c = *position_++;
+
+            if (('\n' == c) || ('\r' == c) || (' ' == c) || ('\t' == c)) {
+                continue;
+            }
+
+            if ('=' == c) {
+                padded_ = true;
+
+                break;
+            }
+
+            const int32_t value = decode(c);
 
-/** Compress a STL string using zlib with given compression level and return
- * the binary data. */
-std::string OTASCIIArmor::compress_string(
-    const std::string& str,
-    int32_t compressionlevel = Z_BEST_COMPRESSION) const
+            if (0 > value) {
+                error_ = true;
+
+                return 0;
+            }
+
+            bits_ = (bits_ << 6) | uint32_t(value);
+
+            if (4 == ++count_) {
+                output[written++] = uint8_t(bits_ >> 16);
+                output[written++] = uint8_t(bits_ >> 8);
+                output[written++] = uint8_t(bits_);
+                bits_ = 0;
+                count_ = 0;
+            }
+        }
+
+        if ((padded_ || (position_ == end_)) && (0 < count_)) {
+            switch (count_) {
+                case 2: {
+                    output[written++] = uint8_t(bits_ >> 4);
+                } break;
+                case 3: {
+                    output[written++] = uint8_t(bits_ >> 10);
+                    output[written++] = uint8_t(bits_ >> 2);
+                } break;
+                default: {
+                    error_ = true;
+
+                    return 0;
+                }
+            }
+
+            bits_ = 0;
+            count_ = 0;
+        }
+
+        return written;
+    }
+
+private:
+    const char* position_{nullptr};
+    const char* end_{nullptr};
+    uint32_t bits_{0};
+    std::size_t count_{0};
+    bool padded_{false};
+    bool error_{false};
+
+    static int32_t decode(const char c)
+    {
+        if (('A' <= c) && ('Z' >= c)) return c - 'A';
+        if (('a' <= c) && ('z' >= c)) return c - 'a' + 26;
+        if (('0' <= c) && ('9' >= c)) return c - '0' + 52;
+        if ('+' == c) return 62;
+        if ('/' == c) return 63;
+
+        return -1;
+    }
+};
+
+bool deflate_to(
+    const char* input,
+    const std::size_t size,
+    const int32_t level,
+    Base64Writer& output)
 {
     z_stream zs;  // z_stream is zlib's control structure
     memset(&zs, 0, sizeof(zs));
 
-    if (deflateInit(&zs, compressionlevel) != Z_OK)
-        throw(std::runtime_error("deflateInit failed while compressing."));
+    if (deflateInit(&zs, level) != Z_OK) return false;
 
-    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(str.data()));
-    zs.avail_in = static_cast<uInt>(str.size());  // set the z_stream's input
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+    zs.avail_in = static_cast<uInt>(size);
 
-    int32_t ret;
-    char outbuffer[32768];
-    std::string outstring;
+    int32_t ret = Z_OK;
+    uint8_t buffer[OT_ARMOR_CHUNK_SIZE];
 
-    // retrieve the compressed bytes blockwise
+    // base64-encode each compressed block as soon as zlib produces it
     do {
-        zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
+        zs.next_out = buffer;
+        zs.avail_out = sizeof(buffer);
 
         ret = deflate(&zs, Z_FINISH);
 
-        if (outstring.size() < zs.total_out) {
-            // append the block to the output string
-            outstring.append(outbuffer, zs.total_out - outstring.size());
-        }
+        output.Write(buffer, sizeof(buffer) - zs.avail_out);
     } while (ret == Z_OK);
 
     deflateEnd(&zs);
 
-    if (ret != Z_STREAM_END) {  // an error occurred that was not EOF
-        std::ostringstream oss;
-        oss << "Exception during zlib compression: (" << ret << ") " << zs.msg;
-        throw(std::runtime_error(oss.str()));
+    if (ret != Z_STREAM_END) {
+        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": zlib error (" << ret
+              << ") " << ((nullptr != zs.msg) ? zs.msg : "") << "\n";
+
+        return false;
     }
 
-    return outstring;
+    return true;
 }
 
-/** Decompress an STL string using zlib and return the original data. */
-std::string OTASCIIArmor::decompress_string(const std::string& str) const
+bool inflate_from(
+    Base64Reader& input,
+    uint8_t* block,
+    const std::size_t blockSize,
+    const std::size_t available,
+    std::string& output)
 {
     z_stream zs;  // z_stream is zlib's control structure
     memset(&zs, 0, sizeof(zs));
 
-    if (inflateInit(&zs) != Z_OK)
-        throw(std::runtime_error("inflateInit failed while decompressing."));
+    if (inflateInit(&zs) != Z_OK) return false;
 
-    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(str.data()));
-    zs.avail_in = static_cast<uInt>(str.size());
+    zs.next_in = block;
+    zs.avail_in = static_cast<uInt>(available);
 
-    int32_t ret;
-    char outbuffer[32768];
-    std::string outstring;
-
-    // get the decompressed bytes blockwise using repeated calls to inflate
-    do {
-        zs.next_out = reinterpret_cast<Bytef*>(outbuffer);
-        zs.avail_out = sizeof(outbuffer);
+    int32_t ret = Z_OK;
+    uint8_t buffer[OT_ARMOR_CHUNK_SIZE];
 
-        ret = inflate(&zs, 0);
+    while (ret == Z_OK) {
+        if (0 == zs.avail_in) {
+            zs.next_in = block;
+            zs.avail_in = static_cast<uInt>(input.Read(block, blockSize));
 
-        if (outstring.size() < zs.total_out) {
-            outstring.append(outbuffer, zs.total_out - outstring.size());
+            if (input.Error()) break;
         }
 
-    } while (ret == Z_OK);
+        zs.next_out = buffer;
+        zs.avail_out = sizeof(buffer);
+
+        ret = inflate(&zs, Z_NO_FLUSH);
+
+        output.append(
+            reinterpret_cast<const char*>(buffer),
+            sizeof(buffer) - zs.avail_out);
+    }
 
     inflateEnd(&zs);
 
-    if (ret != Z_STREAM_END) {  // an error occurred that was not EOF
-        std::ostringstream oss;
-        oss << "Exception during zlib decompression: (" << ret << ")";
-        if (zs.msg != nullptr) {
-            oss << " " << zs.msg;
+    if (ret != Z_STREAM_END) {
+        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": zlib error (" << ret
+              << ") " << ((nullptr != zs.msg) ? zs.msg : "") << "\n";
+
+        return false;
+    }
+
+    return true;
+}
+
+#ifdef OT_COMPRESSION_ZSTD
+bool zstd_compress_to(
+    const char* input,
+    const std::size_t size,
+    const int32_t level,
+    Base64Writer& output)
+{
+    ZSTD_CStream* stream = ZSTD_createCStream();
+
+    if (nullptr == stream) return false;
+
+    bool success = !ZSTD_isError(ZSTD_initCStream(stream, level));
+    ZSTD_inBuffer in{input, size, 0};
+    uint8_t buffer[OT_ARMOR_CHUNK_SIZE];
+
+    if (success) { output.Write(&OT_ARMOR_TAG_ZSTD, 1); }
+
+    while (success && (in.pos < in.size)) {
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        success = !ZSTD_isError(ZSTD_compressStream(stream, &out, &in));
+        output.Write(buffer, out.pos);
+    }
+
+    std::size_t remaining = 1;
+
+    while (success && (0 < remaining)) {
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        remaining = ZSTD_endStream(stream, &out);
+        success = !ZSTD_isError(remaining);
+        output.Write(buffer, out.pos);
+    }
+
+    ZSTD_freeCStream(stream);
+
+    if (!success) {
+        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": zstd error\n";
+    }
+
+    return success;
+}
+
+bool zstd_decompress_from(
+    Base64Reader& input,
+    uint8_t* block,
+    const std::size_t blockSize,
+    const std::size_t available,
+    std::string& output)
+{
+    ZSTD_DStream* stream = ZSTD_createDStream();
+
+    if (nullptr == stream) return false;
+
+    std::size_t ret = ZSTD_initDStream(stream);
+    // skip the codec tag
+    ZSTD_inBuffer in{block + 1, available - 1, 0};
+    uint8_t buffer[OT_ARMOR_CHUNK_SIZE];
+    bool pending = false;
+
+    while (!ZSTD_isError(ret)) {
+        if ((in.pos == in.size) && !pending) {
+            in.src = block;
+            in.size = input.Read(block, blockSize);
+            in.pos = 0;
+
+            if (input.Error() || (0 == in.size)) {
+                ret = 1;
+
+                break;
+            }
+        }
+
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        ret = ZSTD_decompressStream(stream, &out, &in);
+
+        if (ZSTD_isError(ret)) break;
+
+        output.append(reinterpret_cast<const char*>(buffer), out.pos);
+        pending = (out.pos == out.size);
+
+        // the frame is complete and fully flushed
+        if (0 == ret) break;
+    }
+
+    ZSTD_freeDStream(stream);
+
+    if (0 != ret) {
+        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": zstd error\n";
+
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+// The codec and level are kept in one word so that they always change
+// together.
+uint64_t pack_compression(const ArmorCompression codec, const int32_t level)
+{
+    return (static_cast<uint64_t>(codec) << 32) |
+           static_cast<uint32_t>(level);
+}
+
+ArmorCompression unpack_codec(const uint64_t compression)
+{
+    return static_cast<ArmorCompression>(compression >> 32);
+}
+
+int32_t unpack_level(const uint64_t compression)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(compression));
+}
+}  // namespace
+
+std::atomic<uint64_t> OTASCIIArmor::compression_{
+    pack_compression(ArmorCompression::ZLIB, Z_BEST_COMPRESSION)};
+
+// static
+bool OTASCIIArmor::SetCompression(
+    const ArmorCompression codec,
+    const int32_t level)
+{
+    switch (codec) {
+        case ArmorCompression::ZLIB: {
+            if ((Z_DEFAULT_COMPRESSION > level) ||
+                (Z_BEST_COMPRESSION < level)) {
+                return false;
+            }
+        } break;
+        case ArmorCompression::ZSTD: {
+#ifdef OT_COMPRESSION_ZSTD
+            if ((1 > level) || (ZSTD_maxCLevel() < level)) { return false; }
+#else
+            return false;
+#endif
+        } break;
+        default: {
+            return false;
         }
-        throw(std::runtime_error(oss.str()));
     }
 
-    return outstring;
+    compression_.store(pack_compression(codec, level));
+
+    return true;
+}
+
+// static
+ArmorCompression OTASCIIArmor::Compression()
+{
+    return unpack_codec(compression_.load());
+}
+
+// static
+int32_t OTASCIIArmor::CompressionLevel()
+{
+    return unpack_level(compression_.load());
 }
 
+
 // Base64-decode
 bool OTASCIIArmor::GetData(
     OTData& theData,
@@ -336,10 +684,9 @@ bool OTASCIIArmor::SetData(const OTData& theData, bool bLineBreaks)
     return true;
 }
 
-// Base64-decode an decompress
-bool OTASCIIArmor::GetString(
-    String& strData,
-    bool bLineBreaks) const  // bLineBreaks=true
+// Base64-decode an decompress. The decoder skips line breaks wherever they
+// appear, so bLineBreaks is not needed to read either form.
+bool OTASCIIArmor::GetString(String& strData, bool) const
 {
     strData.Release();
 
@@ -347,23 +694,32 @@ bool OTASCIIArmor::GetString(
         return true;
     }
 
-    size_t outSize = 0;
-    uint8_t* pData =
-        App::Me().Crypto().Util().Base64Decode(Get(), &outSize, bLineBreaks);
+    Base64Reader reader(Get(), GetLength());
+    uint8_t block[OT_ARMOR_CHUNK_SIZE];
+    const std::size_t available = reader.Read(block, sizeof(block));
 
-    if (!pData) {
+    if (reader.Error() || (0 == available)) {
         otErr << __FUNCTION__ << "Base64Decode fail\n";
         return false;
     }
 
-    std::string str_decoded(pData, pData + outSize);
-
-    delete[] pData;
-
     std::string str_uncompressed;
-    try {
-        str_uncompressed = decompress_string(str_decoded);
-    } catch (const std::runtime_error&) {
+    bool decompressed = false;
+
+    if (OT_ARMOR_TAG_ZSTD == block[0]) {
+#ifdef OT_COMPRESSION_ZSTD
+        decompressed = zstd_decompress_from(
+            reader, block, sizeof(block), available, str_uncompressed);
+#else
+        otErr << __FUNCTION__
+              << ": zstd armor is not supported by this build\n";
+#endif
+    } else {
+        decompressed = inflate_from(
+            reader, block, sizeof(block), available, str_uncompressed);
+    }
+
+    if (!decompressed) {
         otErr << __FUNCTION__ << ": decompress failed\n";
         return false;
     }
@@ -380,27 +736,33 @@ bool OTASCIIArmor::SetString(const String& strData, bool bLineBreaks)  //=true
 
     if (strData.GetLength() < 1) return true;
 
-    std::string stdstring = std::string(strData.Get());
-    std::string str_compressed = compress_string(stdstring);
-
-    // "Success"
-    if (str_compressed.size() == 0) {
-        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": compression fail 0.\n";
-        return false;
+    std::string str_armored;
+    Base64Writer writer(str_armored, bLineBreaks);
+    const uint64_t compression = compression_.load();
+    const int32_t level = unpack_level(compression);
+    bool compressed = false;
+
+    switch (unpack_codec(compression)) {
+#ifdef OT_COMPRESSION_ZSTD
+        case ArmorCompression::ZSTD: {
+            compressed = zstd_compress_to(
+                strData.Get(), strData.GetLength(), level, writer);
+        } break;
+#endif
+        default: {
+            compressed =
+                deflate_to(strData.Get(), strData.GetLength(), level, writer);
+        }
     }
 
-    char* pString = App::Me().Crypto().Util().Base64Encode(
-        reinterpret_cast<const uint8_t*>((str_compressed.data())),
-        static_cast<int32_t>(str_compressed.size()),
-        bLineBreaks);
-
-    if (!pString) {
-        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": Base64Encode fail.\n";
+    if (!compressed) {
+        otErr << "OTASCIIArmor::" << __FUNCTION__ << ": compression fail.\n";
         return false;
     }
 
-    Set(pString);
-    delete[] pString;
+    writer.Finish();
+    Set(str_armored.c_str());
+
     return true;
 }
 
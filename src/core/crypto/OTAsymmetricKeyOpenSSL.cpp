@@ -62,6 +62,7 @@
 #include <sodium/crypto_box.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <mutex>
 #include <ostream>
 #include <string>
 
@@ -256,6 +257,8 @@ void OTAsymmetricKey_OpenSSL::ReleaseKeyLowLevel_Hook() const
 {
     // Release the instantiated OpenSSL key (unsafe to store in this form.)
     //
+    std::lock_guard<std::recursive_mutex> lock(dp->m_lock);
+
     if (nullptr != dp->m_pKey) EVP_PKEY_free(dp->m_pKey);
     dp->m_pKey = nullptr;
 }
@@ -708,6 +711,8 @@ bool OTAsymmetricKey_OpenSSL::GetPrivateKey(
         return false;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(dp->m_lock);
+
     EVP_PKEY* pPrivateKey = dp->GetKeyLowLevel();
     if (nullptr == pPrivateKey) {
         otErr
@@ -45,6 +45,7 @@
 #include "opentxs/core/crypto/OTAsymmetricKeyOpenSSL.hpp"
 #include "opentxs/core/crypto/OTPassword.hpp"
 #include "opentxs/core/crypto/OTPasswordData.hpp"
+#include "opentxs/core/crypto/PrivateKeyCache.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/Timer.hpp"
 
@@ -59,7 +60,9 @@
 #include <openssl/x509.h>
 #include <opentxs/core/util/stacktrace.h>
 #include <stdint.h>
+#include <mutex>
 #include <ostream>
+#include <vector>
 
 // BIO_get_mem_data() macro from OpenSSL uses old style cast
 #ifndef _WIN32
@@ -160,6 +163,8 @@ const EVP_PKEY* OTAsymmetricKey_OpenSSL::OTAsymmetricKey_OpenSSLPrivdp::GetKey(
         return nullptr;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(m_lock);
+
     if (backlink->m_timer.getElapsedTimeInSec() > OT_KEY_TIMER)
         backlink->ReleaseKeyLowLevel(); // This releases the actual loaded key,
                                         // but not the ascii-armored, encrypted
@@ -608,9 +613,36 @@ EVP_PKEY* OTAsymmetricKey_OpenSSL::OTAsymmetricKey_OpenSSLPrivdp::
 
         if (nullptr == pPWData) pPWData = &thePWData;
 
-        pReturnKey = PEM_read_bio_PrivateKey(
-            keyBio, nullptr, OTAsymmetricKey::GetPasswordCallback(),
-            const_cast<OTPasswordData*>(pPWData));
+        // If this key was decrypted recently, the DER encoding of its
+        // plaintext is still cached and the password callback is skipped.
+        //
+        OTData theCachedKey;
+
+        if (PrivateKeyCache::It().Get(theData, theCachedKey)) {
+            const unsigned char* pDER =
+                static_cast<const unsigned char*>(theCachedKey.GetPointer());
+            pReturnKey = d2i_AutoPrivateKey(nullptr, &pDER,
+                                            theCachedKey.GetSize());
+        }
+
+        if (nullptr == pReturnKey) {
+            pReturnKey = PEM_read_bio_PrivateKey(
+                keyBio, nullptr, OTAsymmetricKey::GetPasswordCallback(),
+                const_cast<OTPasswordData*>(pPWData));
+
+            if (nullptr != pReturnKey) {
+                const int32_t nDERSize = i2d_PrivateKey(pReturnKey, nullptr);
+
+                if (0 < nDERSize) {
+                    std::vector<unsigned char> theDER(nDERSize);
+                    unsigned char* pDER = &theDER[0];
+                    i2d_PrivateKey(pReturnKey, &pDER);
+                    theCachedKey.Assign(&theDER[0], nDERSize);
+                    OTPassword::zeroMemory(&theDER[0], nDERSize);
+                    PrivateKeyCache::It().Insert(theData, theCachedKey);
+                }
+            }
+        }
 
         // Free the BIO and related buffers, filters, etc.
         backlink->ReleaseKeyLowLevel();
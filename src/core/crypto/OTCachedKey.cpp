@@ -50,6 +50,7 @@
 #include "opentxs/core/crypto/OTPassword.hpp"
 #include "opentxs/core/crypto/OTPasswordData.hpp"
 #include "opentxs/core/crypto/OTSymmetricKey.hpp"
+#include "opentxs/core/crypto/PrivateKeyCache.hpp"
 #include "opentxs/core/util/Assert.hpp"
 
 #if defined(OT_CRYPTO_USING_OPENSSL)
@@ -246,6 +247,8 @@ void OTCachedKey::Cleanup()
 
     s_mapCachedKeys.clear();
 
+    PrivateKeyCache::It().Clear();
+
     //    while (!s_mapCachedKeys.empty())
     //    {
     //        OTCachedKey * pTemp = s_mapCachedKeys.begin()->second;
@@ -1225,6 +1228,9 @@ void OTCachedKey::DestroyMasterPassword()
             delete pPassword;
             pPassword = nullptr;
         }
+
+        // Decrypted signing keys must not outlive the master password.
+        PrivateKeyCache::It().Clear();
     }
     // (We do NOT call LowLevelReleaseThread(); here, since the thread is
     // what CALLED this function. Instead, we destroy / nullptr the master
@@ -1281,6 +1287,8 @@ void OTCachedKey::ResetMasterPassword()
         pPassword = nullptr;
     }
 
+    PrivateKeyCache::It().Clear();
+
     if (nullptr != m_pSymmetricKey) {
         // We also remove it from the system keychain:
         //
@@ -90,10 +90,15 @@ extern "C" {
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifdef __APPLE__
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -381,91 +386,6 @@ void ot_openssl_locking_callback(int32_t mode, int32_t type, const char*,
 }
 } // extern "C"
 
-// Caller responsible to delete.
-char* OpenSSL::Base64Encode(const uint8_t* input, int32_t in_len,
-                                     bool bLineBreaks) const
-{
-    char* buf = nullptr;
-    BUF_MEM* bptr = nullptr;
-
-    OT_ASSERT_MSG(in_len >= 0,
-                  "OT_base64_encode: Abort: in_len is a negative number!");
-
-    OpenSSL_BIO b64 = BIO_new(BIO_f_base64());
-
-    if (!b64) return buf;
-
-    if (!bLineBreaks) BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-
-    OpenSSL_BIO bmem = BIO_new(BIO_s_mem());
-
-    if (bmem) {
-        OpenSSL_BIO b64join = BIO_push(b64, bmem);
-        b64.release();
-        bmem.release();
-
-        if (BIO_write(b64join, input, in_len) == in_len) {
-            (void)BIO_flush(b64join);
-#ifndef _WIN32
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-#endif
-            BIO_get_mem_ptr(b64join, &bptr);
-#ifndef _WIN32
-#pragma GCC diagnostic pop
-#endif
-            //    otLog5 << "DEBUG base64_encode size: %" PRId64 ",  in_len:
-            // %" PRId64 "\n", bptr->length+1, in_len);
-            buf = new char[bptr->length + 1];
-            OT_ASSERT(nullptr != buf);
-            memcpy(buf, bptr->data, bptr->length); // Safe.
-            buf[bptr->length] = '\0';              // Forcing null terminator.
-        }
-    }
-    else {
-        OT_FAIL_MSG("Failed creating new Bio in base64_encode.\n");
-    }
-
-    return buf;
-}
-
-// Caller responsible to delete.
-uint8_t* OpenSSL::Base64Decode(const char* input, size_t* out_len,
-                                        bool bLineBreaks) const
-{
-
-    OT_ASSERT(nullptr != input);
-
-    int32_t in_len =
-        static_cast<int32_t>(strlen(input)); // todo security (strlen)
-    int32_t out_max_len = (in_len * 6 + 7) / 8;
-    uint8_t* buf = new uint8_t[out_max_len];
-    OT_ASSERT(nullptr != buf);
-    memset(buf, 0, out_max_len); // todo security
-
-    OpenSSL_BIO b64 = BIO_new(BIO_f_base64());
-
-    if (b64) {
-        if (!bLineBreaks) BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-
-        OpenSSL_BIO bmem = BIO_new_mem_buf(const_cast<char*>(input), in_len);
-        OT_ASSERT(nullptr != bmem);
-
-        OpenSSL_BIO b64join = BIO_push(b64, bmem);
-        b64.release();
-        bmem.release();
-        OT_ASSERT(nullptr != b64join);
-
-        *out_len = BIO_read(b64join, buf, out_max_len);
-
-    }
-    else {
-        OT_FAIL_MSG("Failed creating new Bio in base64_decode.\n");
-    }
-
-    return buf;
-}
-
 // Decode formatted OT ID to the binary hash ID.
 void OpenSSL::SetIDFromEncoded(const String& strInput,
                                      Identifier& theOutput) const
@@ -1829,6 +1749,29 @@ bool OpenSSL::EncryptSessionKey(
     uint8_t** ek = nullptr;   // These we DO need to cleanup...
     int32_t* eklen = nullptr; // This will just be an array of integers.
 
+    // GetKey re-instantiates a public key whenever its timer has run out, so
+    // a key sealed to from another thread (cron workers, the notary's
+    // request workers) could be freed while this envelope still uses it.
+    // Every recipient key is held until the envelope is sealed, in address
+    // order so that two seals to overlapping recipients can't deadlock.
+    std::vector<OTAsymmetricKey_OpenSSL*> recipientKeys;
+
+    for (auto& it : RecipPubKeys) {
+        auto* pKey = dynamic_cast<OTAsymmetricKey_OpenSSL*>(it.second);
+
+        if (nullptr != pKey) { recipientKeys.push_back(pKey); }
+    }
+
+    std::sort(recipientKeys.begin(), recipientKeys.end());
+    recipientKeys.erase(
+        std::unique(recipientKeys.begin(), recipientKeys.end()),
+        recipientKeys.end());
+    std::vector<std::unique_lock<std::recursive_mutex>> keyLocks;
+
+    for (auto* pKey : recipientKeys) {
+        keyLocks.emplace_back(pKey->dp->m_lock);
+    }
+
     bool bFinalized = false; // If this is set true, then we don't bother to
                              // cleanup the ctx. (See the destructor below.)
 
@@ -2369,8 +2312,13 @@ bool OpenSSL::DecryptSessionKey(OTData& dataInput, const Nym& theRecipient,
     OTAsymmetricKey_OpenSSL* pPrivateKey =
         dynamic_cast<OTAsymmetricKey_OpenSSL*>(&theTempPrivateKey);
 
+    // Held until the session key is decrypted, so the key can't time out
+    // and be freed by another thread in the meantime.
+    std::unique_lock<std::recursive_mutex> keyLock;
     EVP_PKEY* private_key = nullptr;
     if (nullptr != pPrivateKey) {
+        keyLock =
+            std::unique_lock<std::recursive_mutex>(pPrivateKey->dp->m_lock);
         private_key =
             const_cast<EVP_PKEY*>(pPrivateKey->dp->GetKey(pPWData));
     }
@@ -2859,118 +2807,159 @@ bool OpenSSL::DecryptSessionKey(OTData& dataInput, const Nym& theRecipient,
     return bFinalized;
 }
 
-bool OpenSSL::Digest(
-    const CryptoHash::HashType hashType,
-    const OTPassword& data,
-    OTPassword& digest) const
+namespace
+{
 
+// An EVP digest context. HASH256 and HASH160 run a second digest (outer_)
+// over the first one's output.
+class OpenSSLHasher : public CryptoHash::Hasher
 {
-    const uint8_t* inputStart;
-    uint32_t inputSize;
+public:
+    OpenSSLHasher(const EVP_MD* algorithm, const EVP_MD* outer)
+        : context_(EVP_MD_CTX_create())
+        , outer_(outer)
+        , ready_(
+              (nullptr != context_) &&
+              (1 == EVP_DigestInit_ex(context_, algorithm, nullptr)))
+    {
+    }
 
-    if (data.isMemory()) {
-        inputStart = data.getMemory_uint8();
-        inputSize = data.getMemorySize();
-    } else {
-        inputStart = data.getPassword_uint8();
-        inputSize = data.getPasswordSize();
+    bool Ready() const { return ready_; }
+
+    bool Update(const void* input, std::size_t size) override
+    {
+        if (!ready_) return false;
+
+        ready_ = (1 == EVP_DigestUpdate(context_, input, size));
+
+        return ready_;
     }
 
-    if (CryptoHash::HASH256 == hashType) {
+    bool Final(std::uint8_t* output, std::size_t& size) override
+    {
+        size = 0;
 
-        unsigned char* vDigest = ::Hash(inputStart, inputStart+inputSize);
+        if (!ready_) return false;
 
-        if (nullptr != vDigest) {
-            digest.setMemory(vDigest, 32);
-            delete[] vDigest;
-            vDigest = nullptr;
-            return true;
-        } else {
-            otErr << __FUNCTION__ << ": Hashing failed.\n";
+        ready_ = false;
+        unsigned int length = 0;
+
+        if (1 != EVP_DigestFinal_ex(context_, output, &length)) return false;
+
+        if ((nullptr != outer_) &&
+            ((1 != EVP_DigestInit_ex(context_, outer_, nullptr)) ||
+             (1 != EVP_DigestUpdate(context_, output, length)) ||
+             (1 != EVP_DigestFinal_ex(context_, output, &length)))) {
             return false;
         }
 
+        size = length;
+
         return true;
-    } else if (CryptoHash::HASH160 == hashType) {
+    }
 
-        unsigned char* vDigest = ::Hash160(inputStart, inputStart+inputSize);
+    ~OpenSSLHasher()
+    {
+        if (nullptr != context_) EVP_MD_CTX_destroy(context_);
+    }
 
-        if (nullptr != vDigest) {
-            digest.setMemory(vDigest, 20);
-            delete[] vDigest;
-            vDigest = nullptr;
-            return true;
-        } else {
-            otErr << __FUNCTION__ << ": Hashing failed.\n";
-            return false;
-        }
-    } else {
-        EVP_MD_CTX* context = EVP_MD_CTX_create();
-        const EVP_MD* algorithm = dp->HashTypeToOpenSSLType(hashType);
-        unsigned char hash_value[EVP_MAX_MD_SIZE]{};
-        unsigned int hash_length = 0;
+private:
+    OpenSSLHasher(const OpenSSLHasher&) = delete;
+    OpenSSLHasher& operator=(const OpenSSLHasher&) = delete;
 
-        if (nullptr != algorithm) {
-            EVP_DigestInit_ex(context, algorithm, NULL);
-            EVP_DigestUpdate(context, inputStart, inputSize);
-            EVP_DigestFinal_ex(context, hash_value, &hash_length);
-            EVP_MD_CTX_destroy(context);
+    EVP_MD_CTX* context_;
+    const EVP_MD* outer_;
+    bool ready_;
+};
 
-            digest.setMemory(hash_value, hash_length);
+}  // namespace
 
-            return true;
-        } else {
-            otErr << __FUNCTION__ << ": Error: invalid hash type.\n";
-            return false;
-        }
+std::unique_ptr<CryptoHash::Hasher> OpenSSL::Init(
+    const CryptoHash::HashType hashType) const
+{
+    const EVP_MD* algorithm = nullptr;
+    const EVP_MD* outer = nullptr;
+
+    switch (hashType) {
+        case CryptoHash::HASH256:
+            algorithm = EVP_sha256();
+            outer = EVP_sha256();
+            break;
+        case CryptoHash::HASH160:
+            algorithm = EVP_sha256();
+            outer = EVP_ripemd160();
+            break;
+        default:
+            algorithm = dp->HashTypeToOpenSSLType(hashType);
+    }
+
+    if (nullptr == algorithm) {
+        otErr << __FUNCTION__ << ": Error: invalid hash type.\n";
+        return nullptr;
     }
+
+    std::unique_ptr<OpenSSLHasher> hasher(new OpenSSLHasher(algorithm, outer));
+
+    if (!hasher->Ready()) {
+        otErr << __FUNCTION__ << ": Failed to initialize digest.\n";
+        return nullptr;
+    }
+
+    return std::unique_ptr<CryptoHash::Hasher>(hasher.release());
 }
 
 bool OpenSSL::Digest(
     const CryptoHash::HashType hashType,
-    const OTData& data,
-    OTData& digest) const
+    const OTPassword& data,
+    OTPassword& digest) const
 
 {
-    const uint8_t* inputStart = static_cast<const uint8_t*>(data.GetPointer());
-    uint32_t inputSize = data.GetSize();
+    const uint8_t* inputStart;
+    uint32_t inputSize;
 
-    if (CryptoHash::HASH256 == hashType) {
+    if (data.isMemory()) {
+        inputStart = data.getMemory_uint8();
+        inputSize = data.getMemorySize();
+    } else {
+        inputStart = data.getPassword_uint8();
+        inputSize = data.getPasswordSize();
+    }
 
-        unsigned char* vDigest = ::Hash(inputStart, inputStart+inputSize);
-        digest.Assign(vDigest, 32);
-        delete[] vDigest;
-        vDigest = nullptr;
+    uint8_t output[CryptoHash::MaxDigestSize];
+    std::size_t size = 0;
+    const bool hashed =
+        CryptoHash::Digest(hashType, inputStart, inputSize, output, size);
 
-        return true;
-    } else if (CryptoHash::HASH160 == hashType) {
+    if (hashed) {
+        digest.setMemory(output, static_cast<uint32_t>(size));
+    } else {
+        otErr << __FUNCTION__ << ": Hashing failed.\n";
+    }
 
-        unsigned char* vDigest = ::Hash160(inputStart, inputStart+inputSize);
-        digest.Assign(vDigest, 20);
-        delete[] vDigest;
-        vDigest = nullptr;
+    // The digest of a secret is as sensitive as the secret.
+    OPENSSL_cleanse(output, sizeof(output));
 
-        return true;
-    } else {
-        EVP_MD_CTX* context = EVP_MD_CTX_create();
-        const EVP_MD* algorithm = dp->HashTypeToOpenSSLType(hashType);
-        unsigned char hash_value[EVP_MAX_MD_SIZE]{};
-        unsigned int hash_length = 0;
+    return hashed;
+}
 
-        if (nullptr != algorithm) {
-            EVP_DigestInit_ex(context, algorithm, NULL);
-            EVP_DigestUpdate(context, inputStart, inputSize);
-            EVP_DigestFinal_ex(context, hash_value, &hash_length);
-            EVP_MD_CTX_destroy(context);
+bool OpenSSL::Digest(
+    const CryptoHash::HashType hashType,
+    const OTData& data,
+    OTData& digest) const
 
-            digest.Assign(hash_value, hash_length);
+{
+    uint8_t output[CryptoHash::MaxDigestSize];
+    std::size_t size = 0;
 
-            return true;
-        } else {
-            otErr << __FUNCTION__ << ": Error: invalid hash type.\n";
-            return false;
-        }
+    if (!CryptoHash::Digest(
+            hashType, data.GetPointer(), data.GetSize(), output, size)) {
+        otErr << __FUNCTION__ << ": Hashing failed.\n";
+        return false;
     }
+
+    digest.Assign(output, static_cast<uint32_t>(size));
+
+    return true;
 }
 
 // Calculate an HMAC given some input data and a key
@@ -3803,6 +3792,10 @@ bool OpenSSL::Sign(
         dynamic_cast<OTAsymmetricKey_OpenSSL*>(&theTempKey);
     OT_ASSERT(nullptr != pTempOpenSSLKey);
 
+    // The server Nym signs from many threads at once. Keep the key from
+    // being released and re-instantiated while it is in use.
+    std::lock_guard<std::recursive_mutex> lock(pTempOpenSSLKey->dp->m_lock);
+
     const EVP_PKEY* pkey = pTempOpenSSLKey->dp->GetKey(pPWData);
     OT_ASSERT(nullptr != pkey);
 
@@ -3829,6 +3822,8 @@ bool OpenSSL::Verify(
         dynamic_cast<OTAsymmetricKey_OpenSSL*>(&theTempKey);
     OT_ASSERT(nullptr != pTempOpenSSLKey);
 
+    std::lock_guard<std::recursive_mutex> lock(pTempOpenSSLKey->dp->m_lock);
+
     const EVP_PKEY* pkey = pTempOpenSSLKey->dp->GetKey(pPWData);
     OT_ASSERT(nullptr != pkey);
 
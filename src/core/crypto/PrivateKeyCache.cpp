@@ -0,0 +1,178 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/core/crypto/PrivateKeyCache.hpp"
+
+#include "opentxs/core/OTData.hpp"
+#include "opentxs/core/crypto/OTCachedKey.hpp"
+#include "opentxs/core/crypto/OTPassword.hpp"
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+PrivateKeyCache& PrivateKeyCache::It()
+{
+    static PrivateKeyCache instance;
+
+    return instance;
+}
+
+std::string PrivateKeyCache::Index(const OTData& encryptedKey)
+{
+    return std::string(static_cast<const char*>(encryptedKey.GetPointer()),
+                       encryptedKey.GetSize());
+}
+
+void PrivateKeyCache::Erase(std::map<std::string, Entry>::iterator it)
+{
+    // Destroying the OTData zeroes its memory.
+    lru_.erase(it->second.position_);
+    entries_.erase(it);
+}
+
+bool PrivateKeyCache::Get(const OTData& encryptedKey, OTData& output)
+{
+    if (0 == encryptedKey.GetSize()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(lock_);
+
+    auto it = entries_.find(Index(encryptedKey));
+
+    if (entries_.end() == it) {
+        return false;
+    }
+
+    Entry& entry = it->second;
+
+    if (!entry.forever_ && (Clock::now() >= entry.expires_)) {
+        Erase(it);
+
+        return false;
+    }
+
+    lru_.splice(lru_.begin(), lru_, entry.position_);
+    output.Assign(entry.key_);
+
+    return !output.IsEmpty();
+}
+
+bool PrivateKeyCache::Get(const OTData& encryptedKey, OTPassword& output)
+{
+    OTData plaintext;
+
+    if (!Get(encryptedKey, plaintext)) {
+        return false;
+    }
+
+    // setMemory() would silently truncate a plaintext this large.
+    if (plaintext.GetSize() > output.getBlockSize()) {
+        return false;
+    }
+
+    return (0 < output.setMemory(plaintext.GetPointer(),
+                                 plaintext.GetSize()));
+}
+
+void PrivateKeyCache::Insert(
+    const OTData& encryptedKey,
+    const OTPassword& decryptedKey)
+{
+    if (!decryptedKey.isMemory()) {
+        return;
+    }
+
+    Insert(encryptedKey,
+           OTData(decryptedKey.getMemory(), decryptedKey.getMemorySize()));
+}
+
+void PrivateKeyCache::Insert(
+    const OTData& encryptedKey,
+    const OTData& decryptedKey)
+{
+    if ((0 == encryptedKey.GetSize()) || decryptedKey.IsEmpty()) {
+        return;
+    }
+
+    // Read the timeout before taking our own lock: OTCachedKey calls Clear()
+    // while holding its mutex.
+    const int32_t timeout = OTCachedKey::It()->GetTimeoutSeconds();
+
+    if (0 == timeout) {
+        return;
+    }
+
+    const std::string index = Index(encryptedKey);
+
+    std::lock_guard<std::mutex> lock(lock_);
+
+    auto it = entries_.find(index);
+
+    if (entries_.end() != it) {
+        Erase(it);
+    }
+
+    while (MAX_ENTRIES <= entries_.size()) {
+        Erase(entries_.find(lru_.back()));
+    }
+
+    lru_.push_front(index);
+    Entry& entry = entries_[index];
+    entry.key_.Assign(decryptedKey);
+    entry.forever_ = (0 > timeout);
+    entry.expires_ = Clock::now() + std::chrono::seconds(timeout);
+    entry.position_ = lru_.begin();
+}
+
+void PrivateKeyCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    entries_.clear();
+    lru_.clear();
+}
+
+PrivateKeyCache::~PrivateKeyCache() { Clear(); }
+} // namespace opentxs
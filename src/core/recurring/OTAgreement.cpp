@@ -963,6 +963,21 @@ bool OTAgreement::ProcessCron()
     return true;
 }
 
+// Payments only move funds between the two parties' accounts.
+bool OTAgreement::GetCronResources(std::set<std::string>& output) const
+{
+    const String strSenderAcct(GetSenderAcctID()),
+        strSenderNym(GetSenderNymID()), strRecipientAcct(GetRecipientAcctID()),
+        strRecipientNym(GetRecipientNymID());
+
+    output.insert(strSenderAcct.Get());
+    output.insert(strSenderNym.Get());
+    output.insert(strRecipientAcct.Get());
+    output.insert(strRecipientNym.Get());
+
+    return true;
+}
+
 /// See if theNym has rights to remove this item from Cron.
 ///
 bool OTAgreement::CanRemoveItemFromCron(Nym& theNym)
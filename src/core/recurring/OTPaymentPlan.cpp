@@ -60,6 +60,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -1515,6 +1516,69 @@ bool OTPaymentPlan::ProcessCron()
     return true;
 }
 
+// Mirrors the checks in ProcessCron(): the plan sleeps until the earliest of
+// its start date, its expiry, and the next initial or regular payment that
+// could go through. It is still visited at least once a day.
+time64_t OTPaymentPlan::GetNextWakeTime() const
+{
+    const time64_t tNext = ot_super::GetNextWakeTime();
+    const time64_t tLast = GetLastProcessDate();
+
+    if (IsFlaggedForRemoval() || (OT_TIME_ZERO == tLast)) return tNext;
+
+    const int64_t lDay = OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS);
+    time64_t tWake = OTTimeAddTimeInterval(tLast, lDay);
+
+    if (GetValidTo() > OT_TIME_ZERO) tWake = std::min(tWake, GetValidTo());
+
+    if (GetValidFrom() > tLast) tWake = std::min(tWake, GetValidFrom());
+
+    if (HasInitialPayment() && !IsInitialPaymentDone()) {
+        time64_t tInitial = OTTimeAddTimeInterval(GetInitialPaymentDate(), 1);
+
+        if (OT_TIME_ZERO != GetLastFailedInitialPaymentDate())
+            tInitial = std::max(
+                tInitial, OTTimeAddTimeInterval(
+                              GetLastFailedInitialPaymentDate(), lDay + 1));
+
+        tWake = std::min(tWake, tInitial);
+    }
+
+    if (HasPaymentPlan()) {
+        const time64_t tStart = GetPaymentPlanStartDate();
+        const int64_t lBetween =
+            OTTimeGetSecondsFromTime(GetTimeBetweenPayments());
+
+        if (0 >= lBetween) return tNext;
+
+        // Reaching the maximum number of payments removes the plan.
+        if ((GetMaximumNoPayments() > 0) &&
+            (GetNoPaymentsDone() >= GetMaximumNoPayments()))
+            return tNext;
+
+        if (GetPaymentPlanLength() > OT_TIME_ZERO) {
+            const int64_t lLength =
+                OTTimeGetSecondsFromTime(GetPaymentPlanLength());
+            tWake = std::min(tWake, OTTimeAddTimeInterval(tStart, lLength));
+        }
+
+        time64_t tPayment = std::max(
+            OTTimeAddTimeInterval(tStart, 1),
+            OTTimeAddTimeInterval(tStart, GetNoPaymentsDone() * lBetween));
+        tPayment = std::max(
+            tPayment, OTTimeAddTimeInterval(GetDateOfLastPayment(), lBetween));
+
+        if (OT_TIME_ZERO != GetDateOfLastFailedPayment())
+            tPayment = std::max(
+                tPayment,
+                OTTimeAddTimeInterval(GetDateOfLastFailedPayment(), lDay));
+
+        tWake = std::min(tWake, tPayment);
+    }
+
+    return std::max(tWake, tNext);
+}
+
 void OTPaymentPlan::InitPaymentPlan()
 {
     m_strContractType = "PAYMENT PLAN";
@@ -54,12 +54,212 @@
 #endif
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>
+#include <chrono>
 #include <exception>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace opentxs
 {
 
+// Bootstrapping a ChaiScript engine registers the whole standard library, and
+// that used to happen for every clause that ran. Engines are now kept here
+// between runs. The state captured right after construction is restored when
+// an engine is returned, which discards the parties, variables and native
+// calls bound by the previous run.
+class OTScriptChai_Pool
+{
+public:
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> runs_;
+    std::atomic<uint64_t> microseconds_;
+
+    static OTScriptChai_Pool& It()
+    {
+        static OTScriptChai_Pool pool;
+
+        return pool;
+    }
+
+    chaiscript::ChaiScript* Checkout()
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+
+            if (!idle_.empty()) {
+                chaiscript::ChaiScript* output = idle_.back();
+                idle_.pop_back();
+                ++hits_;
+
+                return output;
+            }
+        }
+
+        ++misses_;
+
+#if !defined(OT_USE_CHAI_STDLIB)
+        chaiscript::ChaiScript* output = new chaiscript::ChaiScript();
+#else
+        chaiscript::ChaiScript* output =
+            new chaiscript::ChaiScript(chaiscript::Std_Lib::library());
+#endif
+        Pristine pristine;
+        pristine.state_ = output->get_state();
+        pristine.locals_ = output->get_locals();
+
+        std::lock_guard<std::mutex> lock(lock_);
+        pristine_[output] = pristine;
+
+        return output;
+    }
+
+    void Return(chaiscript::ChaiScript* chai)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        auto it = pristine_.find(chai);
+        OT_ASSERT(pristine_.end() != it);
+
+        if (MAX_IDLE <= idle_.size()) {
+            pristine_.erase(it);
+            delete chai;
+
+            return;
+        }
+
+        chai->set_state(it->second.state_);
+        chai->set_locals(it->second.locals_);
+        idle_.push_back(chai);
+    }
+
+    ~OTScriptChai_Pool()
+    {
+        for (auto& chai : idle_) {
+            delete chai;
+        }
+    }
+
+private:
+    class Pristine
+    {
+    public:
+        chaiscript::ChaiScript::State state_;
+        std::map<std::string, chaiscript::Boxed_Value> locals_;
+    };
+
+    static const size_t MAX_IDLE = 16;
+
+    std::mutex lock_;
+    std::vector<chaiscript::ChaiScript*> idle_;
+    std::map<const chaiscript::ChaiScript*, Pristine> pristine_;
+
+    OTScriptChai_Pool()
+        : hits_(0)
+        , misses_(0)
+        , runs_(0)
+        , microseconds_(0)
+    {
+    }
+};
+
+// Parsed clauses, keyed by their source. Bylaw code cannot change once a smart
+// contract is active, so each clause only needs to be parsed the first time
+// it runs. Every entry records the smart contracts (by transaction number)
+// that use it, and is dropped once all of them have left cron.
+class OTScriptChai_Compiled
+{
+public:
+    static OTScriptChai_Compiled& It()
+    {
+        static OTScriptChai_Compiled compiled;
+
+        return compiled;
+    }
+
+    chaiscript::AST_NodePtr Get(chaiscript::ChaiScript& chai, int64_t lOwner,
+                                const std::string& str_script)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        auto it = scripts_.find(str_script);
+
+        if (scripts_.end() != it) {
+            it->second.owners_.insert(lOwner);
+
+            return it->second.ast_;
+        }
+
+        chaiscript::AST_NodePtr ast = chai.parse(str_script);
+        Entry& entry = scripts_[str_script];
+        entry.ast_ = ast;
+        entry.owners_.insert(lOwner);
+
+        return ast;
+    }
+
+    void Release(int64_t lOwner)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        for (auto it = scripts_.begin(); it != scripts_.end();) {
+            it->second.owners_.erase(lOwner);
+
+            if (it->second.owners_.empty()) {
+                it = scripts_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+private:
+    class Entry
+    {
+    public:
+        chaiscript::AST_NodePtr ast_;
+        std::set<int64_t> owners_;
+    };
+
+    std::mutex lock_;
+    std::map<std::string, Entry> scripts_;
+
+    OTScriptChai_Compiled() = default;
+};
+
+// Records the run time of one ExecuteScript call, whichever way it returns.
+class OTScriptChai_Timer
+{
+public:
+    explicit OTScriptChai_Timer(const std::string& label)
+        : label_(label)
+        , start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~OTScriptChai_Timer()
+    {
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start_).count();
+        OTScriptChai_Pool& pool = OTScriptChai_Pool::It();
+        ++pool.runs_;
+        pool.microseconds_ += elapsed;
+
+        otLog3 << "OTScriptChai::ExecuteScript: " << label_ << " ran in "
+               << elapsed << " microseconds.\n";
+    }
+
+private:
+    const std::string& label_;
+    const std::chrono::steady_clock::time_point start_;
+};
+
 bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
 {
     using namespace chaiscript;
@@ -67,6 +267,7 @@ bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
     OT_ASSERT(nullptr != chai);
 
     if (m_str_script.size() > 0) {
+        OTScriptChai_Timer timer(m_str_display_filename);
 
         /*
         chai->add(user_type<OTParty>(), "OTParty");
@@ -235,35 +436,43 @@ bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
         // "Parties");
 
         try {
-            if (nullptr == pReturnVar) // Nothing to return.
-                chai->eval(m_str_script.c_str(),
-                           exception_specification<const std::exception&>(),
-                           m_str_display_filename);
+            Boxed_Value result;
+
+            if (0 != m_lCompiledOwner) {
+                const AST_NodePtr ast = OTScriptChai_Compiled::It().Get(
+                    *chai, m_lCompiledOwner, m_str_script);
 
-            else // There's a return variable.
+                try {
+                    result = chai->eval(ast);
+                }
+                catch (const Boxed_Value& bv) {
+                    // Evaluating a parsed script wraps errors in a
+                    // Boxed_Value. Unwrap them for the handlers below.
+                    throw boxed_cast<const exception::eval_error&>(bv);
+                }
+            }
+            else {
+                result = chai->eval(
+                    m_str_script.c_str(),
+                    exception_specification<const std::exception&>(),
+                    m_str_display_filename);
+            }
+
+            if (nullptr != pReturnVar) // There's a return variable.
             {
                 switch (pReturnVar->GetType()) {
                 case OTVariable::Var_Integer: {
-                    int32_t nResult = chai->eval<int32_t>(
-                        m_str_script.c_str(),
-                        exception_specification<const std::exception&>(),
-                        m_str_display_filename);
+                    int32_t nResult = boxed_cast<int32_t>(result);
                     pReturnVar->SetValue(nResult);
                 } break;
 
                 case OTVariable::Var_Bool: {
-                    bool bResult = chai->eval<bool>(
-                        m_str_script.c_str(),
-                        exception_specification<const std::exception&>(),
-                        m_str_display_filename);
+                    bool bResult = boxed_cast<bool>(result);
                     pReturnVar->SetValue(bResult);
                 } break;
 
                 case OTVariable::Var_String: {
-                    std::string str_Result = chai->eval<std::string>(
-                        m_str_script.c_str(),
-                        exception_specification<const std::exception&>(),
-                        m_str_display_filename);
+                    std::string str_Result = boxed_cast<std::string>(result);
                     pReturnVar->SetValue(str_Result);
                 } break;
 
@@ -273,7 +482,7 @@ bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
                              "unable to service it.\n";
                     return false;
                 } // switch
-            }     // else return variable.
+            }     // return variable.
         }         // try
         catch (const chaiscript::exception::eval_error& ee) {
             // Error in script parsing / execution
@@ -353,75 +562,58 @@ bool OTScriptChai::ExecuteScript(OTVariable* pReturnVar)
     return true;
 }
 
-#if !defined(OT_USE_CHAI_STDLIB)
-
 OTScriptChai::OTScriptChai()
     : OTScript()
-    , chai(new chaiscript::ChaiScript())
+    , chai(OTScriptChai_Pool::It().Checkout())
 {
 }
 
-OTScriptChai::OTScriptChai(const OTString& strValue)
+OTScriptChai::OTScriptChai(const String& strValue)
     : OTScript(strValue)
-    , chai(new chaiscript::ChaiScript())
+    , chai(OTScriptChai_Pool::It().Checkout())
 {
 }
 
 OTScriptChai::OTScriptChai(const char* new_string)
     : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript())
+    , chai(OTScriptChai_Pool::It().Checkout())
 {
 }
 
 OTScriptChai::OTScriptChai(const char* new_string, size_t sizeLength)
     : OTScript(new_string, sizeLength)
-    , chai(new chaiscript::ChaiScript())
+    , chai(OTScriptChai_Pool::It().Checkout())
 {
 }
 
 OTScriptChai::OTScriptChai(const std::string& new_string)
     : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript())
+    , chai(OTScriptChai_Pool::It().Checkout())
 {
 }
 
-#else
-
-OTScriptChai::OTScriptChai()
-    : OTScript()
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
-{
-}
-
-OTScriptChai::OTScriptChai(const String& strValue)
-    : OTScript(strValue)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+OTScriptChai::~OTScriptChai()
 {
+    if (nullptr != chai) OTScriptChai_Pool::It().Return(chai);
 }
 
-OTScriptChai::OTScriptChai(const char* new_string)
-    : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+void OTScriptChai::ReleaseCompiled(int64_t lOwner)
 {
+    OTScriptChai_Compiled::It().Release(lOwner);
 }
 
-OTScriptChai::OTScriptChai(const char* new_string, size_t sizeLength)
-    : OTScript(new_string, sizeLength)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
-{
-}
+uint64_t OTScriptChai::PoolHits() { return OTScriptChai_Pool::It().hits_; }
 
-OTScriptChai::OTScriptChai(const std::string& new_string)
-    : OTScript(new_string)
-    , chai(new chaiscript::ChaiScript(chaiscript::Std_Lib::library()))
+uint64_t OTScriptChai::PoolMisses()
 {
+    return OTScriptChai_Pool::It().misses_;
 }
 
-#endif // OT_USE_CHAI_STDLIB
+uint64_t OTScriptChai::ScriptRuns() { return OTScriptChai_Pool::It().runs_; }
 
-OTScriptChai::~OTScriptChai()
+uint64_t OTScriptChai::ScriptMicroseconds()
 {
-    if (nullptr != chai) delete chai;
+    return OTScriptChai_Pool::It().microseconds_;
 }
 
 } // namespace opentxs
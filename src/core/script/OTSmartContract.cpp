@@ -534,6 +534,7 @@ various sequence numbers. Hm.
 #endif
 #include <irrxml/irrXML.hpp>
 #include <inttypes.h>
+#include <algorithm>
 #include <memory>
 #include <stdint.h>
 #include <string>
@@ -1028,6 +1029,11 @@ void OTSmartContract::onRemovalFromCron()
 
     otErr << "FYI:  OTSmartContract::onRemovalFromCron was just called. \n";
 
+#ifdef OT_USE_SCRIPT_CHAI
+    // The clauses parsed for this contract are no longer needed.
+    OTScriptChai::ReleaseCompiled(GetTransactionNum());
+#endif
+
     // Trigger a script maybe.
     // OR maybe it's too late for scripts.
     // I give myself an onRemoval() here in C++, but perhaps I cut
@@ -3655,6 +3661,28 @@ bool OTSmartContract::ProcessCron()
     return true;
 }
 
+// If the script has set a timer, nothing happens before it pops, though the
+// contract still has to notice its own expiry and is visited once a day.
+time64_t OTSmartContract::GetNextWakeTime() const
+{
+    const time64_t tNext = ot_super::GetNextWakeTime();
+    const time64_t& tNextProcessDate = GetNextProcessDate();
+
+    if (IsFlaggedForRemoval() || (OT_TIME_ZERO == GetLastProcessDate()) ||
+        (tNextProcessDate <= tNext))
+        return tNext;
+
+    time64_t tWake = std::min(
+        OTTimeAddTimeInterval(tNextProcessDate, 1),
+        OTTimeAddTimeInterval(
+            GetLastProcessDate(),
+            OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS)));
+
+    if (GetValidTo() > OT_TIME_ZERO) tWake = std::min(tWake, GetValidTo());
+
+    return std::max(tWake, tNext);
+}
+
 // virtual
 void OTSmartContract::SetDisplayLabel(const std::string* pstrLabel)
 {
@@ -3772,6 +3800,12 @@ void OTSmartContract::ExecuteClauses(mapOfClauses& theClauses,
 
             pScript->SetDisplayFilename(m_strLabel.Get());
 
+            // While this contract is on cron its bylaws are fixed, so the
+            // interpreter may keep the parsed clause until it is removed.
+            if (nullptr != GetCron()) {
+                pScript->SetCompiledOwner(GetTransactionNum());
+            }
+
             if (!pScript->ExecuteScript()) // If I passed theReturnVal
                                            // in here, then it'd be
                                            // assumed a bool is expected
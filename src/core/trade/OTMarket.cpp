@@ -52,7 +52,10 @@
 #include "opentxs/core/String.hpp"
 #include "opentxs/core/cron/OTCron.hpp"
 #include "opentxs/core/cron/OTCronItem.hpp"
+#include "opentxs/core/crypto/CryptoAsymmetric.hpp"
 #include "opentxs/core/crypto/OTASCIIArmor.hpp"
+#include "opentxs/core/crypto/OTAsymmetricKey.hpp"
+#include "opentxs/core/crypto/OTPasswordData.hpp"
 #include "opentxs/core/trade/OTOffer.hpp"
 #include "opentxs/core/trade/OTTrade.hpp"
 #include "opentxs/core/util/Assert.hpp"
@@ -64,13 +67,18 @@
 #include <inttypes.h>
 #include <irrxml/irrXML.hpp>
 #include <string.h>
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <ostream>
+#include <set>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -96,6 +104,14 @@ int32_t OTMarket::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
         SetScale(String::StringToLong(xml->getAttributeValue("marketScale")));
         m_lLastSalePrice =
             String::StringToLong(xml->getAttributeValue("lastSalePrice"));
+
+        // Markets saved before the journal existed don't have this.
+        const String strJournalSequence(
+            xml->getAttributeValue("journalSequence"));
+        m_lJournalSequence =
+            strJournalSequence.Exists()
+                ? String::StringToLong(strJournalSequence.Get())
+                : 0;
         m_strLastSaleDate = xml->getAttributeValue("lastSaleDate");
 
         const String strNotaryID(xml->getAttributeValue("notaryID")),
@@ -160,6 +176,17 @@ int32_t OTMarket::ProcessXMLNode(irr::io::IrrXMLReader*& xml)
     return nReturnVal;
 }
 
+void OTMarket::save_offer(Tag& parent, const OTOffer& theOffer) const
+{
+    String strOffer(theOffer); // Extract the offer contract into string form.
+    OTASCIIArmor ascOffer(strOffer); // Base64-encode that for storage.
+
+    TagPtr tagOffer(new Tag("offer", ascOffer.Get()));
+    tagOffer->add_attribute("dateAdded",
+                            formatTimestamp(theOffer.GetDateAddedToMarket()));
+    parent.add_tag(tagOffer);
+}
+
 void OTMarket::UpdateContents()
 {
     // I release this because I'm about to repopulate it.
@@ -178,35 +205,20 @@ void OTMarket::UpdateContents()
     tag.add_attribute("marketScale", formatLong(m_lScale));
     tag.add_attribute("lastSaleDate", m_strLastSaleDate);
     tag.add_attribute("lastSalePrice", formatLong(m_lLastSalePrice));
+    tag.add_attribute("journalSequence", formatLong(m_lJournalSequence));
 
-    // Save the offers for sale.
-    for (auto& it : m_mapAsks) {
-        OTOffer* pOffer = it.second;
-        OT_ASSERT(nullptr != pOffer);
-
-        String strOffer(
-            *pOffer); // Extract the offer contract into string form.
-        OTASCIIArmor ascOffer(strOffer); // Base64-encode that for storage.
-
-        TagPtr tagOffer(new Tag("offer", ascOffer.Get()));
-        tagOffer->add_attribute(
-            "dateAdded", formatTimestamp(pOffer->GetDateAddedToMarket()));
-        tag.add_tag(tagOffer);
-    }
-
-    // Save the bids.
-    for (auto& it : m_mapBids) {
-        OTOffer* pOffer = it.second;
-        OT_ASSERT(nullptr != pOffer);
-
-        String strOffer(
-            *pOffer); // Extract the offer contract into string form.
-        OTASCIIArmor ascOffer(strOffer); // Base64-encode that for storage.
+    // Save the offers for sale, and then the bids. Each side is saved in the
+    // order it trades in, so that reloading it keeps everyone's place in line.
+    for (const OTOrderBook* pBook : {&m_Asks, &m_Bids}) {
+        for (auto& pOffer : pBook->MarketOrders()) {
+            save_offer(tag, *pOffer);
+        }
 
-        TagPtr tagOffer(new Tag("offer", ascOffer.Get()));
-        tagOffer->add_attribute(
-            "dateAdded", formatTimestamp(pOffer->GetDateAddedToMarket()));
-        tag.add_tag(tagOffer);
+        for (std::size_t i = 0; i < pBook->LevelCount(); ++i) {
+            for (auto& pOffer : pBook->Level(i).offers_) {
+                save_offer(tag, *pOffer);
+            }
+        }
     }
 
     std::string str_result;
@@ -217,16 +229,7 @@ void OTMarket::UpdateContents()
 
 int64_t OTMarket::GetTotalAvailableAssets()
 {
-    int64_t lTotal = 0;
-
-    for (auto& it : m_mapAsks) {
-        OTOffer* pOffer = it.second;
-        OT_ASSERT(nullptr != pOffer);
-
-        lTotal += pOffer->GetAmountAvailable();
-    }
-
-    return lTotal;
+    return m_Asks.TotalAvailable();
 }
 
 // Get list of offers for a particular Nym, to send that Nym
@@ -331,6 +334,27 @@ bool OTMarket::GetNym_OfferList(const Identifier& NYM_ID,
 }
 
 bool OTMarket::GetRecentTradeList(OTASCIIArmor& ascOutput, int32_t& nTradeCount)
+{
+    CachedList& theCache = m_RecentTradesCache;
+
+    if (theCache.version_ != m_lVersion) {
+        theCache.payload_.Release();
+
+        if (!pack_recent_trade_list(theCache.payload_, theCache.count_)) {
+            return false;
+        }
+
+        theCache.version_ = m_lVersion;
+    }
+
+    nTradeCount = theCache.count_;
+    ascOutput = theCache.payload_;
+
+    return true;
+}
+
+bool OTMarket::pack_recent_trade_list(OTASCIIArmor& ascOutput,
+                                      int32_t& nTradeCount)
 {
     nTradeCount = 0; // Output the count of trades in the list being returned.
                      // (If success..)
@@ -400,13 +424,57 @@ bool OTMarket::GetRecentTradeList(OTASCIIArmor& ascOutput, int32_t& nTradeCount)
 
 // OTDB::OfferListMarket
 //
-bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
-                            int32_t& nOfferCount)
+bool OTMarket::IsOfferListCurrent(int64_t lDepth, const int64_t& lToken) const
 {
-    nOfferCount = 0; // Outputs the actual count of offers being returned.
+    if (0 == lDepth) lDepth = MAX_MARKET_QUERY_DEPTH;
 
+    auto it = m_mapOfferListCache.find(lDepth);
+
+    return (m_mapOfferListCache.end() != it) &&
+           (it->second.version_ == m_lVersion) && (0 != lToken) &&
+           (it->second.token_ == lToken);
+}
+
+bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
+                            int32_t& nOfferCount, int64_t& lToken)
+{
     if (0 == lDepth) lDepth = MAX_MARKET_QUERY_DEPTH;
 
+    // Everything cached is from the same version, so a stale cache is
+    // dropped whole. Only a handful of depths are kept.
+    if (!m_mapOfferListCache.empty() &&
+        ((m_mapOfferListCache.begin()->second.version_ != m_lVersion) ||
+         (m_mapOfferListCache.size() >= 8 &&
+          m_mapOfferListCache.end() == m_mapOfferListCache.find(lDepth)))) {
+        m_mapOfferListCache.clear();
+    }
+
+    auto it = m_mapOfferListCache.find(lDepth);
+
+    if (m_mapOfferListCache.end() == it) {
+        CachedList theCache;
+
+        if (!pack_offer_list(theCache.payload_, lDepth, theCache.count_)) {
+            return false;
+        }
+
+        theCache.version_ = m_lVersion;
+        theCache.token_ = ++m_lNextOfferListToken;
+        it = m_mapOfferListCache.insert(std::make_pair(lDepth, theCache)).first;
+    }
+
+    nOfferCount = it->second.count_;
+    ascOutput = it->second.payload_;
+    lToken = it->second.token_;
+
+    return true;
+}
+
+bool OTMarket::pack_offer_list(OTASCIIArmor& ascOutput, int64_t lDepth,
+                               int32_t& nOfferCount)
+{
+    nOfferCount = 0; // Outputs the actual count of offers being returned.
+
     // Loop through the offers, up to some maximum depth, and then add each
     // as a data member to an offer list, then pack it into ascOutput.
 
@@ -414,24 +482,30 @@ bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
         dynamic_cast<OTDB::OfferListMarket*>(
             OTDB::CreateObject(OTDB::STORED_OBJ_OFFER_LIST_MARKET)));
 
-    //    mapOfOffers            m_mapBids;        // The buyers, ordered by
-    // price limit
-    //    mapOfOffers            m_mapAsks;        // The sellers, ordered by
-    // price limit
-
-    int32_t nTempDepth = 0;
+    // Both sides are read from the best price outwards, and market orders
+    // (which have no price) are skipped, since they are on their own list.
+    // Each side returns lDepth + 1 offers, as it always has, since clients
+    // size their requests around that.
+    auto collect = [lDepth](const OTOrderBook& theBook,
+                            std::vector<OTOffer*>& output) {
+        for (std::size_t i = 0; i < theBook.LevelCount(); ++i) {
+            for (auto& pOffer : theBook.Level(i).offers_) {
+                if (static_cast<int64_t>(output.size()) > lDepth) return;
+
+                output.push_back(pOffer);
+            }
+        }
+    };
 
-    for (auto& it : m_mapBids) {
-        if (nTempDepth++ > lDepth) break;
+    std::vector<OTOffer*> vecBids, vecAsks;
+    collect(m_Bids, vecBids);
+    collect(m_Asks, vecAsks);
 
-        OTOffer* pOffer = it.second;
+    for (auto& pOffer : vecBids) {
         OT_ASSERT(nullptr != pOffer);
 
         const int64_t& lPriceLimit = pOffer->GetPriceLimit();
 
-        if (0 == lPriceLimit) // Skipping any market orders.
-            continue;
-
         // OfferDataMarket
         std::unique_ptr<OTDB::BidData> pOfferData(dynamic_cast<OTDB::BidData*>(
             OTDB::CreateObject(OTDB::STORED_OBJ_BID_DATA)));
@@ -455,12 +529,7 @@ bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
         nOfferCount++;
     }
 
-    nTempDepth = 0;
-
-    for (auto& it : m_mapAsks) {
-        if (nTempDepth++ > lDepth) break;
-
-        OTOffer* pOffer = it.second;
+    for (auto& pOffer : vecAsks) {
         OT_ASSERT(nullptr != pOffer);
 
         // OfferDataMarket
@@ -505,7 +574,7 @@ bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
             pPacker->Pack(*pOfferList)); // Now we PACK our market's offer list.
 
         if (nullptr == pBuffer) {
-            otErr << "Failed packing pOfferList in OTCron::GetOfferList. \n";
+            otErr << "Failed packing pOfferList in OTMarket::GetOfferList. \n";
             return false;
         }
 
@@ -533,18 +602,6 @@ bool OTMarket::GetOfferList(OTASCIIArmor& ascOutput, int64_t lDepth,
     return false;
 }
 
-// To insure that offers of a specific price are always inserted at the upper
-// bound,
-// use this:  my_mmap.insert(my_mmap.upper_bound(key), my_mmap::value_type(key,
-// val));
-// This way I can read them from the lower bound later, and always get them in
-// the
-// order received for that price.
-//
-// typedef std::multimap<int64_t, OTOffer *>    mapOfOffers;
-// mapOfOffers    m_mapBids; // The buyers, ordered
-// mapOfOffers    m_mapAsks; // The sellers, ordered
-
 OTOffer* OTMarket::GetOffer(const int64_t& lTransactionNum)
 {
     // See if there's something there with that transaction number.
@@ -573,6 +630,17 @@ OTOffer* OTMarket::GetOffer(const int64_t& lTransactionNum)
 
 bool OTMarket::RemoveOffer(const int64_t& lTransactionNum) // if false, offer
                                                            // wasn't found.
+{
+    if (!remove_offer(lTransactionNum)) return false;
+
+    m_setChangedOffers.erase(lTransactionNum);
+    m_Journal.Append("remove " + to_string<int64_t>(lTransactionNum));
+    NotifyCron();
+
+    return SaveMarket(); // <====== SAVE since an offer was removed.
+}
+
+bool OTMarket::remove_offer(const int64_t& lTransactionNum)
 {
     bool bReturnValue = false;
 
@@ -596,37 +664,11 @@ bool OTMarket::RemoveOffer(const int64_t& lTransactionNum) // if false, offer
         // But it's still on one of the other lists...
         m_mapOffers.erase(it);
 
-        // The code operates the same whether ask or bid. Just use a pointer.
-        mapOfOffers* pMap = (pOffer->IsBid() ? &m_mapBids : &m_mapAsks);
-
-        // Future solution here: instead of looping through all the offers and
-        // finding it,
-        // I could just have each Offer store a copy of the iterator that's
-        // returned when
-        // it's first inserted. Later I just erase that iterator from the right
-        // list to remove. Todo.
-        OTOffer* pSameOffer = nullptr;
-
-        for (mapOfOffers::iterator iii = pMap->begin(); iii != pMap->end();
-             ++iii) {
-            pSameOffer = iii->second;
-
-            OT_ASSERT_MSG(nullptr != pSameOffer,
-                          "nullptr offer pointer in OTMarket::RemoveOffer.\n");
-
-            // found it!
-            if (lTransactionNum == pSameOffer->GetTransactionNum()) {
-                pMap->erase(iii);
-                break;
-            }
-
-            // Later on, below this loop, this pointer will be nullptr or not,
-            // and
-            // I will know if it was removed.
-            pSameOffer = nullptr;
-        }
+        // The code operates the same whether ask or bid. The book only has
+        // to search the offers at this offer's price.
+        OTOrderBook& theBook = (pOffer->IsBid() ? m_Bids : m_Asks);
 
-        if (nullptr == pSameOffer) {
+        if (!theBook.Remove(*pOffer)) {
             otErr << "Removed Offer from offers list, but not found on bid/ask "
                      "list.\n";
         }
@@ -636,23 +678,11 @@ bool OTMarket::RemoveOffer(const int64_t& lTransactionNum) // if false, offer
             bReturnValue = true; // Success.
         }
 
-        // pOffer was found on the Offers list.
-        // pSameOffer was found on the Bid or Ask list, with the same
-        // transaction ID.
-        // They SHOULD be pointers to the SAME object.
-        // Therefore I CANNOT delete them both.
-        //
-        OT_ASSERT(pOffer == pSameOffer);
-
         delete pOffer;
         pOffer = nullptr;
-        pSameOffer = nullptr;
     }
 
-    if (bReturnValue)
-        return SaveMarket(); // <====== SAVE since an offer was removed.
-    else
-        return false;
+    return bReturnValue;
 }
 
 // This method demands an Offer reference in order to verify that it really
@@ -665,8 +695,7 @@ bool OTMarket::RemoveOffer(const int64_t& lTransactionNum) // if false, offer
 bool OTMarket::AddOffer(OTTrade* pTrade, OTOffer& theOffer, bool bSaveFile,
                         time64_t tDateAddedToMarket)
 {
-    const int64_t lTransactionNum = theOffer.GetTransactionNum(),
-                  lPriceLimit = theOffer.GetPriceLimit();
+    const int64_t lTransactionNum = theOffer.GetTransactionNum();
 
     // Make sure the offer is even appropriate for this market...
     if (!ValidateOfferForMarket(theOffer)) {
@@ -675,9 +704,9 @@ bool OTMarket::AddOffer(OTTrade* pTrade, OTOffer& theOffer, bool bSaveFile,
         if (nullptr != pTrade) pTrade->FlagForRemoval();
     }
     else {
-        // I store duplicate lists of offer pointers. Two multimaps ordered by
-        // price,
-        // (for buyers and sellers) and one map ordered by transaction number.
+        // I store duplicate lists of offer pointers. Two order books ordered
+        // by price, (for buyers and sellers) and one map ordered by
+        // transaction number.
 
         // See if there's something else already there with the same transaction
         // number.
@@ -704,31 +733,26 @@ bool OTMarket::AddOffer(OTTrade* pTrade, OTOffer& theOffer, bool bSaveFile,
         // So next, let's add it to the lists that are indexed by price:
 
         // Determine if it's a buy or sell, and add it to the right list.
+        // No bother checking if the offer is already on this list, since the
+        // code above basically already verifies that for us. (Either way, I
+        // am last in line at my price.)
         if (theOffer.IsBid()) {
-            // No bother checking if the offer is already on this list,
-            // since the code above basically already verifies that for us.
-
-            m_mapBids.insert(
-                m_mapBids.lower_bound(lPriceLimit), // highest bidders go first,
-                                                    // so I am last in line at
-                                                    // lower bound.
-                std::pair<int64_t, OTOffer*>(lPriceLimit, &theOffer));
+            m_Bids.Add(theOffer);
             otLog4 << "Offer added as a bid to the market.\n";
         }
         else {
-            m_mapAsks.insert(
-                m_mapAsks.upper_bound(lPriceLimit), // lowest price sells first,
-                                                    // so I am last in line at
-                                                    // upper bound.
-                std::pair<int64_t, OTOffer*>(lPriceLimit, &theOffer));
+            m_Asks.Add(theOffer);
             otLog4 << "Offer added as an ask to the market.\n";
         }
 
+        NotifyCron();
+
         if (bSaveFile) {
             // Set this to the current date/time, since the offer is
             // being added for the first time.
             //
             theOffer.SetDateAddedToMarket(OTTimeGetCurrentTime());
+            m_setChangedOffers.insert(lTransactionNum);
 
             return SaveMarket(); // <====== SAVE since an offer was added to the
                                  // Market.
@@ -779,10 +803,251 @@ bool OTMarket::LoadMarket()
             str_TRADES_FILE.Get())); // markets/recent/<market_ID>.bin
     }
 
+    m_bHaveSnapshot = bSuccess;
+
+    // Then bring it up to date with the changes made since that snapshot.
+    if (bSuccess) bSuccess = replay_journal();
+
     return bSuccess;
 }
 
+bool OTMarket::open_journal()
+{
+    if (m_Journal.IsOpen()) return true;
+
+    Identifier MARKET_ID(*this);
+    const String str_MARKET_ID(MARKET_ID);
+
+    if (!m_Journal.Open(str_MARKET_ID)) return false;
+
+    m_Journal.SkipTo(m_lJournalSequence);
+
+    return true;
+}
+
+bool OTMarket::replay_journal()
+{
+    if (!open_journal()) return false;
+
+    OTMarketJournal::vectorOfRecords theRecords;
+
+    const auto verify = [this](const std::string& strGroup,
+                               const std::string& strSignature) {
+        return verify_journal(strGroup, strSignature);
+    };
+
+    if (!m_Journal.Read(theRecords, verify)) return false;
+
+    int64_t lReplayed = 0;
+
+    for (const auto& it : theRecords) {
+        // Records up to m_lJournalSequence are already in the snapshot. (The
+        // journal is only emptied after the snapshot is saved.)
+        if (it.first <= m_lJournalSequence) continue;
+
+        if (!replay_record(it.second)) {
+            otErr << "OTMarket::" << __FUNCTION__
+                  << ": Failed replaying journal record " << it.first
+                  << ".\n";
+            return false;
+        }
+
+        lReplayed++;
+    }
+
+    if (0 < lReplayed) {
+        otWarn << "OTMarket::" << __FUNCTION__ << ": Replayed " << lReplayed
+               << " journaled changes.\n";
+    }
+
+    return true;
+}
+
+// The records are text:
+//
+//   "offer <dateAdded>\n<offer contract>"  The offer, as it is now.
+//   "remove <transaction #>"               The offer left the market.
+//   "trade <transaction #> <date> <price> <amount sold>"
+//
+bool OTMarket::replay_record(const std::string& strRecord)
+{
+    std::istringstream theRecord(strRecord);
+    std::string strType;
+    theRecord >> strType;
+
+    if ("offer" == strType) {
+        int64_t lDateAdded = 0;
+        theRecord >> lDateAdded;
+
+        const std::string::size_type nBreak = strRecord.find('\n');
+
+        if (theRecord.fail() || (std::string::npos == nBreak)) return false;
+
+        const String strOffer(strRecord.substr(nBreak + 1));
+        const time64_t tDateAdded = OTTimeGetTimeFromSeconds(lDateAdded);
+        std::unique_ptr<OTOffer> pOffer(new OTOffer(
+            m_NOTARY_ID, m_INSTRUMENT_DEFINITION_ID, m_CURRENCY_TYPE_ID,
+            m_lScale));
+
+        if (!pOffer->LoadContractFromString(strOffer)) return false;
+
+        OTOffer* pExisting = GetOffer(pOffer->GetTransactionNum());
+
+        if (nullptr == pExisting) {
+            if (!AddOffer(nullptr, *pOffer, false, tDateAdded)) return false;
+
+            pOffer.release(); // The market owns it now.
+
+            return true;
+        }
+
+        // A later state of an offer which is already on the market. It's
+        // loaded in place, so it keeps its place in line.
+        const int64_t lWasAvailable = pExisting->GetAmountAvailable();
+
+        if (!pExisting->LoadContractFromString(strOffer)) return false;
+
+        pExisting->SetDateAddedToMarket(tDateAdded);
+        (pExisting->IsBid() ? m_Bids : m_Asks)
+            .Filled(*pExisting,
+                    lWasAvailable - pExisting->GetAmountAvailable());
+
+        return true;
+    }
+    else if ("remove" == strType) {
+        int64_t lTransactionNum = 0;
+        theRecord >> lTransactionNum;
+
+        if (theRecord.fail()) return false;
+
+        // It may already be gone, if the snapshot was saved after it.
+        if (nullptr != GetOffer(lTransactionNum)) {
+            remove_offer(lTransactionNum);
+        }
+
+        return true;
+    }
+    else if ("trade" == strType) {
+        int64_t lTransactionNum = 0, lPrice = 0, lAmountSold = 0;
+        std::string strDate;
+        theRecord >> lTransactionNum >> strDate >> lPrice >> lAmountSold;
+
+        if (theRecord.fail()) return false;
+
+        m_lLastSalePrice = lPrice;
+        record_trade(lTransactionNum, strDate, lPrice, lAmountSold);
+
+        return true;
+    }
+
+    otErr << "OTMarket::" << __FUNCTION__
+          << ": Unknown journal record: " << strType << "\n";
+
+    return false;
+}
+
+// The journal stands in for the signed market between snapshots, so each
+// group of records the journal writes is signed by the server Nym as well.
+bool OTMarket::sign_journal(
+    const std::string& strGroup, std::string& strSignature)
+{
+    const Nym* pServerNym = GetCron()->GetServerNym();
+    OT_ASSERT(nullptr != pServerNym);
+
+    const OTAsymmetricKey& theKey = pServerNym->GetPrivateSignKey();
+    const OTData thePlaintext(
+        strGroup.data(), static_cast<uint32_t>(strGroup.size()));
+    OTData theSignature;
+    OTPasswordData thePWData("Signing the journal of a market.");
+
+    if (!theKey.engine().Sign(thePlaintext, theKey, m_strSigHashType,
+                              theSignature, &thePWData)) {
+        return false;
+    }
+
+    strSignature.assign(static_cast<const char*>(theSignature.GetPointer()),
+                        theSignature.GetSize());
+
+    return true;
+}
+
+bool OTMarket::verify_journal(
+    const std::string& strGroup, const std::string& strSignature)
+{
+    const Nym* pServerNym = GetCron()->GetServerNym();
+    OT_ASSERT(nullptr != pServerNym);
+
+    const OTAsymmetricKey& theKey = pServerNym->GetPublicSignKey();
+    const OTData thePlaintext(
+        strGroup.data(), static_cast<uint32_t>(strGroup.size()));
+    const OTData theSignature(
+        strSignature.data(), static_cast<uint32_t>(strSignature.size()));
+    OTPasswordData thePWData("Verifying the journal of a market.");
+
+    return theKey.engine().Verify(thePlaintext, theKey, theSignature,
+                                  m_strSigHashType, &thePWData);
+}
+
+// Queues the current state of every offer that changed.
+void OTMarket::journal_changed_offers()
+{
+    for (const auto& lTransactionNum : m_setChangedOffers) {
+        OTOffer* pOffer = GetOffer(lTransactionNum);
+
+        if (nullptr == pOffer) continue;
+
+        const String strOffer(*pOffer);
+        std::string strRecord(
+            "offer " +
+            to_string<int64_t>(
+                OTTimeGetSecondsFromTime(pOffer->GetDateAddedToMarket())) +
+            "\n");
+        strRecord.append(strOffer.Get());
+        m_Journal.Append(strRecord);
+    }
+
+    m_setChangedOffers.clear();
+}
+
+void OTMarket::OfferChanged(const OTOffer& theOffer)
+{
+    m_setChangedOffers.insert(theOffer.GetTransactionNum());
+}
+
 bool OTMarket::SaveMarket()
+{
+    OT_ASSERT(nullptr != GetCron());
+
+    // A brand new market has nothing for a journal to build on.
+    if (!m_bHaveSnapshot) return SaveSnapshot();
+
+    journal_changed_offers();
+
+    // The journal is committed even while cron defers its saves: a trade
+    // saves its accounts and receipts right after the market, and a crash
+    // must never leave the offers behind the balances. Only the snapshot
+    // waits for the end of cron's round.
+    if (!GetCron()->IsSaveDeferred() && SnapshotDue()) return SaveSnapshot();
+
+    // If the journal can't be written, the changes are saved the old way.
+    const auto sign = [this](const std::string& strGroup,
+                             std::string& strSignature) {
+        return sign_journal(strGroup, strSignature);
+    };
+
+    if (!open_journal() || !m_Journal.Commit(sign)) return SaveSnapshot();
+
+    return true;
+}
+
+bool OTMarket::SnapshotDue() const
+{
+    return m_Journal.Count() >=
+           static_cast<std::size_t>(
+               std::max<int32_t>(1, OTCron::GetCronMarketSnapshotInterval()));
+}
+
+bool OTMarket::SaveSnapshot()
 {
     OT_ASSERT(nullptr != GetCron());
     OT_ASSERT(nullptr != GetCron()->GetServerNym());
@@ -793,6 +1058,12 @@ bool OTMarket::SaveMarket()
     const char* szFoldername = OTFolders::Market().Get();
     const char* szFilename = str_MARKET_ID.Get();
 
+    // Everything queued for the journal is in the snapshot. The sequence
+    // number it records tells a replay which journal records to skip, in case
+    // the journal can't be emptied below.
+    journal_changed_offers();
+    m_lJournalSequence = m_Journal.Sequence();
+
     // Remember, if the market has changed, the new contents will not be written
     // anywhere
     // until that market has been signed. So I have to re-sign here, or it would
@@ -801,9 +1072,16 @@ bool OTMarket::SaveMarket()
     ReleaseSignatures();
 
     // Sign it, save it internally to string, and then save that out to the
-    // file.
+    // file. The journal is emptied below, so the snapshot goes to disk the
+    // durable way rather than through OTDB.
+    m_strFoldername.Set(szFoldername);
+    m_strFilename.Set(szFilename);
+    String strFinal;
+
     if (!SignContract(*(GetCron()->GetServerNym())) || !SaveContract() ||
-        !SaveContract(szFoldername, szFilename)) {
+        !OTASCIIArmor(m_strRawFile)
+             .WriteArmoredString(strFinal, m_strContractType.Get()) ||
+        !open_journal() || !m_Journal.WriteFile(szFilename, strFinal.Get())) {
         otErr << "Error saving Market:\n" << szFoldername
               << Log::PathSeparator() << szFilename << "\n";
         return false;
@@ -827,9 +1105,71 @@ bool OTMarket::SaveMarket()
                   << szFilename << "\n";
     }
 
+    m_bHaveSnapshot = true;
+
+    if (!m_Journal.Clear()) {
+        otErr << "OTMarket::" << __FUNCTION__
+              << ": Failed to empty the journal for Market: " << szFilename
+              << "\n";
+    }
+
     return true;
 }
 
+// Adds a trade to the list of the most recent 50 trades.
+void OTMarket::record_trade(const int64_t& lTransactionNum,
+                            const std::string& strDate, const int64_t& lPrice,
+                            const int64_t& lAmountSold)
+{
+    if (nullptr == m_pTradeList) {
+        m_pTradeList = dynamic_cast<OTDB::TradeListMarket*>(
+            OTDB::CreateObject(OTDB::STORED_OBJ_TRADE_LIST_MARKET));
+    }
+
+    std::unique_ptr<OTDB::TradeDataMarket> pTradeData(
+        dynamic_cast<OTDB::TradeDataMarket*>(
+            OTDB::CreateObject(OTDB::STORED_OBJ_TRADE_DATA_MARKET)));
+
+    pTradeData->transaction_id = to_string<int64_t>(lTransactionNum);
+    pTradeData->date = strDate;
+    pTradeData->price = to_string<int64_t>(lPrice);
+    pTradeData->amount_sold = to_string<int64_t>(lAmountSold);
+
+    m_strLastSaleDate = pTradeData->date;
+
+    // *pTradeData is CLONED at this time (I'm still responsible to delete.)
+    // That's also why I add it here, after all the above: So the data is set
+    // right BEFORE the cloning occurs.
+    //
+    m_pTradeList->AddTradeDataMarket(*pTradeData);
+
+    // Here we erase the oldest elements so the list never exceeds 50 elements
+    // total.
+    //
+    while (m_pTradeList->GetTradeDataMarketCount() > MAX_MARKET_QUERY_DEPTH)
+        m_pTradeList->RemoveTradeDataMarket(0);
+}
+
+// Versions start from the time the market is created or loaded, so that a
+// version a client got before a restart isn't mistaken for a current one.
+int64_t OTMarket::initial_version()
+{
+    return OTTimeGetSecondsFromTime(OTTimeGetCurrentTime()) * 1000000;
+}
+
+// Lets Cron know that trades resting on this market may be able to match now.
+void OTMarket::NotifyCron()
+{
+    // The cached market data is out of date as well.
+    m_lVersion++;
+
+    if (nullptr == m_pCron) return;
+
+    Identifier MARKET_ID;
+    GetIdentifier(MARKET_ID);
+    m_pCron->MarketChanged(MARKET_ID);
+}
+
 // A Market's ID is based on the instrument definition, the currency type, and
 // the scale.
 //
@@ -853,46 +1193,17 @@ void OTMarket::GetIdentifier(Identifier& theIdentifier) const
 // bid on the market.
 int64_t OTMarket::GetHighestBidPrice()
 {
-    int64_t lPrice = 0;
-
-    mapOfOffers::reverse_iterator rr = m_mapBids.rbegin();
-
-    if (rr != m_mapBids.rend()) {
-        lPrice = rr->first;
-    }
-
-    return lPrice;
+    return m_Bids.BestPrice();
 }
 
 // returns 0 if there are no asks. Otherwise returns the value of the lowest ask
 // on the market.
+//
+// Market orders have a 0 price, which would undercut the actual prices, but
+// they wait on their own list in the order book so there's nothing to skip.
 int64_t OTMarket::GetLowestAskPrice()
 {
-    int64_t lPrice = 0;
-
-    auto it = m_mapAsks.begin();
-
-    if (it != m_mapAsks.end()) {
-        lPrice = it->first;
-
-        // Market orders have a 0 price, so we need to skip any if they are
-        // here.
-        //
-        // Note that we don't have to do this with the highest bid price (above
-        // function) but in the case of asks, a "0 price" will undercut the
-        // other
-        // actual prices, so we need to skip any that have a 0 price.
-        //
-        while (0 == lPrice) {
-            ++it;
-
-            if (it == m_mapAsks.end()) break;
-
-            lPrice = it->first;
-        }
-    }
-
-    return lPrice;
+    return m_Asks.BestPrice();
 }
 
 // This utility function is used directly below (only).
@@ -1790,6 +2101,12 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
                     lOtherOfferFinished); // I was storing these up in the loop
                                           // above.
 
+                // Keep the totals for each price level in step.
+                (theOffer.IsBid() ? m_Bids : m_Asks)
+                    .Filled(theOffer, lOfferFinished);
+                (theOtherOffer.IsBid() ? m_Bids : m_Asks)
+                    .Filled(theOtherOffer, lOtherOfferFinished);
+
                 // These have updated values, so let's save them.
                 theTrade.ReleaseSignatures();
                 theTrade.SignContract(*pServerNym);
@@ -1809,50 +2126,31 @@ void OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer,
 
                 m_lLastSalePrice =
                     theOtherOffer.GetPriceLimit(); // Priced per scale.
+                NotifyCron(); // The book has changed.
 
                 // Here we save this trade in a list of the most recent 50
                 // trades.
                 {
-                    if (nullptr == m_pTradeList) {
-                        m_pTradeList = dynamic_cast<OTDB::TradeListMarket*>(
-                            OTDB::CreateObject(
-                                OTDB::STORED_OBJ_TRADE_LIST_MARKET));
-                    }
-
-                    std::unique_ptr<OTDB::TradeDataMarket> pTradeData(
-                        dynamic_cast<OTDB::TradeDataMarket*>(OTDB::CreateObject(
-                            OTDB::STORED_OBJ_TRADE_DATA_MARKET)));
-
                     const int64_t& lTransactionNum =
                         theOffer.GetTransactionNum();
-                    const time64_t theDate = OTTimeGetCurrentTime();
+                    const std::string strDate =
+                        to_string<time64_t>(OTTimeGetCurrentTime());
                     const int64_t& lPriceLimit =
                         theOtherOffer.GetPriceLimit(); // Priced per scale.
                     const int64_t& lAmountSold = lOfferFinished;
 
-                    pTradeData->transaction_id =
-                        to_string<int64_t>(lTransactionNum);
-                    pTradeData->date = to_string<time64_t>(theDate);
-                    pTradeData->price = to_string<int64_t>(lPriceLimit);
-                    pTradeData->amount_sold = to_string<int64_t>(lAmountSold);
-
-                    m_strLastSaleDate = pTradeData->date;
-
-                    // *pTradeData is CLONED at this time (I'm still responsible
-                    // to delete.)
-                    // That's also why I add it here, after all the above: So
-                    // the data is set right BEFORE the cloning occurs.
-                    //
-                    m_pTradeList->AddTradeDataMarket(*pTradeData);
-
-                    // Here we erase the oldest elements so the list never
-                    // exceeds 50 elements total.
-                    //
-                    while (m_pTradeList->GetTradeDataMarketCount() >
-                           MAX_MARKET_QUERY_DEPTH)
-                        m_pTradeList->RemoveTradeDataMarket(0);
+                    record_trade(lTransactionNum, strDate, lPriceLimit,
+                                 lAmountSold);
+                    m_Journal.Append("trade " +
+                                     to_string<int64_t>(lTransactionNum) +
+                                     " " + strDate + " " +
+                                     to_string<int64_t>(lPriceLimit) + " " +
+                                     to_string<int64_t>(lAmountSold));
                 }
 
+                m_setChangedOffers.insert(theOffer.GetTransactionNum());
+                m_setChangedOffers.insert(theOtherOffer.GetTransactionNum());
+
                 // Account balances have changed based on these trades that we
                 // just processed.
                 // Make sure to save the Market since it contains those offers
@@ -2421,167 +2719,42 @@ bool OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer)
     // in the market WITHIN THIS TRADE'S PRICE LIMITS. So we're going to go up
     // the list of what's available, and trade.
 
-    if (theOffer.IsAsk()) // If I'm selling,
-    {
-        // rbegin puts us on the upper bound of the highest bidder (any new
-        // bidders at the same price would
-        // be added at the lower bound, where they are last in line.) The upper
-        // bound, on the other hand, is
-        // first in line.  So we start there, and loop backwards until there are
-        // no other bids within my price range.
-        for (mapOfOffers::reverse_iterator rr = m_mapBids.rbegin();
-             rr != m_mapBids.rend(); ++rr) {
-            // then I want to start at the highest bidder and loop DOWN until
-            // hitting my price limit.
-            OTOffer* pBid = rr->second;
-            OT_ASSERT(nullptr != pBid);
-
-            // NOTE: Market orders only process once, and they are processed in
-            // the order they were added to the market.
-            //
-            // If BOTH offers are market orders, we just skip this bid.
-            //
-            // But FURTHERMORE: We ONLY process a market order as theOffer, not
-            // as pBid!
-            // Imagine if pBid is a market order and theOffer isn't -- that
-            // would mean pBid
-            // hasn't been processed yet (since it will only process once.) So
-            // it needs to
-            // wait its turn! It will get its one shot WHEN ITS TURN comes.
-            //
-            if (pBid->IsMarketOrder())
-                //          if (theOffer.IsMarketOrder() &&
-                // pBid->IsMarketOrder())
-                //              continue;
-                break;
-            // NOTE: Why break, instead of continue? Because since we are
-            // looping through the bids,
-            // from the HIGHEST down to the LOWEST, and since market orders have
-            // a ZERO price, we know
-            // for a fact that there are not any other non-zero bids. (So we
-            // might as well break.)
-
-            // I'm selling.
-            //
-            // If the bid is larger than, or equal to, my low-side-limit,
-            // and the amount available is at least my minimum increment, (and
-            // vice versa),
-            // ...then let's trade!
-            //
-            if (theOffer.IsMarketOrder() || // If I don't care about price...
-                (pBid->GetPriceLimit() >=
-                 theOffer.GetPriceLimit())) // Or if this bid is within my price
-                                            // range...
-            {
-                // Notice the above "if" is ONLY based on price... because the
-                // "else" returns!
-                // (Once I am out of my price range, no point to continue
-                // looping.)
-                //
-                // ...So all the other "if"s have to go INSIDE the block here:
-                //
-                if ((pBid->GetAmountAvailable() >=
-                     theOffer.GetMinimumIncrement()) &&
-                    (theOffer.GetAmountAvailable() >=
-                     pBid->GetMinimumIncrement()) &&
-                    (nullptr != pBid->GetTrade()) &&
-                    !pBid->GetTrade()->IsFlaggedForRemoval())
-
-                    ProcessTrade(theTrade, theOffer, *pBid); // <========
-            }
+    // Either way, the other side's book is walked from its best price
+    // outwards, and each price level in the order its offers were added.
+    // Market orders on the other side aren't in the way: they only process
+    // once, as theOffer, when their own turn comes. (If we traded with one
+    // here, it would be processing before its turn.)
+    //
+    const OTOrderBook& theBook = (theOffer.IsAsk() ? m_Bids : m_Asks);
 
-            // Else, the bid is lower than I am willing to sell. (And all the
-            // remaining bids are even lower.)
-            //
-            else if (theOffer.IsLimitOrder()) {
-                pBid = nullptr;
-                return true; // stay on cron for more processing (for now.)
-            }
+    for (std::size_t nLevel = 0; nLevel < theBook.LevelCount(); ++nLevel) {
+        const OTOrderBook::PriceLevel& theLevel = theBook.Level(nLevel);
 
-            // The offer has no more trading to do--it's done.
-            if (theTrade.IsFlaggedForRemoval() || // during processing, the
-                                                  // trade may have gotten
-                                                  // flagged.
-                (theOffer.GetMinimumIncrement() >
-                 theOffer.GetAmountAvailable())) {
-
-                    otInfo << "OTMarket::" << __FUNCTION__ << ": Removing market order: "
-                        << formatLong(theTrade.GetOpeningNum()) << ". IsFlaggedForRemoval: "
-                        << formatBool(theTrade.IsFlaggedForRemoval())
-                        << ". Minimum increment is larger than Amount available: "
-                    <<  (theOffer.GetMinimumIncrement() > theOffer.GetAmountAvailable()) << "\n";
+        // If I'm selling, and this bid is lower than I am willing to sell. Or
+        // if I'm buying, and this ask is higher than I am willing to pay.
+        // (Either way, all the remaining levels are even further away.)
+        // Market orders don't care about price.
+        //
+        if (theOffer.IsLimitOrder() &&
+            (theOffer.IsAsk() ? (theLevel.price_ < theOffer.GetPriceLimit())
+                              : (theLevel.price_ > theOffer.GetPriceLimit()))) {
+            return true; // stay on cron for more processing (for now.)
+        }
 
-                    return false; // remove this trade from cron
-                }
+        for (auto& pOtherOffer : theLevel.offers_) {
+            OT_ASSERT(nullptr != pOtherOffer);
 
-            pBid = nullptr;
-        }
-    }
-    // I'm buying
-    else {
-        // Begin puts us on the lower bound of the lowest seller (any new
-        // sellers at the same price would
-        // be added at the upper bound for that price, where they are last in
-        // line.) The lower bound, on the other hand, is
-        // first in line.  So we start there, and loop forwards until there are
-        // no other asks within my price range.
-        //
-        for (auto& it : m_mapAsks) {
-            // then I want to start at the lowest seller and loop UP until
-            // hitting my price limit.
-            OTOffer* pAsk = it.second;
-            OT_ASSERT(nullptr != pAsk);
-
-            // NOTE: Market orders only process once, and they are processed in
-            // the order they were added to the market.
+            // If the amount available is at least my minimum increment, (and
+            // vice versa), ...then let's trade!
             //
-            // If BOTH offers are market orders, we just skip this ask.
-            //
-            // But FURTHERMORE: We ONLY process a market order as theOffer, not
-            // as pAsk!
-            // Imagine if pAsk is a market order and theOffer isn't -- that
-            // would mean pAsk
-            // hasn't been processed yet (since it will only process once.) So
-            // it needs to
-            // wait its turn! It will get its one shot WHEN ITS TURN comes.
-            //
-            if (pAsk->IsMarketOrder())
-                //          if (theOffer.IsMarketOrder() &&
-                // pAsk->IsMarketOrder())
-                continue;
-
-            // I'm buying.
-            // If the ask price is less than, or equal to, my price limit,
-            // and the amount available for purchase is at least my minimum
-            // increment, (and vice versa),
-            // ...then let's trade!
-            //
-            if (theOffer.IsMarketOrder() || // If I don't care about price...
-                (pAsk->GetPriceLimit() <=
-                 theOffer.GetPriceLimit())) // Or if this ask is within my price
-                                            // range...
-            {
-                // Notice the above "if" is ONLY based on price... because the
-                // "else" returns!
-                // (Once I am out of my price range, no point to continue
-                // looping.)
-                // So all the other "if"s have to go INSIDE the block here:
-                //
-                if ((pAsk->GetAmountAvailable() >=
-                     theOffer.GetMinimumIncrement()) &&
-                    (theOffer.GetAmountAvailable() >=
-                     pAsk->GetMinimumIncrement()) &&
-                    (nullptr != pAsk->GetTrade()) &&
-                    !pAsk->GetTrade()->IsFlaggedForRemoval())
-
-                    ProcessTrade(theTrade, theOffer, *pAsk); // <=======
-            }
-            // Else, the ask price is higher than I am willing to pay. (And all
-            // the remaining sellers are even HIGHER.)
-            else if (theOffer.IsLimitOrder()) {
-                pAsk = nullptr;
-                return true; // stay on the market for now.
-            }
+            if ((pOtherOffer->GetAmountAvailable() >=
+                 theOffer.GetMinimumIncrement()) &&
+                (theOffer.GetAmountAvailable() >=
+                 pOtherOffer->GetMinimumIncrement()) &&
+                (nullptr != pOtherOffer->GetTrade()) &&
+                !pOtherOffer->GetTrade()->IsFlaggedForRemoval())
+
+                ProcessTrade(theTrade, theOffer, *pOtherOffer); // <========
 
             // The offer has no more trading to do--it's done.
             if (theTrade.IsFlaggedForRemoval() || // during processing, the
@@ -2590,16 +2763,18 @@ bool OTMarket::ProcessTrade(OTTrade& theTrade, OTOffer& theOffer)
                 (theOffer.GetMinimumIncrement() >
                  theOffer.GetAmountAvailable())) {
 
-                    otInfo << "OTMarket::" << __FUNCTION__ << ": Removing market order: "
-                        << formatLong(theTrade.GetOpeningNum()) << ". IsFlaggedForRemoval: "
-                        << formatBool(theTrade.IsFlaggedForRemoval())
-                        << ". Minimum increment is larger than Amount available: "
-                        <<  (theOffer.GetMinimumIncrement() > theOffer.GetAmountAvailable()) << "\n";
-
-                    return false; // remove this trade from the market.
-                }
-
-            pAsk = nullptr;
+                otInfo << "OTMarket::" << __FUNCTION__
+                       << ": Removing market order: "
+                       << formatLong(theTrade.GetOpeningNum())
+                       << ". IsFlaggedForRemoval: "
+                       << formatBool(theTrade.IsFlaggedForRemoval())
+                       << ". Minimum increment is larger than Amount "
+                          "available: "
+                       << (theOffer.GetMinimumIncrement() >
+                           theOffer.GetAmountAvailable()) << "\n";
+
+                return false; // remove this trade from cron
+            }
         }
     }
 
@@ -2693,8 +2868,14 @@ OTMarket::OTMarket(const char* szFilename)
     : Contract()
     , m_pCron(nullptr)
     , m_pTradeList(nullptr)
+    , m_Bids(true)
+    , m_Asks(false)
     , m_lScale(1)
     , m_lLastSalePrice(0)
+    , m_lJournalSequence(0)
+    , m_bHaveSnapshot(false)
+    , m_lVersion(initial_version())
+    , m_lNextOfferListToken(initial_version())
 {
     OT_ASSERT(nullptr != szFilename);
 
@@ -2709,8 +2890,14 @@ OTMarket::OTMarket()
     : Contract()
     , m_pCron(nullptr)
     , m_pTradeList(nullptr)
+    , m_Bids(true)
+    , m_Asks(false)
     , m_lScale(1)
     , m_lLastSalePrice(0)
+    , m_lJournalSequence(0)
+    , m_bHaveSnapshot(false)
+    , m_lVersion(initial_version())
+    , m_lNextOfferListToken(initial_version())
 {
     m_pCron = nullptr; // just for convenience, not responsible to delete.
     InitMarket();
@@ -2722,8 +2909,14 @@ OTMarket::OTMarket(const Identifier& NOTARY_ID,
     : Contract()
     , m_pCron(nullptr)
     , m_pTradeList(nullptr)
+    , m_Bids(true)
+    , m_Asks(false)
     , m_lScale(1)
     , m_lLastSalePrice(0)
+    , m_lJournalSequence(0)
+    , m_bHaveSnapshot(false)
+    , m_lVersion(initial_version())
+    , m_lNextOfferListToken(initial_version())
 {
     m_pCron = nullptr; // just for convenience, not responsible to delete.
     InitMarket();
@@ -2761,16 +2954,22 @@ void OTMarket::Release_Market()
         m_pTradeList = nullptr;
     }
 
+    m_Journal.Close();
+    m_setChangedOffers.clear();
+    m_mapOfferListCache.clear();
+    m_RecentTradesCache.version_ = 0;
+    m_lVersion++;
+    m_lJournalSequence = 0;
+    m_bHaveSnapshot = false;
+
     // If there were any dynamically allocated objects, clean them up here.
-    while (!m_mapBids.empty()) {
-        OTOffer* pOffer = m_mapBids.begin()->second;
-        m_mapBids.erase(m_mapBids.begin());
-        delete pOffer;
-        pOffer = nullptr;
-    }
-    while (!m_mapAsks.empty()) {
-        OTOffer* pOffer = m_mapAsks.begin()->second;
-        m_mapAsks.erase(m_mapAsks.begin());
+    // (Every offer on the books is also on m_mapOffers.)
+    m_Bids.Release();
+    m_Asks.Release();
+
+    while (!m_mapOffers.empty()) {
+        OTOffer* pOffer = m_mapOffers.begin()->second;
+        m_mapOffers.erase(m_mapOffers.begin());
         delete pOffer;
         pOffer = nullptr;
     }
@@ -0,0 +1,495 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/core/trade/OTMarketJournal.hpp"
+
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/util/OTDataFolder.hpp"
+#include "opentxs/core/util/OTFolders.hpp"
+#include "opentxs/core/util/OTPaths.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+// length (4) + sequence (8) ... checksum (4)
+#define OT_MARKET_JOURNAL_HEADER 12
+#define OT_MARKET_JOURNAL_TRAILER 4
+// Records are numbered from 1. The record closing a group, which holds the
+// group's signature, has this number instead.
+#define OT_MARKET_JOURNAL_SIGNATURE 0
+
+namespace opentxs
+{
+
+namespace
+{
+
+void put_uint(std::string& output, uint64_t value, const std::size_t bytes)
+{
+    for (std::size_t i = 0; i < bytes; ++i) {
+        output.push_back(static_cast<char>(value & 0xff));
+        value >>= 8;
+    }
+}
+
+uint64_t get_uint(const char* input, const std::size_t bytes)
+{
+    uint64_t value = 0;
+
+    for (std::size_t i = bytes; i > 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(input[i - 1]);
+    }
+
+    return value;
+}
+
+// The low level file calls the journal needs, for both POSIX and Windows.
+
+int open_file(const std::string& strFile)
+{
+#ifdef _WIN32
+    int fd = -1;
+    _sopen_s(&fd, strFile.c_str(), _O_RDWR | _O_CREAT | _O_BINARY,
+             _SH_DENYNO, _S_IREAD | _S_IWRITE);
+
+    return fd;
+#else
+    return open(strFile.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+#endif
+}
+
+void close_file(const int fd)
+{
+#ifdef _WIN32
+    _close(fd);
+#else
+    close(fd);
+#endif
+}
+
+bool sync_file(const int fd)
+{
+#ifdef _WIN32
+    return 0 == _commit(fd);
+#else
+    return 0 == fsync(fd);
+#endif
+}
+
+bool truncate_file(const int fd, const int64_t size)
+{
+#ifdef _WIN32
+    return 0 == _chsize_s(fd, size);
+#else
+    return 0 == ftruncate(fd, static_cast<off_t>(size));
+#endif
+}
+
+// Returns the size of the file, and leaves the file position at its end.
+int64_t seek_end(const int fd)
+{
+#ifdef _WIN32
+    return _lseeki64(fd, 0, SEEK_END);
+#else
+    return static_cast<int64_t>(lseek(fd, 0, SEEK_END));
+#endif
+}
+
+bool read_file(const int fd, char* output, const std::size_t size)
+{
+#ifdef _WIN32
+    if (0 != _lseeki64(fd, 0, SEEK_SET)) return false;
+#else
+    if (0 != lseek(fd, 0, SEEK_SET)) return false;
+#endif
+
+    std::size_t done = 0;
+
+    while (done < size) {
+#ifdef _WIN32
+        const int count =
+            _read(fd, output + done, static_cast<unsigned int>(size - done));
+#else
+        const ssize_t count = read(fd, output + done, size - done);
+#endif
+
+        if (0 >= count) return false;
+
+        done += static_cast<std::size_t>(count);
+    }
+
+    return true;
+}
+
+bool write_file(const int fd, const char* input, const std::size_t size)
+{
+    std::size_t done = 0;
+
+    while (done < size) {
+#ifdef _WIN32
+        const int count =
+            _write(fd, input + done, static_cast<unsigned int>(size - done));
+#else
+        const ssize_t count = write(fd, input + done, size - done);
+#endif
+
+        if (0 >= count) return false;
+
+        done += static_cast<std::size_t>(count);
+    }
+
+    return true;
+}
+
+// Makes a file created (or renamed) in strFolder durable. Windows has no
+// equivalent, and doesn't need one: NTFS journals its directory changes.
+bool sync_folder(const std::string& strFolder)
+{
+#ifdef _WIN32
+    return true;
+#else
+    const int fd = open(strFolder.c_str(), O_RDONLY);
+
+    if (-1 == fd) return false;
+
+    const bool bSynced = (0 == fsync(fd));
+    close(fd);
+
+    return bSynced;
+#endif
+}
+
+bool rename_file(const std::string& strFrom, const std::string& strTo)
+{
+#ifdef _WIN32
+    return 0 != MoveFileExA(strFrom.c_str(), strTo.c_str(),
+                            MOVEFILE_REPLACE_EXISTING |
+                                MOVEFILE_WRITE_THROUGH);
+#else
+    return 0 == std::rename(strFrom.c_str(), strTo.c_str());
+#endif
+}
+
+} // namespace
+
+OTMarketJournal::~OTMarketJournal()
+{
+    Close();
+}
+
+// FNV-1a. This only has to catch torn and garbled writes.
+uint32_t OTMarketJournal::checksum(const char* data, const std::size_t size)
+{
+    uint32_t hash = 2166136261u;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Records appended before the journal is opened stay queued.
+bool OTMarketJournal::Open(const String& strMarketID)
+{
+    if (-1 != fd_) close_file(fd_);
+
+    fd_ = -1;
+
+    String strDataFolder, strFolder;
+
+    if (!OTDataFolder::Get(strDataFolder) ||
+        !OTPaths::AppendFolder(strFolder, strDataFolder, OTFolders::Market())) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to find the markets folder.\n";
+        return false;
+    }
+
+    bool bCreated = false;
+
+    if (!OTPaths::BuildFolderPath(strFolder, bCreated)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to create the markets folder: " << strFolder
+              << "\n";
+        return false;
+    }
+
+    folder_ = strFolder.Get();
+    file_ = folder_ + strMarketID.Get() + ".journal";
+    const bool bExists = OTPaths::PathExists(String(file_.c_str()));
+    fd_ = open_file(file_);
+
+    if (-1 == fd_) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to open " << file_ << "\n";
+        return false;
+    }
+
+    // Otherwise a crash could lose the new file, with everything later
+    // committed to it.
+    if (!bExists && !sync_folder(folder_)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to sync the markets folder: " << strFolder
+              << "\n";
+        close_file(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void OTMarketJournal::Close()
+{
+    if (-1 != fd_) close_file(fd_);
+
+    fd_ = -1;
+    pending_.clear();
+    pending_count_ = 0;
+    count_ = 0;
+    sequence_ = 0;
+}
+
+bool OTMarketJournal::Read(
+    vectorOfRecords& theRecords, const Verifier& verify)
+{
+    if (-1 == fd_) return false;
+
+    const int64_t end = seek_end(fd_);
+
+    if (0 > end) return false;
+
+    const std::size_t size = static_cast<std::size_t>(end);
+    std::vector<char> buffer(size);
+
+    if ((0 < size) && !read_file(fd_, &buffer[0], size)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to read " << file_ << "\n";
+        return false;
+    }
+
+    std::size_t position = 0;
+    std::size_t groupStart = 0; // Everything before this is verified.
+    vectorOfRecords group;
+
+    while (position + OT_MARKET_JOURNAL_HEADER + OT_MARKET_JOURNAL_TRAILER <=
+           size) {
+        const char* record = &buffer[position];
+        const std::size_t length = static_cast<std::size_t>(get_uint(record, 4));
+        const std::size_t total =
+            OT_MARKET_JOURNAL_HEADER + length + OT_MARKET_JOURNAL_TRAILER;
+
+        if (position + total > size) break;
+
+        const uint32_t expected = static_cast<uint32_t>(
+            get_uint(record + OT_MARKET_JOURNAL_HEADER + length, 4));
+
+        if (expected != checksum(record + 4, 8 + length)) break;
+
+        const int64_t lSequence = static_cast<int64_t>(get_uint(record + 4, 8));
+        const std::string strPayload(record + OT_MARKET_JOURNAL_HEADER, length);
+        position += total;
+
+        if (OT_MARKET_JOURNAL_SIGNATURE != lSequence) {
+            group.push_back(std::make_pair(lSequence, strPayload));
+            continue;
+        }
+
+        const std::string strGroup(
+            &buffer[groupStart], position - total - groupStart);
+
+        if (!verify(strGroup, strPayload)) {
+            otErr << "OTMarketJournal::" << __FUNCTION__
+                  << ": Invalid signature at offset " << (position - total)
+                  << " of " << file_ << "\n";
+            return false;
+        }
+
+        for (auto& it : group) {
+            SkipTo(it.first);
+            count_++;
+            theRecords.push_back(std::move(it));
+        }
+
+        group.clear();
+        groupStart = position;
+    }
+
+    if (groupStart < size) {
+        otErr << "OTMarketJournal::" << __FUNCTION__ << ": Dropping "
+              << (size - groupStart) << " bytes of incomplete records from "
+              << file_ << "\n";
+
+        if (!truncate_file(fd_, static_cast<int64_t>(groupStart)) ||
+            !sync_file(fd_)) {
+            otErr << "OTMarketJournal::" << __FUNCTION__
+                  << ": Unable to truncate " << file_ << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OTMarketJournal::frame(
+    std::string& output, const int64_t& lSequence, const std::string& strData)
+{
+    const std::size_t start = output.size();
+
+    put_uint(output, strData.size(), 4);
+    put_uint(output, static_cast<uint64_t>(lSequence), 8);
+    output.append(strData);
+    put_uint(output, checksum(output.data() + start + 4, 8 + strData.size()),
+             4);
+}
+
+int64_t OTMarketJournal::Append(const std::string& strRecord)
+{
+    const int64_t lSequence = ++sequence_;
+
+    frame(pending_, lSequence, strRecord);
+    pending_count_++;
+
+    return lSequence;
+}
+
+bool OTMarketJournal::Commit(const Signer& sign)
+{
+    if (pending_.empty()) return true;
+
+    if (-1 == fd_) return false;
+
+    std::string strSignature;
+
+    if (!sign(pending_, strSignature)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to sign the records for " << file_ << "\n";
+        return false;
+    }
+
+    std::string strGroup(pending_);
+    frame(strGroup, OT_MARKET_JOURNAL_SIGNATURE, strSignature);
+
+    const int64_t end = seek_end(fd_);
+
+    // One write and one fsync for the whole group.
+    if ((0 > end) || !write_file(fd_, strGroup.data(), strGroup.size()) ||
+        !sync_file(fd_)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to write " << file_ << "\n";
+
+        if ((0 <= end) && !truncate_file(fd_, end)) {
+            otErr << "OTMarketJournal::" << __FUNCTION__
+                  << ": Unable to roll back " << file_ << "\n";
+        }
+
+        return false;
+    }
+
+    count_ += pending_count_;
+    pending_.clear();
+    pending_count_ = 0;
+
+    return true;
+}
+
+bool OTMarketJournal::Clear()
+{
+    pending_.clear();
+    pending_count_ = 0;
+    count_ = 0;
+
+    if (-1 == fd_) return true;
+
+    if (!truncate_file(fd_, 0) || !sync_file(fd_)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to truncate " << file_ << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool OTMarketJournal::WriteFile(
+    const std::string& strFile, const std::string& strContents)
+{
+    if (folder_.empty()) return false;
+
+    const std::string strPath = folder_ + strFile;
+    const std::string strTemp = strPath + ".tmp";
+    const int fd = open_file(strTemp);
+
+    if (-1 == fd) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to open " << strTemp << "\n";
+        return false;
+    }
+
+    const bool bWritten = truncate_file(fd, 0) &&
+                          write_file(fd, strContents.data(),
+                                     strContents.size()) &&
+                          sync_file(fd);
+    close_file(fd);
+
+    if (!bWritten || !rename_file(strTemp, strPath) ||
+        !sync_folder(folder_)) {
+        otErr << "OTMarketJournal::" << __FUNCTION__
+              << ": Unable to write " << strPath << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace opentxs
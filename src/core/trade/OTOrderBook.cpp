@@ -0,0 +1,171 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/core/trade/OTOrderBook.hpp"
+
+#include "opentxs/core/trade/OTOffer.hpp"
+#include "opentxs/core/util/Assert.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace opentxs
+{
+
+OTOrderBook::OTOrderBook(const bool bids)
+    : bids_(bids)
+{
+}
+
+// Highest bid, lowest ask.
+bool OTOrderBook::better(const int64_t lhs, const int64_t rhs) const
+{
+    return bids_ ? (lhs > rhs) : (lhs < rhs);
+}
+
+// Returns the level for price, or the position where it would be inserted.
+std::vector<OTOrderBook::PriceLevel>::iterator OTOrderBook::find_level(
+    const int64_t price)
+{
+    return std::lower_bound(levels_.begin(), levels_.end(), price,
+                            [this](const PriceLevel& level, int64_t value) {
+                                return better(value, level.price_);
+                            });
+}
+
+int64_t OTOrderBook::BestPrice() const
+{
+    if (levels_.empty()) return 0;
+
+    return levels_.back().price_;
+}
+
+int64_t OTOrderBook::TotalAvailable() const
+{
+    int64_t lTotal = 0;
+
+    for (const auto& level : levels_) {
+        lTotal += level.quantity_;
+    }
+
+    for (const auto& pOffer : market_orders_) {
+        lTotal += pOffer->GetAmountAvailable();
+    }
+
+    return lTotal;
+}
+
+void OTOrderBook::Add(OTOffer& theOffer)
+{
+    OT_ASSERT(theOffer.IsBid() == bids_);
+
+    count_++;
+
+    if (theOffer.IsMarketOrder()) {
+        market_orders_.push_back(&theOffer);
+
+        return;
+    }
+
+    const int64_t lPrice = theOffer.GetPriceLimit();
+    auto it = find_level(lPrice);
+
+    if ((levels_.end() == it) || (it->price_ != lPrice)) {
+        it = levels_.insert(it, PriceLevel(lPrice));
+    }
+
+    it->offers_.push_back(&theOffer);
+    it->quantity_ += theOffer.GetAmountAvailable();
+}
+
+void OTOrderBook::Filled(const OTOffer& theOffer, const int64_t& lAmount)
+{
+    if (theOffer.IsMarketOrder()) return;
+
+    auto it = find_level(theOffer.GetPriceLimit());
+
+    if ((levels_.end() == it) || (it->price_ != theOffer.GetPriceLimit())) {
+        return;
+    }
+
+    it->quantity_ -= lAmount;
+}
+
+bool OTOrderBook::Remove(const OTOffer& theOffer)
+{
+    dequeOfOffers* pOffers = &market_orders_;
+    auto itLevel = levels_.end();
+
+    if (!theOffer.IsMarketOrder()) {
+        itLevel = find_level(theOffer.GetPriceLimit());
+
+        if ((levels_.end() == itLevel) ||
+            (itLevel->price_ != theOffer.GetPriceLimit())) {
+            return false;
+        }
+
+        pOffers = &itLevel->offers_;
+    }
+
+    auto it = std::find(pOffers->begin(), pOffers->end(), &theOffer);
+
+    if (pOffers->end() == it) return false;
+
+    pOffers->erase(it);
+    count_--;
+
+    if (levels_.end() != itLevel) {
+        itLevel->quantity_ -= theOffer.GetAmountAvailable();
+
+        if (itLevel->offers_.empty()) levels_.erase(itLevel);
+    }
+
+    return true;
+}
+
+void OTOrderBook::Release()
+{
+    levels_.clear();
+    market_orders_.clear();
+    count_ = 0;
+}
+
+} // namespace opentxs
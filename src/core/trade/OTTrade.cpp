@@ -526,6 +526,7 @@ OTOffer* OTTrade::GetOffer(Identifier* offerMarketId, OTMarket** market)
             offer_->SignContract(*(GetCron()->GetServerNym()));
             offer_->SaveContract();
 
+            pMarket->OfferChanged(*offer_);
             pMarket->SaveMarket();
 
             // Now when the market loads next time, it can verify this offer
@@ -593,6 +594,7 @@ OTOffer* OTTrade::GetOffer(Identifier* offerMarketId, OTMarket** market)
                 offer_->SignContract(*(GetCron()->GetServerNym()));
                 offer_->SaveContract();
 
+                pMarket->OfferChanged(*offer_);
                 pMarket->SaveMarket();
 
                 // Now when the market loads next time, it can verify this offer
@@ -1156,6 +1158,43 @@ bool OTTrade::ProcessCron()
                           // removing it for a reason.
 }
 
+// Once its offer is resting on a market, a trade can't match until something
+// on that market changes, and OTCron wakes it when that happens. Until then it
+// only has to notice its own expiry, though it is still visited once a day.
+time64_t OTTrade::GetNextWakeTime() const
+{
+    const time64_t tNext = ot_super::GetNextWakeTime();
+
+    if (IsFlaggedForRemoval() || (nullptr == offer_) ||
+        (OT_TIME_ZERO == GetLastProcessDate()))
+        return tNext;
+
+    time64_t tWake = OTTimeAddTimeInterval(
+        GetLastProcessDate(),
+        OTTimeGetSecondsFromTime(OT_TIME_DAY_IN_SECONDS));
+
+    if ((GetValidTo() > OT_TIME_ZERO) && (GetValidTo() < tWake))
+        tWake = GetValidTo();
+
+    return (tWake > tNext) ? tWake : tNext;
+}
+
+// The counterparties are found through the market, and OTCron adds the
+// resources of every trade resting on it.
+bool OTTrade::GetCronResources(std::set<std::string>& output) const
+{
+    const String strAssetAcct(GetSenderAcctID()), strNym(GetSenderNymID()),
+        strCurrencyAcct(currencyAcctID_);
+
+    output.insert(strAssetAcct.Get());
+    output.insert(strNym.Get());
+    output.insert(strCurrencyAcct.Get());
+    output.insert(
+        OTCron::MarketResource(GetInstrumentDefinitionID(), currencyTypeID_));
+
+    return true;
+}
+
 /*
 X OTIdentifier    currencyTypeID_;    // GOLD (Asset) is trading for DOLLARS
 (Currency).
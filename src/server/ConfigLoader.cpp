@@ -144,6 +144,32 @@ bool ConfigLoader::load(String& walletFilename)
         OTCron::SetCronMaxItemsPerNym(static_cast<int32_t>(lValue));
     }
 
+    {
+        const char* szComment = "; max_threads is the number of threads "
+                                "cron uses to process items which share\n"
+                                "; no accounts, Nyms or markets. 1 processes "
+                                "every item on the cron thread itself.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cron", "max_threads", 4, lValue,
+                                bIsNewKey, szComment);
+        OTCron::SetCronMaxThreads(static_cast<int32_t>(lValue));
+    }
+
+    {
+        const char* szComment = "; market_snapshot_interval is the number of "
+                                "changes a market journals before\n"
+                                "; the whole market is re-signed and saved "
+                                "again.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cron", "market_snapshot_interval",
+                                1000, lValue, bIsNewKey, szComment);
+        OTCron::SetCronMarketSnapshotInterval(static_cast<int32_t>(lValue));
+    }
+
     // HEARTBEAT
 
     {
@@ -177,6 +203,101 @@ bool ConfigLoader::load(String& walletFilename)
             static_cast<int32_t>(lValue));
     }
 
+    // WORKERS
+
+    {
+        const char* szComment = ";; WORKERS\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("workers", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; threads is the number of client requests "
+                                "the server processes in parallel.\n"
+                                "; Cron always runs on its own thread in "
+                                "addition to these.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("workers", "threads", 4, lValue,
+                                bIsNewKey, szComment);
+
+        if (1 > lValue) { lValue = 1; }
+
+        ServerSettings::SetWorkerThreads(static_cast<int32_t>(lValue));
+    }
+
+    // TRANSACTION NUMBERS
+
+    {
+        const char* szComment = ";; TRANSACTION NUMBERS\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("transaction_numbers", szComment,
+                                           bSectionExist);
+    }
+
+    {
+        const char* szComment = "; block is how many transaction numbers the "
+                                "server reserves each time it saves the "
+                                "notary file.\n"
+                                "; Numbers left over from a block are skipped "
+                                "after a restart.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("transaction_numbers", "block", 100,
+                                         lValue, bIsNewKey, szComment);
+
+        if (1 > lValue) { lValue = 1; }
+
+        ServerSettings::SetTransactionNumberBlock(lValue);
+    }
+
+    // CACHE
+
+    {
+        const char* szComment = ";; CACHE\n";
+
+        bool bSectionExist;
+        App::Me().Config().CheckSetSection("cache", szComment, bSectionExist);
+    }
+
+    {
+        const char* szComment = "; nyms is how many client Nyms the server "
+                                "keeps loaded and verified between\n"
+                                "; requests. 0 loads every Nym from disk on "
+                                "every request.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cache", "nyms", 1000, lValue,
+                                         bIsNewKey, szComment);
+
+        if (0 > lValue) { lValue = 0; }
+
+        ServerSettings::SetNymCacheSize(lValue);
+    }
+
+    {
+        const char* szComment = "; working_set_mb is how many megabytes of "
+                                "accounts, boxes and box receipts\n"
+                                "; the server keeps in memory. Files saved "
+                                "during a request are written\n"
+                                "; together when it finishes. 0 turns this "
+                                "off.\n";
+
+        bool bIsNewKey;
+        int64_t lValue;
+        App::Me().Config().CheckSet_long("cache", "working_set_mb", 64,
+                                         lValue, bIsNewKey, szComment);
+
+        if (0 > lValue) { lValue = 0; }
+
+        ServerSettings::SetWorkingSetSize(lValue);
+    }
+
     // PERMISSIONS
 
     {
@@ -357,6 +478,8 @@ bool ConfigLoader::load(String& walletFilename)
                              ServerSettings::__transact_smart_contract);
     App::Me().Config().SetOption_bool("permissions", "cmd_trigger_clause",
                              ServerSettings::__cmd_trigger_clause);
+    App::Me().Config().SetOption_bool("permissions", "cmd_get_command_stats",
+                             ServerSettings::__cmd_get_command_stats);
 
     // Done Loading... Lets save any changes...
     if (!App::Me().Config().Save()) {
@@ -0,0 +1,131 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/server/LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace opentxs
+{
+
+const std::size_t LatencyHistogram::Buckets;
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0)
+    , total_(0)
+    , max_(0)
+{
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Record(uint64_t microseconds)
+{
+    std::size_t bucket = 0;
+
+    for (uint64_t value = microseconds; 0 != value; value >>= 1) {
+        ++bucket;
+    }
+
+    if (bucket >= Buckets) {
+        bucket = Buckets - 1;
+    }
+
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(microseconds, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+
+    while ((microseconds > max) &&
+           !max_.compare_exchange_weak(max, microseconds,
+                                       std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::Bucket(std::size_t bucket) const
+{
+    if (bucket >= Buckets) {
+        return 0;
+    }
+
+    return buckets_[bucket].load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::UpperBound(std::size_t bucket)
+{
+    if (0 == bucket) {
+        return 0;
+    }
+
+    if (bucket >= Buckets - 1) {
+        return UINT64_MAX;
+    }
+
+    return (uint64_t(1) << bucket) - 1;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const
+{
+    const uint64_t count = Count();
+
+    if (0 == count) {
+        return 0;
+    }
+
+    const uint64_t target = static_cast<uint64_t>(
+        std::ceil(fraction * static_cast<double>(count)));
+    uint64_t seen = 0;
+
+    for (std::size_t bucket = 0; bucket < Buckets; ++bucket) {
+        seen += Bucket(bucket);
+
+        if (seen >= target) {
+            return std::min(UpperBound(bucket), Max());
+        }
+    }
+
+    return Max();
+}
+
+} // namespace opentxs
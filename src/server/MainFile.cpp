@@ -83,7 +83,7 @@ bool MainFile::SaveMainFileToString(String& strMainFile)
     tag.add_attribute("notaryID", server_->m_strNotaryID.Get());
     tag.add_attribute("serverNymID", server_->m_strServerNymID.Get());
     tag.add_attribute("transactionNum",
-                      formatLong(server_->transactor_.transactionNumber()));
+                      formatLong(server_->transactor_.transactionNumberLease()));
 
     if (OTCachedKey::It()->IsGenerated()) // If it exists, then serialize it.
     {
@@ -42,11 +42,13 @@
 #include "opentxs/core/Message.hpp"
 #include "opentxs/core/Nym.hpp"
 #include "opentxs/core/String.hpp"
-#include "opentxs/core/crypto/OTASCIIArmor.hpp"
+#include "opentxs/core/WorkingSet.hpp"
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/server/ClientConnection.hpp"
 #include "opentxs/server/OTServer.hpp"
+#include "opentxs/server/RequestLocks.hpp"
 #include "opentxs/server/ServerLoader.hpp"
+#include "opentxs/server/ServerSettings.hpp"
 #include "opentxs/server/UserCommandProcessor.hpp"
 
 #include <czmq.h>
@@ -55,32 +57,49 @@
 #include <zactor.h>
 #include <zauth.h>
 #include <zcert.h>
+#include <zframe.h>
+#include <zmsg.h>
 #include <zpoller.h>
 #include <zsock.h>
 #include <zsock_option.h>
 #include <zstr.h>
 #include <zsys.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <ostream>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
+
+#define OT_SERVER_WORKER_ENDPOINT "inproc://opentxs/server/workers"
+#define OT_SERVER_POLL_MILLISECONDS 100
 
 namespace opentxs
 {
 
 MessageProcessor::MessageProcessor(ServerLoader& loader)
     : server_(loader.getServer())
-    , zmqSocket_(zsock_new_rep(NULL))
+    , zmqFrontend_(zsock_new_router(NULL))
+    , zmqBackend_(zsock_new_dealer("@" OT_SERVER_WORKER_ENDPOINT))
     , zmqAuth_(zactor_new(zauth, NULL))
-    , zmqPoller_(zpoller_new(zmqSocket_, NULL))
+    , zmqPoller_(zpoller_new(zmqFrontend_, zmqBackend_, NULL))
+    , locks_()
+    , running_(false)
 {
     init(loader.getPort(), loader.getTransportKey());
 }
 
 MessageProcessor::~MessageProcessor()
 {
-    zpoller_remove(zmqPoller_, zmqSocket_);
+    zpoller_remove(zmqPoller_, zmqBackend_);
+    zpoller_remove(zmqPoller_, zmqFrontend_);
     zpoller_destroy(&zmqPoller_);
     zactor_destroy(&zmqAuth_);
-    zsock_destroy(&zmqSocket_);
+    zsock_destroy(&zmqBackend_);
+    zsock_destroy(&zmqFrontend_);
 }
 
 void MessageProcessor::init(int port, zcert_t* transportKey)
@@ -94,29 +113,45 @@ void MessageProcessor::init(int port, zcert_t* transportKey)
     }
     zstr_sendx(zmqAuth_, "CURVE", CURVE_ALLOW_ANY, NULL);
     zsock_wait(zmqAuth_);
-    zsock_set_zap_domain(zmqSocket_, "global");
-    zsock_set_curve_server(zmqSocket_, 1);
-    zcert_apply(transportKey, zmqSocket_);
+    zsock_set_zap_domain(zmqFrontend_, "global");
+    zsock_set_curve_server(zmqFrontend_, 1);
+    zcert_apply(transportKey, zmqFrontend_);
     zcert_destroy(&transportKey);
-    zsock_bind(zmqSocket_, "tcp://*:%d", port);
+    zsock_bind(zmqFrontend_, "tcp://*:%d", port);
 }
 
 void MessageProcessor::run()
 {
+    running_.store(true);
+
+    std::thread cron(&MessageProcessor::runCron, this);
+    std::vector<std::thread> workers;
+    const int32_t workerCount =
+        std::max(ServerSettings::GetWorkerThreads(), static_cast<int32_t>(1));
+
+    for (int32_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&MessageProcessor::runWorker, this);
+    }
+
+    Log::vOutput(0, "MessageProcessor: processing requests on %d worker "
+                    "threads.\n", workerCount);
+
+    // Shuttle requests from clients to idle workers, and replies from workers
+    // back to the originating client. The ROUTER and DEALER sockets keep
+    // track of the envelopes.
     for (;;) {
-        // timeout is the time left until the next cron should execute.
-        int64_t timeout = server_->computeTimeout();
-        if (timeout <= 0) {
-            server_->ProcessCron();
+        void* socket = zpoller_wait(zmqPoller_, -1);
+
+        if (zmqFrontend_ == socket) {
+            forward(zmqFrontend_, zmqBackend_);
             continue;
         }
 
-        // wait for incoming message or up to timeout,
-        // i.e. stop polling in time for the next cron execution.
-        if (zpoller_wait(zmqPoller_, timeout)) {
-            processSocket();
+        if (zmqBackend_ == socket) {
+            forward(zmqBackend_, zmqFrontend_);
             continue;
         }
+
         if (zpoller_terminated(zmqPoller_)) {
             otErr << __FUNCTION__
                   << ": zpoller_terminated - process interrupted or"
@@ -124,33 +159,111 @@ void MessageProcessor::run()
             break;
         }
 
-        if (!zpoller_expired(zmqPoller_)) {
-            otErr << __FUNCTION__ << ": zpoller_wait error\n";
+        otErr << __FUNCTION__ << ": zpoller_wait error\n";
+    }
+
+    running_.store(false);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    cron.join();
+}
+
+void MessageProcessor::forward(zsock_t* from, zsock_t* to)
+{
+    zmsg_t* msg = zmsg_recv(from);
+
+    if (nullptr == msg) {
+        Log::Error("zeromq recv() failed\n");
+        return;
+    }
+
+    if (0 != zmsg_send(&msg, to)) {
+        Log::Error("MessageProcessor: failed to forward message\n");
+        zmsg_destroy(&msg);
+    }
+}
+
+void MessageProcessor::runCron()
+{
+    while (running_.load()) {
+        int64_t timeout = 0;
+
+        {
+            // Cron may touch any account or Nymfile on the server, so it
+            // waits for in-flight requests to drain and runs alone.
+            RequestLocks::Lock exclusive(locks_);
+            timeout = server_->computeTimeout();
+
+            if (0 >= timeout) {
+                server_->ProcessCron();
+                timeout = server_->computeTimeout();
+            }
         }
 
-        Log::Sleep(std::chrono::milliseconds(100));
+        timeout = std::max(timeout, static_cast<int64_t>(
+                                        OT_SERVER_POLL_MILLISECONDS));
+        const auto wake = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(timeout);
+
+        // Sleep in short increments so shutdown is not delayed by the full
+        // cron interval.
+        while (running_.load() && (std::chrono::steady_clock::now() < wake)) {
+            Log::Sleep(std::chrono::milliseconds(OT_SERVER_POLL_MILLISECONDS));
+        }
     }
 }
 
-void MessageProcessor::processSocket()
+void MessageProcessor::runWorker()
 {
-    char* msg = zstr_recv(zmqSocket_);
-    if (msg == nullptr) {
+    zsock_t* socket = zsock_new_rep(">" OT_SERVER_WORKER_ENDPOINT);
+    zpoller_t* poller = zpoller_new(socket, NULL);
+
+    OT_ASSERT(nullptr != socket);
+    OT_ASSERT(nullptr != poller);
+
+    while (running_.load()) {
+        if (nullptr != zpoller_wait(poller, OT_SERVER_POLL_MILLISECONDS)) {
+            processSocket(socket);
+            continue;
+        }
+
+        if (zpoller_terminated(poller)) {
+            break;
+        }
+    }
+
+    zpoller_remove(poller, socket);
+    zpoller_destroy(&poller);
+    zsock_destroy(&socket);
+}
+
+void MessageProcessor::processSocket(zsock_t* socket)
+{
+    // Frames rather than C strings, since a binary request may hold zeros.
+    zframe_t* request = zframe_recv(socket);
+    if (request == nullptr) {
         Log::Error("zeromq recv() failed\n");
         return;
     }
-    std::string requestString(msg);
-    zstr_free(&msg);
+    std::string requestString(
+        reinterpret_cast<const char*>(zframe_data(request)),
+        zframe_size(request));
+    zframe_destroy(&request);
 
     std::string responseString;
 
     bool error = processMessage(requestString, responseString);
 
     if (error) {
-        responseString = "";
+        responseString = Message::WireErrorReply(requestString);
     }
 
-    int rc = zstr_send(zmqSocket_, responseString.c_str());
+    zframe_t* response =
+        zframe_new(responseString.data(), responseString.size());
+    int rc = zframe_send(&response, socket, 0);
 
     if (rc != 0) {
         Log::vError("MessageProcessor: failed to send response\n"
@@ -160,30 +273,81 @@ void MessageProcessor::processSocket()
     }
 }
 
+bool MessageProcessor::isSharedCommand(const Message& message)
+{
+    // Everything not listed here (notarizeTransaction, processInbox,
+    // triggerClause, Nym, account and contract registration, etc) may write
+    // to accounts, Nymfiles or notary-wide state which can not be
+    // determined from the request, and therefore runs exclusively.
+    //
+    // sendNymMessage, sendNymInstrument and processNymbox issue transaction
+    // numbers and sign with the server Nym, so they rely on
+    // Transactor::issueNextTransactionNumber and the private key being
+    // safe to use from several threads at once.
+    static const std::set<std::string> shared = {
+        "pingNotary",
+        "getRequestNumber",
+        "checkNym",
+        "sendNymMessage",
+        "sendNymInstrument",
+        "getNymbox",
+        "getBoxReceipt",
+        "getAccountData",
+        "processNymbox",
+        "queryInstrumentDefinitions",
+        "getInstrumentDefinition",
+        "getMint",
+        "getMarketList",
+        "getMarketOffers",
+        "getMarketRecentTrades",
+        "getNymMarketOffers",
+        "usageCredits",
+        "getCommandStats"};
+
+    return (shared.count(message.m_strCommand.Get()) > 0);
+}
+
+RequestLocks::Keys MessageProcessor::requestKeys(const Message& message)
+{
+    RequestLocks::Keys keys;
+
+    // The sender, the recipient (sendNymMessage, usageCredits, etc) and the
+    // account the request refers to
+    for (auto& id :
+         {&message.m_strNymID, &message.m_strNymID2, &message.m_strAcctID}) {
+        if (id->Exists()) {
+            keys.insert(id->Get());
+        }
+    }
+
+    return keys;
+}
+
 bool MessageProcessor::processMessage(const std::string& messageString,
                                       std::string& reply)
 {
     if (messageString.size() < 1) return false;
 
-    // First we grab the client's message
-    OTASCIIArmor ascMessage;
-    ascMessage.MemSet(messageString.data(), messageString.size());
+    if (Message::IsWireProbe(messageString)) {
+        reply = Message::WireProbeReply();
 
-    String messageContents;
-    ascMessage.GetString(messageContents);
-    // All decrypted--now let's load the results into an OTMessage.
-    // No need to call message.ParseRawFile() after, since
-    // LoadContractFromString handles it.
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Armored XML from older clients, or a binary envelope.
     Message message;
-    if (!messageContents.Exists() ||
-        !message.LoadContractFromString(messageContents)) {
-        Log::vError("Error loading message from message "
-                    "contents:\n\n%s\n\n",
-                    messageContents.Get());
+    if (!message.LoadWire(messageString)) {
+        Log::vError("Error loading message from %zu bytes of message "
+                    "contents.\n",
+                    messageString.size());
         return true;
     }
 
     Message replyMessage;
+    // The reply goes back in the encoding the client used.
+    replyMessage.SetEncoding(message.Encoding());
     replyMessage.m_strCommand.Format("%sResponse", message.m_strCommand.Get());
     // NymID
     replyMessage.m_strNymID = message.m_strNymID;
@@ -193,10 +357,21 @@ bool MessageProcessor::processMessage(const std::string& messageString,
     replyMessage.m_bSuccess = false;
 
     ClientConnection client;
-    Nym nym(message.m_strNymID);
+
+    std::unique_ptr<RequestLocks::Lock> lock;
+
+    if (isSharedCommand(message)) {
+        lock.reset(new RequestLocks::Lock(locks_, requestKeys(message)));
+    } else {
+        lock.reset(new RequestLocks::Lock(locks_));
+    }
+
+    // Whatever the request saved is held back until the request ends, and
+    // must be written out before its locks are released.
+    std::unique_ptr<WorkingSet::Request> workingSet(new WorkingSet::Request);
 
     bool processedUserCmd = server_->userCommandProcessor_.ProcessUserCommand(
-        message, replyMessage, &client, &nym);
+        message, replyMessage, &client, nullptr);
 
     // By optionally passing in &client, the client Nym's public
     // key will be set on it whenever verification is complete. (So
@@ -243,25 +418,23 @@ bool MessageProcessor::processMessage(const std::string& messageString,
                      message.m_strCommand.Get());
     }
 
-    String replyString(replyMessage);
+    workingSet.reset();
+    lock.reset();
 
-    if (!replyString.Exists()) {
-        Log::vOutput(0, "Failed trying to grab the reply "
-                        "in OTString form. "
+    if (!replyMessage.SaveWire(reply)) {
+        Log::vOutput(0, "Failed trying to encode the reply. "
                         "(No reply message will be sent.)\n");
         return true;
     }
 
-    OTASCIIArmor ascReply(replyString);
-
-    if (!ascReply.Exists()) {
-        Log::vOutput(0, "Unable to WriteArmoredString from "
-                        "OTASCIIArmor object into OTString object. (No reply "
-                        "message will be sent.)\n");
-        return true;
-    }
-
-    reply.assign(ascReply.Get(), ascReply.GetLength());
+    server_->userCommandProcessor_.RecordWire(
+        message.Encoding(),
+        messageString.size(),
+        reply.size(),
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count()));
 
     return false;
 }
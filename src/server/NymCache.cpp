@@ -0,0 +1,214 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/server/NymCache.hpp"
+
+#include "opentxs/core/Log.hpp"
+#include "opentxs/core/Nym.hpp"
+#include "opentxs/core/String.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace opentxs
+{
+
+NymCache::Entry::Entry(const String& nymID)
+    : nym_(nymID)
+    , loaded_(false)
+    , stale_(false)
+{
+}
+
+NymCache::Lock::Lock(NymCache& cache, const std::string& nymID,
+                     const std::shared_ptr<Entry>& entry)
+    : cache_(cache)
+    , nymID_(nymID)
+    , entry_(entry)
+    , lock_(entry->lock_)
+{
+}
+
+void NymCache::Lock::Loaded()
+{
+    entry_->saved_.Release();
+    entry_->nym_.SavePseudonym(entry_->saved_);
+    entry_->loaded_ = true;
+}
+
+NymCache::Lock::~Lock()
+{
+    // A request that changed the Nym without saving it leaves a copy that no
+    // longer matches the nymfile, so the next request has to load it again.
+    if (entry_->loaded_ && !entry_->stale_) {
+        String current;
+        entry_->nym_.SavePseudonym(current);
+
+        if (!current.Compare(entry_->saved_)) {
+            entry_->stale_ = true;
+            ++cache_.invalidations_;
+        }
+    }
+
+    if (!entry_->loaded_ || entry_->stale_) {
+        cache_.erase(nymID_, entry_);
+    }
+}
+
+NymCache::NymCache(std::size_t capacity)
+    : capacity_(capacity)
+    , hits_(0)
+    , misses_(0)
+    , evictions_(0)
+    , invalidations_(0)
+{
+    Nym::SetNymfileSavedCallback(
+        [this](const Nym& nym, const String& contents) {
+            Saved(nym, contents);
+        });
+}
+
+NymCache::~NymCache()
+{
+    Nym::SetNymfileSavedCallback(nullptr);
+
+    otInfo << "NymCache: " << hits_ << " hits, " << misses_ << " misses, "
+           << evictions_ << " evictions, " << invalidations_
+           << " invalidations.\n";
+}
+
+std::unique_ptr<NymCache::Lock> NymCache::Get(const String& nymID)
+{
+    const std::string id = nymID.Get();
+    std::shared_ptr<Entry> entry;
+
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        auto it = nyms_.find(id);
+
+        if (nyms_.end() != it) {
+            entry = it->second;
+            lru_.splice(lru_.begin(), lru_, entry->lru_);
+        } else {
+            entry = std::make_shared<Entry>(nymID);
+
+            if (0 < capacity_) {
+                lru_.push_front(id);
+                entry->lru_ = lru_.begin();
+                nyms_[id] = entry;
+
+                while (nyms_.size() > capacity_) {
+                    // Whoever is still using an evicted entry keeps it
+                    // until the end of their request.
+                    nyms_.erase(lru_.back());
+                    lru_.pop_back();
+                    ++evictions_;
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<Lock> output(new Lock(*this, id, entry));
+
+    if (entry->loaded_) {
+        ++hits_;
+    } else {
+        ++misses_;
+    }
+
+    return output;
+}
+
+void NymCache::Invalidate(const String& nymID)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = nyms_.find(nymID.Get());
+
+    if (nyms_.end() == it) {
+        return;
+    }
+
+    it->second->stale_ = true;
+    lru_.erase(it->second->lru_);
+    nyms_.erase(it);
+    ++invalidations_;
+}
+
+void NymCache::Saved(const Nym& nym, const String& contents)
+{
+    const String nymID(nym.GetConstID());
+
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = nyms_.find(nymID.Get());
+
+    if (nyms_.end() == it) {
+        return;
+    }
+
+    auto& entry = it->second;
+
+    if (&entry->nym_ == &nym) {
+        // Only the request holding the entry saves through it, so the
+        // snapshot can be updated in place.
+        entry->saved_ = contents;
+    } else {
+        entry->stale_ = true;
+        lru_.erase(entry->lru_);
+        nyms_.erase(it);
+        ++invalidations_;
+    }
+}
+
+void NymCache::erase(const std::string& nymID,
+                     const std::shared_ptr<Entry>& entry)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    auto it = nyms_.find(nymID);
+
+    if ((nyms_.end() != it) && (it->second == entry)) {
+        lru_.erase(entry->lru_);
+        nyms_.erase(it);
+    }
+}
+
+} // namespace opentxs
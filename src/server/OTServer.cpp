@@ -46,6 +46,7 @@
 #include "opentxs/core/OTStorage.hpp"
 #include "opentxs/core/OTTransaction.hpp"
 #include "opentxs/core/String.hpp"
+#include "opentxs/core/WorkingSet.hpp"
 #include "opentxs/core/app/App.hpp"
 #include "opentxs/core/app/Settings.hpp"
 #include "opentxs/core/cron/OTCron.hpp"
@@ -57,12 +58,14 @@
 #include "opentxs/core/util/OTPaths.hpp"
 #include "opentxs/ext/OTPayment.hpp"
 #include "opentxs/server/ConfigLoader.hpp"
+#include "opentxs/server/ServerSettings.hpp"
 #include "opentxs/server/Transactor.hpp"
 
 #include <czmq.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <sys/types.h>
+#include <cstddef>
 #include <fstream>
 #include <string>
 
@@ -146,6 +149,12 @@ OTServer::OTServer()
 
 OTServer::~OTServer()
 {
+    // Markets keep a journal of their changes between snapshots. Saving a
+    // snapshot of each one now means the next start has nothing to replay.
+    if (!m_bReadOnly && m_Cron.IsActivated()) m_Cron.SnapshotMarkets();
+
+    WorkingSet::Stop();
+
     // PID -- Set it to 0 in the lock file so the next time we run OT, it knows
     // there isn't
     // another copy already running (otherwise we might wind up with two copies
@@ -409,6 +418,11 @@ void OTServer::Init(std::map<std::string, std::string>& args, bool readOnly)
         OT_FAIL;
     }
 
+    userCommandProcessor_.Init();
+    WorkingSet::Start(
+        static_cast<std::size_t>(ServerSettings::GetWorkingSetSize()) *
+        1024 * 1024);
+
     String dataPath;
     bool bGetDataFolderSuccess = OTDataFolder::Get(dataPath);
 
@@ -0,0 +1,134 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/server/RequestLocks.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace opentxs
+{
+
+RequestLocks::Lock::Lock(RequestLocks& parent, const Keys& keys)
+    : parent_(parent)
+    , keys_(keys)
+    , exclusive_(false)
+{
+    parent_.Acquire(keys_);
+}
+
+RequestLocks::Lock::Lock(RequestLocks& parent)
+    : parent_(parent)
+    , keys_()
+    , exclusive_(true)
+{
+    parent_.AcquireExclusive();
+}
+
+RequestLocks::Lock::~Lock()
+{
+    if (exclusive_) {
+        parent_.ReleaseExclusive();
+    } else {
+        parent_.Release(keys_);
+    }
+}
+
+void RequestLocks::Acquire(const Keys& keys)
+{
+    std::unique_lock<std::mutex> lock(lock_);
+
+    // Pending exclusive requests take priority so that cron can not be
+    // starved by a steady stream of client requests.
+    released_.wait(lock, [&] {
+        return (!exclusive_) && (0 == waiting_exclusive_) && Available(keys);
+    });
+
+    held_.insert(keys.begin(), keys.end());
+    ++active_;
+}
+
+void RequestLocks::AcquireExclusive()
+{
+    std::unique_lock<std::mutex> lock(lock_);
+    ++waiting_exclusive_;
+    released_.wait(lock, [&] { return (!exclusive_) && (0 == active_); });
+    --waiting_exclusive_;
+    exclusive_ = true;
+}
+
+bool RequestLocks::Available(const Keys& keys) const
+{
+    for (auto& key : keys) {
+        if (held_.count(key) > 0) {
+
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void RequestLocks::Release(const Keys& keys)
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+
+        for (auto& key : keys) {
+            held_.erase(key);
+        }
+
+        --active_;
+    }
+
+    released_.notify_all();
+}
+
+void RequestLocks::ReleaseExclusive()
+{
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        exclusive_ = false;
+    }
+
+    released_.notify_all();
+}
+
+} // namespace opentxs
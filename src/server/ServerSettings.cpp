@@ -52,6 +52,14 @@ int64_t ServerSettings::__min_market_scale = 1;
 int32_t ServerSettings::__heartbeat_no_requests = 10;
 // number of ms between each heartbeat.
 int32_t ServerSettings::__heartbeat_ms_between_beats = 100;
+// The number of threads processing client requests in parallel.
+int32_t ServerSettings::__worker_threads = 4;
+// How many transaction numbers are reserved in the notary file at once.
+int64_t ServerSettings::__transaction_number_block = 100;
+// How many client Nyms are kept loaded between requests.
+int64_t ServerSettings::__nym_cache_size = 1000;
+// Megabytes of account and box files kept in memory.
+int64_t ServerSettings::__working_set_size = 64;
 // The Nym who's allowed to do certain
 // commands even if they are turned off.
 std::string ServerSettings::__override_nym_id;
@@ -104,6 +112,7 @@ bool ServerSettings::__transact_payment_plan = true;
 bool ServerSettings::__transact_cancel_cron_item = true;
 bool ServerSettings::__transact_smart_contract = true;
 bool ServerSettings::__cmd_trigger_clause = true;
+bool ServerSettings::__cmd_get_command_stats = false;
 
 // Todo: Might set ALL of these to false (so you're FORCED to set them true
 // in the server.cfg file.) This way you're also assured that the right data
@@ -0,0 +1,83 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/server/TransactionNumberLease.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace opentxs
+{
+
+TransactionNumberLease::TransactionNumberLease(const SaveLease& save)
+    : save_(save)
+    , last_(0)
+    , lease_(0)
+{
+}
+
+bool TransactionNumberLease::Next(int64_t blockSize, int64_t& number)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (last_ >= lease_) {
+        const int64_t oldLease = lease_;
+        lease_ = last_ + ((1 > blockSize) ? 1 : blockSize);
+
+        if (!save_()) {
+            lease_ = oldLease;
+
+            return false;
+        }
+    }
+
+    number = ++last_;
+
+    return true;
+}
+
+void TransactionNumberLease::Reset(int64_t lease)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    last_ = lease;
+    lease_ = lease;
+}
+
+} // namespace opentxs
@@ -49,6 +49,7 @@
 #include "opentxs/core/util/OTFolders.hpp"
 #include "opentxs/server/MainFile.hpp"
 #include "opentxs/server/OTServer.hpp"
+#include "opentxs/server/ServerSettings.hpp"
 
 #include <inttypes.h>
 #include <stdint.h>
@@ -61,7 +62,8 @@ namespace opentxs
 {
 
 Transactor::Transactor(OTServer* server)
-    : transactionNumber_(0)
+    : transactionNumbers_(
+          [server]() { return server->mainFile_.SaveMainFile(); })
     , server_(server)
 {
 }
@@ -88,22 +90,16 @@ Transactor::~Transactor()
 /// can be used in transaction requests.
 bool Transactor::issueNextTransactionNumber(int64_t& lTransactionNumber)
 {
-    // transactionNumber_ stores the last VALID AND ISSUED transaction number.
-    // So first, we increment that, since we don't want to issue the same number
-    // twice.
-    transactionNumber_++;
-
-    // Next, we save it to file.
-    if (!server_->mainFile_.SaveMainFile()) {
+    // The notary file stores a lease rather than the last number issued: a
+    // number at or beyond it, up to which numbers may be issued without
+    // saving. When the lease runs out, a new block is reserved and saved to
+    // file BEFORE any number from it is handed out.
+    if (!transactionNumbers_.Next(ServerSettings::GetTransactionNumberBlock(),
+                                  lTransactionNumber)) {
         Log::Error("Error saving main server file.\n");
-        transactionNumber_--;
         return false;
     }
 
-    // SUCCESS?
-    // Now the server main file has saved the latest transaction number,
-    // NOW we set it onto the parameter and return true.
-    lTransactionNumber = transactionNumber_;
     return true;
 }
 
@@ -136,20 +132,15 @@ bool Transactor::issueNextTransactionNumberToNym(Nym& theNym,
     // which
     // numbers are valid for each Nym.
     if (!pNym->AddTransactionNum(server_->m_nymServer, server_->m_strNotaryID,
-                                 transactionNumber_, true)) {
+                                 lTransactionNumber, true)) {
         Log::Error("Error adding transaction number to Nym file.\n");
-        transactionNumber_--;
-        server_->mainFile_.SaveMainFile(); // Save it back how it was, since
-                                           // we're not
-                                           // issuing this
-                                           // number after all.
+        // The number is simply skipped. (Other threads may have issued
+        // numbers after it, so it can't be handed back.)
         return false;
     }
 
     // SUCCESS?
-    // Now the server main file has saved the latest transaction number,
-    // NOW we set it onto the parameter and return true.
-    lTransactionNumber = transactionNumber_;
+    // lTransactionNumber was set above, and is now recorded for the Nym.
     return true;
 }
 
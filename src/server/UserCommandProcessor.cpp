@@ -65,31 +65,93 @@
 #include "opentxs/core/util/Assert.hpp"
 #include "opentxs/core/util/OTFolders.hpp"
 #include "opentxs/server/ClientConnection.hpp"
+#include "opentxs/server/LatencyHistogram.hpp"
 #include "opentxs/server/Macros.hpp"
 #include "opentxs/server/MainFile.hpp"
 #include "opentxs/server/Notary.hpp"
+#include "opentxs/server/NymCache.hpp"
 #include "opentxs/server/OTServer.hpp"
 #include "opentxs/server/ServerSettings.hpp"
 #include "opentxs/server/Transactor.hpp"
 
 #include <inttypes.h>
 #include <stdint.h>
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace opentxs
 {
 
 UserCommandProcessor::UserCommandProcessor(OTServer* server)
     : server_(server)
+    , nymCache_()
+    , latency_(Commands().size())
 {
 }
 
+void UserCommandProcessor::Init()
+{
+    const int64_t capacity = ServerSettings::GetNymCacheSize();
+
+    if (0 < capacity) {
+        nymCache_.reset(new NymCache(static_cast<std::size_t>(capacity)));
+    }
+}
+
+bool UserCommandProcessor::ProcessUserCommand(
+    Message& msgIn,
+    Message& msgOut,
+    ClientConnection* connection,
+    Nym* nym)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto id = CommandIDs().find(msgIn.m_strCommand.Get());
+    const Command* command =
+        (CommandIDs().end() == id) ? nullptr : &Commands()[id->second];
+
+    const bool processed =
+        processUserCommand(command, msgIn, msgOut, connection, nym);
+
+    if (nullptr != command) {
+        latency_[id->second].Record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count()));
+    }
+
+    return processed;
+}
+
+UserCommandProcessor::WireStats::WireStats()
+    : latency_()
+    , requestBytes_(0)
+    , replyBytes_(0)
+{
+}
+
+void UserCommandProcessor::RecordWire(
+    MessageEncoding encoding,
+    std::size_t requestBytes,
+    std::size_t replyBytes,
+    uint64_t microseconds)
+{
+    WireStats& stats = wire_[static_cast<std::size_t>(encoding)];
+
+    stats.requestBytes_.fetch_add(requestBytes, std::memory_order_relaxed);
+    stats.replyBytes_.fetch_add(replyBytes, std::memory_order_relaxed);
+    stats.latency_.Record(microseconds);
+}
+
 // this function will create the Nym if it's not passed in. We pass it in so the
 // caller has the option to query things about the Nym (like if it actually
 // exists.)
-bool UserCommandProcessor::ProcessUserCommand(
+bool UserCommandProcessor::processUserCommand(
+    const Command* pCommand,
     Message& theMessage,
     Message& msgOut,
     ClientConnection* pConnection,
@@ -160,6 +222,28 @@ bool UserCommandProcessor::ProcessUserCommand(
 
     if (bNymIsServerNym) pNym = &server_->m_nymServer;
 
+    // CACHED NYM
+    //
+    // A client that was loaded and verified on an earlier request can skip
+    // straight to the signature check. pingNotary and registerNym build the
+    // Nym from the message itself, so they always use a fresh one, and a
+    // registration may bring new credentials, so it drops the cached copy.
+    const bool bIsRegistration =
+        theMessage.m_strCommand.Compare("pingNotary") ||
+        theMessage.m_strCommand.Compare("registerNym");
+    std::unique_ptr<NymCache::Lock> cachedNym;
+
+    if (nymCache_ && !bNymIsServerNym && (&theNym == pNym)) {
+        if (bIsRegistration) {
+            nymCache_->Invalidate(theMessage.m_strNymID);
+        } else {
+            cachedNym = nymCache_->Get(theMessage.m_strNymID);
+            pNym = &cachedNym->It();
+        }
+    }
+
+    const bool bNymIsCached = cachedNym && cachedNym->IsLoaded();
+
     String strMsgNymID;
     pNym->GetIdentifier(strMsgNymID);
 
@@ -484,7 +568,7 @@ bool UserCommandProcessor::ProcessUserCommand(
     // If it is, then we read the public key from that Pseudonym and use it to
     // verify any
     // requests bearing that NymID.
-    if (!bNymIsServerNym &&
+    if (!bNymIsServerNym && !bNymIsCached &&
         (false == pNym->LoadPublicKey())  // && // Old style. (Deprecated, but
                                           // fine for now since it calls
                                           // LoadCredentials.)
@@ -507,7 +591,7 @@ bool UserCommandProcessor::ProcessUserCommand(
     // signature
     // on the message that we're processing.
 
-    if (!pNym->VerifyPseudonym()) {
+    if (!bNymIsCached && !pNym->VerifyPseudonym()) {
         Log::Output(
             0,
             "Pseudonym failed to verify. Hash of public key doesn't match "
@@ -538,10 +622,13 @@ bool UserCommandProcessor::ProcessUserCommand(
     // Now we might as well load up the rest of the Nym.
     // Notice I use the && to only load the nymfile if it's NOT the
     // server Nym.
-    if (!bNymIsServerNym && !pNym->LoadSignedNymfile(server_->m_nymServer)) {
+    if (!bNymIsServerNym && !bNymIsCached &&
+        !pNym->LoadSignedNymfile(server_->m_nymServer)) {
         Log::vError("Error loading Nymfile: %s\n", theMessage.m_strNymID.Get());
         return false;
     }
+
+    if (cachedNym && !bNymIsCached) cachedNym->Loaded();
     Log::Output(2, "Successfully loaded Nymfile into memory.\n");
 
     // ENTERING THE INNER SANCTUM OF SECURITY. If the user got all
@@ -939,336 +1026,299 @@ bool UserCommandProcessor::ProcessUserCommand(
                                        // msgOut.m_strNotaryID is already set.
                                        // (It uses it.)
 
-    if (theMessage.m_strCommand.Compare("getRequestNumber"))  // This command is
-    // special because it's
-    // the only one that
-    // doesn't require a
-    // request number.
-    // All of the other commands, below, will fail above if the proper
-    // request number isn't included
-    // in the message.  They will already have failed by this point if they
-    // didn't verify.
-    {
-        Log::vOutput(
-            0,
-            "\n==> Received a getRequestNumber message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_requestnumber);
-
-        UserCmdGetRequestNumber(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getTransactionNumbers")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getTransactionNumbers message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_trans_nums);
-
-        UserCmdGetTransactionNumbers(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("checkNym")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a checkNym message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_check_nym);
-
-        UserCmdCheckNym(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("sendNymMessage")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a sendNymMessage message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_send_message);
-
-        UserCmdSendNymMessage(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("sendNymInstrument")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a sendNymInstrument message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_send_message);
-
-        UserCmdSendNymInstrument(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("unregisterNym")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a unregisterNym message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_del_user_acct);
-
-        UserCmdDeleteUser(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("unregisterAccount")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a unregisterAccount message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_del_asset_acct);
-
-        UserCmdDeleteAssetAcct(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("registerAccount")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a registerAccount message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_create_asset_acct);
-
-        UserCmdRegisterAccount(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (
-        theMessage.m_strCommand.Compare("registerInstrumentDefinition")) {
-        Log::vOutput(
-            0,
-            "\n==> Received an registerInstrumentDefinition "
-            "message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_issue_asset);
-
-        UserCmdRegisterInstrumentDefinition(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("issueBasket")) {
-        Log::vOutput(
-            0,
-            "\n==> Received an issueBasket message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_issue_basket);
-
-        UserCmdIssueBasket(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("notarizeTransaction")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a notarizeTransaction message.  "
-            "Acct: %s Nym: %s  ...\n",
-            theMessage.m_strAcctID.Get(),
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_notarize_transaction);
-
-        UserCmdNotarizeTransaction(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getNymbox")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getNymbox message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_nymbox);
-
-        UserCmdGetNymbox(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getBoxReceipt")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getBoxReceipt message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        bool bRunIt = true;
-        if (0 == theMessage.m_lDepth)
-            OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_nymbox)
-        else if (1 == theMessage.m_lDepth)
-            OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_inbox)
-        else if (2 == theMessage.m_lDepth)
-            OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_outbox)
-        else
-            bRunIt = false;
+    if ((nullptr == pCommand) || (nullptr == pCommand->handler_)) {
+        Log::vError(
+            "Unknown command type in the XML, or missing payload, in "
+            "ProcessMessage.\n");
 
-        if (bRunIt) UserCmdGetBoxReceipt(theMessage, msgOut);
+        String strTemp;
+        strTemp.Format(
+            "%sResponse",
+            theMessage.m_strCommand.Get());  // Todo security.
+                                             // Review this.
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getAccountData")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getAccountData message.  Acct: %s "
-            "Nym: %s  ...\n",
-            theMessage.m_strAcctID.Get(),
-            strMsgNymID.Get());
+        msgOut.m_strCommand = strTemp;
+        msgOut.m_strAcctID = theMessage.m_strAcctID;
+        msgOut.m_strNotaryID = theMessage.m_strNotaryID;
+        msgOut.m_strNymID = theMessage.m_strNymID;
 
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_inbox);
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_outbox);
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_acct);
+        msgOut.m_bSuccess = false;
 
-        UserCmdGetAccountData(*pNym, theMessage, msgOut);
+        String strRef(theMessage);
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("processNymbox")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a processNymbox message. Nym: %s ...\n",
-            strMsgNymID.Get());
+        msgOut.m_ascInReferenceTo.SetString(strRef);
 
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_process_nymbox);
+        msgOut.SignContract(server_->m_nymServer);
+        msgOut.SaveContract();
 
-        UserCmdProcessNymbox(*pNym, theMessage, msgOut);
+        return false;
+    }
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("processInbox")) {
+    if (theMessage.m_strAcctID.Exists()) {
         Log::vOutput(
             0,
-            "\n==> Received a processInbox message. Acct: %s Nym: %s  ...\n",
+            "\n==> Received a %s message.  Acct: %s Nym: %s  ...\n",
+            pCommand->name_.c_str(),
             theMessage.m_strAcctID.Get(),
             strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_process_inbox);
-
-        UserCmdProcessInbox(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("queryInstrumentDefinitions")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a queryInstrumentDefinitions "
-            "message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_contract);
-
-        UserCmdQueryInstrumentDefinitions(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getInstrumentDefinition")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getInstrumentDefinition message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_contract);
-
-        UserCmdGetInstrumentDefinition(theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getMint")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getMint message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_mint);
-
-        UserCmdGetMint(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getMarketList")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getMarketList message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_market_list);
-
-        UserCmdGetMarketList(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getMarketOffers")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getMarketOffers message. Nym: %s ...\n",
-            strMsgNymID.Get());
-
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_market_offers);
-
-        UserCmdGetMarketOffers(*pNym, theMessage, msgOut);
-
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getMarketRecentTrades")) {
+    } else {
         Log::vOutput(
             0,
-            "\n==> Received a getMarketRecentTrades message. Nym: %s ...\n",
+            "\n==> Received a %s message. Nym: %s ...\n",
+            pCommand->name_.c_str(),
             strMsgNymID.Get());
+    }
 
-        OT_ENFORCE_PERMISSION_MSG(
-            ServerSettings::__cmd_get_market_recent_trades);
-
-        UserCmdGetMarketRecentTrades(*pNym, theMessage, msgOut);
+    for (const bool* pPermission : pCommand->permissions_) {
+        OT_ENFORCE_PERMISSION_MSG(*pPermission);
+    }
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("getNymMarketOffers")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a getNymMarketOffers message. Nym: %s ...\n",
-            strMsgNymID.Get());
+    if (nullptr != pCommand->permission_) {
+        const bool* pPermission = pCommand->permission_(theMessage);
 
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_get_nym_market_offers);
+        // Nothing to run for this request.
+        if (nullptr == pPermission) return true;
 
-        UserCmdGetNymMarketOffers(*pNym, theMessage, msgOut);
+        OT_ENFORCE_PERMISSION_MSG(*pPermission);
+    }
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("triggerClause")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a triggerClause message. Nym: %s ...\n",
-            strMsgNymID.Get());
+    (this->*(pCommand->handler_))(*pNym, theMessage, msgOut);
 
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_trigger_clause);
+    return true;
+}
 
-        UserCmdTriggerClause(*pNym, theMessage, msgOut);
+// The permission for getBoxReceipt depends on which box it's for.
+const bool* UserCommandProcessor::BoxReceiptPermission(const Message& msgIn)
+{
+    switch (msgIn.m_lDepth) {
+        case 0:
+            return &ServerSettings::__cmd_get_nymbox;
+        case 1:
+            return &ServerSettings::__cmd_get_inbox;
+        case 2:
+            return &ServerSettings::__cmd_get_outbox;
+        default:
+            return nullptr;
+    }
+}
 
-        return true;
-    } else if (theMessage.m_strCommand.Compare("usageCredits")) {
-        Log::vOutput(
-            0,
-            "\n==> Received a usageCredits message. Nym: %s ...\n",
-            strMsgNymID.Get());
+const std::vector<UserCommandProcessor::Command>& UserCommandProcessor::
+    Commands()
+{
+    // pingNotary and registerNym are handled before the Nym is verified, so
+    // they have no handler here. They're listed for their latency.
+    static const std::vector<Command> commands = {
+        {"pingNotary", nullptr, {}, nullptr},
+        {"registerNym", nullptr, {}, nullptr},
+        {"getRequestNumber",
+         &UserCommandProcessor::UserCmdGetRequestNumber,
+         {&ServerSettings::__cmd_get_requestnumber},
+         nullptr},
+        {"getTransactionNumbers",
+         &UserCommandProcessor::UserCmdGetTransactionNumbers,
+         {&ServerSettings::__cmd_get_trans_nums},
+         nullptr},
+        {"checkNym",
+         &UserCommandProcessor::UserCmdCheckNym,
+         {&ServerSettings::__cmd_check_nym},
+         nullptr},
+        {"sendNymMessage",
+         &UserCommandProcessor::UserCmdSendNymMessage,
+         {&ServerSettings::__cmd_send_message},
+         nullptr},
+        {"sendNymInstrument",
+         &UserCommandProcessor::UserCmdSendNymInstrument,
+         {&ServerSettings::__cmd_send_message},
+         nullptr},
+        {"unregisterNym",
+         &UserCommandProcessor::UserCmdDeleteUser,
+         {&ServerSettings::__cmd_del_user_acct},
+         nullptr},
+        {"unregisterAccount",
+         &UserCommandProcessor::UserCmdDeleteAssetAcct,
+         {&ServerSettings::__cmd_del_asset_acct},
+         nullptr},
+        {"registerAccount",
+         &UserCommandProcessor::UserCmdRegisterAccount,
+         {&ServerSettings::__cmd_create_asset_acct},
+         nullptr},
+        {"registerInstrumentDefinition",
+         &UserCommandProcessor::UserCmdRegisterInstrumentDefinition,
+         {&ServerSettings::__cmd_issue_asset},
+         nullptr},
+        {"issueBasket",
+         &UserCommandProcessor::UserCmdIssueBasket,
+         {&ServerSettings::__cmd_issue_basket},
+         nullptr},
+        {"notarizeTransaction",
+         &UserCommandProcessor::UserCmdNotarizeTransaction,
+         {&ServerSettings::__cmd_notarize_transaction},
+         nullptr},
+        {"getNymbox",
+         &UserCommandProcessor::UserCmdGetNymbox,
+         {&ServerSettings::__cmd_get_nymbox},
+         nullptr},
+        {"getBoxReceipt",
+         &UserCommandProcessor::UserCmdGetBoxReceipt,
+         {},
+         &UserCommandProcessor::BoxReceiptPermission},
+        {"getAccountData",
+         &UserCommandProcessor::UserCmdGetAccountData,
+         {&ServerSettings::__cmd_get_inbox,
+          &ServerSettings::__cmd_get_outbox,
+          &ServerSettings::__cmd_get_acct},
+         nullptr},
+        {"processNymbox",
+         &UserCommandProcessor::UserCmdProcessNymbox,
+         {&ServerSettings::__cmd_process_nymbox},
+         nullptr},
+        {"processInbox",
+         &UserCommandProcessor::UserCmdProcessInbox,
+         {&ServerSettings::__cmd_process_inbox},
+         nullptr},
+        {"queryInstrumentDefinitions",
+         &UserCommandProcessor::UserCmdQueryInstrumentDefinitions,
+         {&ServerSettings::__cmd_get_contract},
+         nullptr},
+        {"getInstrumentDefinition",
+         &UserCommandProcessor::UserCmdGetInstrumentDefinition,
+         {&ServerSettings::__cmd_get_contract},
+         nullptr},
+        {"getMint",
+         &UserCommandProcessor::UserCmdGetMint,
+         {&ServerSettings::__cmd_get_mint},
+         nullptr},
+        {"getMarketList",
+         &UserCommandProcessor::UserCmdGetMarketList,
+         {&ServerSettings::__cmd_get_market_list},
+         nullptr},
+        {"getMarketOffers",
+         &UserCommandProcessor::UserCmdGetMarketOffers,
+         {&ServerSettings::__cmd_get_market_offers},
+         nullptr},
+        {"getMarketRecentTrades",
+         &UserCommandProcessor::UserCmdGetMarketRecentTrades,
+         {&ServerSettings::__cmd_get_market_recent_trades},
+         nullptr},
+        {"getNymMarketOffers",
+         &UserCommandProcessor::UserCmdGetNymMarketOffers,
+         {&ServerSettings::__cmd_get_nym_market_offers},
+         nullptr},
+        {"triggerClause",
+         &UserCommandProcessor::UserCmdTriggerClause,
+         {&ServerSettings::__cmd_trigger_clause},
+         nullptr},
+        {"usageCredits",
+         &UserCommandProcessor::UserCmdUsageCredits,
+         {&ServerSettings::__cmd_usage_credits},
+         nullptr},
+        {"getCommandStats",
+         &UserCommandProcessor::UserCmdGetCommandStats,
+         {&ServerSettings::__cmd_get_command_stats},
+         nullptr},
+    };
+
+    return commands;
+}
 
-        OT_ENFORCE_PERMISSION_MSG(ServerSettings::__cmd_usage_credits);
+const std::unordered_map<std::string, std::size_t>& UserCommandProcessor::
+    CommandIDs()
+{
+    static const std::unordered_map<std::string, std::size_t> ids = []() {
+        std::unordered_map<std::string, std::size_t> output;
 
-        UserCmdUsageCredits(*pNym, theMessage, msgOut);
+        for (std::size_t id = 0; id < Commands().size(); ++id) {
+            output[Commands()[id].name_] = id;
+        }
 
-        return true;
-    } else {
-        Log::vError(
-            "Unknown command type in the XML, or missing payload, in "
-            "ProcessMessage.\n");
+        return output;
+    }();
 
-        String strTemp;
-        strTemp.Format(
-            "%sResponse",
-            theMessage.m_strCommand.Get());  // Todo security.
-                                             // Review this.
+    return ids;
+}
 
-        msgOut.m_strCommand = strTemp;
-        msgOut.m_strAcctID = theMessage.m_strAcctID;
-        msgOut.m_strNotaryID = theMessage.m_strNotaryID;
-        msgOut.m_strNymID = theMessage.m_strNymID;
+// Per command processing time, for the server operator.
+void UserCommandProcessor::UserCmdGetCommandStats(
+    Nym&,
+    Message& MsgIn,
+    Message& msgOut)
+{
+    // (1) set up member variables
+    msgOut.m_strCommand = "getCommandStatsResponse";
+    msgOut.m_strNymID = MsgIn.m_strNymID;
 
-        msgOut.m_bSuccess = false;
+    String strStats;
+    strStats.Concatenate(
+        "%-30s %10s %10s %10s %10s %10s %10s\n",
+        "command",
+        "count",
+        "mean_us",
+        "p50_us",
+        "p90_us",
+        "p99_us",
+        "max_us");
+
+    for (std::size_t id = 0; id < Commands().size(); ++id) {
+        const LatencyHistogram& latency = latency_[id];
+        const uint64_t count = latency.Count();
+
+        if (0 == count) continue;
+
+        strStats.Concatenate(
+            "%-30s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %10" PRIu64 "\n",
+            Commands()[id].name_.c_str(),
+            count,
+            latency.Total() / count,
+            latency.Percentile(0.5),
+            latency.Percentile(0.9),
+            latency.Percentile(0.99),
+            latency.Max());
+    }
 
-        String strRef(theMessage);
+    // The same requests again, by wire encoding. The time runs from
+    // decoding the request to encoding the reply.
+    strStats.Concatenate(
+        "\n%-10s %10s %12s %12s %10s %10s %10s %10s\n",
+        "encoding",
+        "count",
+        "req_bytes",
+        "reply_bytes",
+        "mean_us",
+        "p50_us",
+        "p99_us",
+        "max_us");
+
+    const char* encodings[] = {"xml", "protobuf"};
+
+    for (std::size_t encoding = 0; encoding < 2; ++encoding) {
+        const WireStats& stats = wire_[encoding];
+        const uint64_t count = stats.latency_.Count();
+
+        if (0 == count) continue;
+
+        strStats.Concatenate(
+            "%-10s %10" PRIu64 " %12" PRIu64 " %12" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+            encodings[encoding],
+            count,
+            stats.requestBytes_.load(std::memory_order_relaxed) / count,
+            stats.replyBytes_.load(std::memory_order_relaxed) / count,
+            stats.latency_.Total() / count,
+            stats.latency_.Percentile(0.5),
+            stats.latency_.Percentile(0.99),
+            stats.latency_.Max());
+    }
 
-        msgOut.m_ascInReferenceTo.SetString(strRef);
+    msgOut.m_bSuccess = true;
+    msgOut.m_ascPayload.SetString(strStats);
 
-        msgOut.SignContract(server_->m_nymServer);
-        msgOut.SaveContract();
+    // (2) Sign the Message
+    msgOut.SignContract(server_->m_nymServer);
 
-        return false;
-    }
+    // (3) Save the Message (with signatures and all, back to its internal
+    // member m_strRawFile.)
+    msgOut.SaveContract();
 }
 
 // Get the list of markets on this server.
@@ -1339,15 +1389,22 @@ void UserCommandProcessor::UserCmdGetMarketOffers(
     if ((msgOut.m_bSuccess =
              ((pMarket != nullptr) ? true : false)))  // if assigned true
     {
-        OTASCIIArmor ascOutput;
-        int32_t nOfferCount = 0;
+        // The client already has this list, at this depth, so there's
+        // nothing to send.
+        if (pMarket->IsOfferListCurrent(lDepth, MsgIn.m_lTransactionNum)) {
+            msgOut.m_lTransactionNum = MsgIn.m_lTransactionNum;
+            msgOut.m_bBool = true;  // Not modified.
+        } else {
+            OTASCIIArmor ascOutput;
+            int32_t nOfferCount = 0;
 
-        msgOut.m_bSuccess =
-            pMarket->GetOfferList(ascOutput, lDepth, nOfferCount);
+            msgOut.m_bSuccess = pMarket->GetOfferList(
+                ascOutput, lDepth, nOfferCount, msgOut.m_lTransactionNum);
 
-        if ((true == msgOut.m_bSuccess) && (nOfferCount > 0)) {
-            msgOut.m_ascPayload = ascOutput;
-            msgOut.m_lDepth = nOfferCount;
+            if ((true == msgOut.m_bSuccess) && (nOfferCount > 0)) {
+                msgOut.m_ascPayload = ascOutput;
+                msgOut.m_lDepth = nOfferCount;
+            }
         }
     }
 
@@ -1391,15 +1448,23 @@ void UserCommandProcessor::UserCmdGetMarketRecentTrades(
     if ((msgOut.m_bSuccess =
              ((pMarket != nullptr) ? true : false)))  // if assigned true
     {
-        OTASCIIArmor ascOutput;
-        int32_t nTradeCount = 0;
+        msgOut.m_lTransactionNum = pMarket->GetVersion();
+
+        // The client already has this version, so there's nothing to send.
+        if (MsgIn.m_lTransactionNum == msgOut.m_lTransactionNum) {
+            msgOut.m_bBool = true;  // Not modified.
+        } else {
+            OTASCIIArmor ascOutput;
+            int32_t nTradeCount = 0;
 
-        msgOut.m_bSuccess = pMarket->GetRecentTradeList(ascOutput, nTradeCount);
+            msgOut.m_bSuccess =
+                pMarket->GetRecentTradeList(ascOutput, nTradeCount);
 
-        if (true == msgOut.m_bSuccess) {
-            msgOut.m_lDepth = nTradeCount;
+            if (true == msgOut.m_bSuccess) {
+                msgOut.m_lDepth = nTradeCount;
 
-            if (nTradeCount > 0) msgOut.m_ascPayload = ascOutput;
+                if (nTradeCount > 0) msgOut.m_ascPayload = ascOutput;
+            }
         }
     }
 
@@ -3112,6 +3177,7 @@ void UserCommandProcessor::UserCmdQueryInstrumentDefinitions(
 }
 
 void UserCommandProcessor::UserCmdGetInstrumentDefinition(
+    Nym&,
     Message& MsgIn,
     Message& msgOut)
 {
@@ -3565,7 +3631,10 @@ void UserCommandProcessor::UserCmdDeleteUser(
 // the Nymbox. Otherwise it will contain an AcctID if retrieving a boxreceipt
 // for an Asset Acct.
 //
-void UserCommandProcessor::UserCmdGetBoxReceipt(Message& MsgIn, Message& msgOut)
+void UserCommandProcessor::UserCmdGetBoxReceipt(
+    Nym&,
+    Message& MsgIn,
+    Message& msgOut)
 {
     // (1) set up member variables
     msgOut.m_strCommand = "getBoxReceiptResponse";  // reply to getBoxReceipt
@@ -41,13 +41,17 @@
 #include "opentxs/storage/StorageConfig.hpp"
 #ifdef OT_STORAGE_FS
 #include "opentxs/storage/StorageFS.hpp"
+#elif defined OT_STORAGE_LOG
+#include "opentxs/storage/StorageLog.hpp"
 #elif defined OT_STORAGE_SQLITE
 #include "opentxs/storage/StorageSqlite3.hpp"
 #endif
 
 #include <assert.h>
 #include <stdint.h>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <functional>
@@ -55,9 +59,11 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 namespace opentxs
 {
@@ -71,6 +77,8 @@ Storage::Storage(
         , config_(config)
         , digest_(hash)
         , random_(random)
+        , cache_(static_cast<std::size_t>(std::max(
+              config.cache_size_, static_cast<int64_t>(0))))
 {
     std::time_t time = std::time(nullptr);
     last_gc_ = static_cast<int64_t>(time);
@@ -78,6 +86,32 @@ Storage::Storage(
     Init();
 }
 
+Storage::Batch::Batch(Storage& storage)
+    : storage_(storage)
+{
+    if (0 == storage_.batch_depth_++) {
+        storage_.batch_open_ = storage_.BeginBatch();
+
+        if (!storage_.batch_open_) {
+            std::cerr << __FUNCTION__ << ": failed to begin batch. Writes "
+                      << "will not be grouped." << std::endl;
+        }
+    }
+}
+
+Storage::Batch::~Batch()
+{
+    if (0 == --storage_.batch_depth_) {
+        if (storage_.batch_open_ && !storage_.CommitBatch()) {
+            std::cerr << __FUNCTION__ << ": failed to commit batch. Writes "
+                      << "made during the batch were rolled back."
+                      << std::endl;
+        }
+
+        storage_.batch_open_ = false;
+    }
+}
+
 void Storage::Init()
 {
     current_bucket_.store(false);
@@ -93,11 +127,7 @@ Storage& Storage::It(
 {
 
     if (nullptr == instance_pointer_) {
-#ifdef OT_STORAGE_FS
-        instance_pointer_ = new StorageFS(config, hash, random);
-#elif defined OT_STORAGE_SQLITE
-        instance_pointer_ = new StorageSqlite3(config, hash, random);
-#endif
+        instance_pointer_ = Instantiate(hash, random, config);
     }
 
     assert(nullptr != instance_pointer_);
@@ -105,6 +135,22 @@ Storage& Storage::It(
     return *instance_pointer_;
 }
 
+Storage* Storage::Instantiate(
+    const Digest& hash,
+    const Random& random,
+    const StorageConfig& config)
+{
+#ifdef OT_STORAGE_FS
+    return new StorageFS(config, hash, random);
+#elif defined OT_STORAGE_LOG
+    return new StorageLog(config, hash, random);
+#elif defined OT_STORAGE_SQLITE
+    return new StorageSqlite3(config, hash, random);
+#else
+    return nullptr;
+#endif
+}
+
 void Storage::Read()
 {
     std::lock_guard<std::mutex> readLock(init_lock_);
@@ -240,6 +286,7 @@ bool Storage::RemoveServer(const std::string& id)
     if (!isLoaded_.load()) { Read(); }
 
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // Block reads while modifying server map
     std::unique_lock<std::mutex> serverlock(server_lock_);
@@ -257,6 +304,7 @@ bool Storage::RemoveUnitDefinition(const std::string& id)
     if (!isLoaded_.load()) { Read(); }
 
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // Block reads while modifying unit map
     std::unique_lock<std::mutex> unitlock(unit_lock_);
@@ -1266,6 +1314,7 @@ bool Storage::SetDefaultSeed(const std::string& id)
 
     // block writes while searching seed map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     // do not set the default seed to an id that's not present in the map
     bool found = (seeds_.find(id) != seeds_.end());
@@ -1284,6 +1333,7 @@ bool Storage::SetNymAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching nym map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (nyms_.find(id) != nyms_.end());
 
@@ -1301,6 +1351,7 @@ bool Storage::SetSeedAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching seed map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (seeds_.find(id) != seeds_.end());
 
@@ -1318,6 +1369,7 @@ bool Storage::SetServerAlias(const std::string& id, const std::string& alias)
 
     // block writes while searching server map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (servers_.find(id) != servers_.end());
 
@@ -1337,6 +1389,7 @@ bool Storage::SetUnitDefinitionAlias(
 
     // block writes while searching server map
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     bool found = (units_.find(id) != units_.end());
 
@@ -1398,6 +1451,7 @@ bool Storage::Store(const proto::Credential& data)
 
     std::string key;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
 
@@ -1431,6 +1485,7 @@ bool Storage::Store(const proto::CredentialIndex& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_nyms_ && config_.dht_callback_) {
@@ -1450,6 +1505,7 @@ bool Storage::Store(const proto::Seed& data, const std::string alias)
 
     std::string key;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
 
@@ -1471,6 +1527,7 @@ bool Storage::Store(const proto::ServerContract& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key, plaintext)) {
         if (config_.auto_publish_servers_ && config_.dht_callback_) {
@@ -1495,6 +1552,7 @@ bool Storage::Store(const proto::UnitDefinition& data, const std::string alias)
 
     std::string key, plaintext;
     std::lock_guard<std::mutex> writeLock(write_lock_);
+    Batch batch(*this);
 
     if (StoreProto(data, key)) {
         if (config_.auto_publish_units_ && config_.dht_callback_) {
@@ -1535,13 +1593,28 @@ Storage::ObjectList Storage::UnitDefinitionList()
     return units;
 }
 
+// Garbage collection copies every object reachable from the root index
+// into the bucket which was inactive when the collection started, then
+// empties the other bucket.
+//
+// The index tree is walked depth first in small steps. Each step copies at
+// most gc_step_size_ objects in a single write batch, records its position
+// in the walk, and then pauses for gc_step_delay_ milliseconds so that
+// collection does not monopolize the backend. Since the tree under gcroot is
+// immutable, the position is enough to resume an interrupted collection
+// without copying anything twice.
+//
+// Each run still copies the whole live tree. The target bucket was emptied
+// at the end of the previous run, so an unchanged subtree is no more present
+// there than a changed one. Only objects written since the swap are already
+// in place, and MigrateKey skips those. An index node written since the swap
+// can still refer to older objects, so finding it in the target bucket
+// doesn't allow its subtree to be skipped.
 void Storage::CollectGarbage()
 {
-    bool oldLocation = current_bucket_.load();
-    current_bucket_.store(!(current_bucket_.load()));
-
     std::shared_ptr<proto::StorageRoot> root;
-    std::string gcroot, gcitems;
+    std::string gcroot;
+    uint64_t position = 0;
     bool updated = false;
 
     if (!gc_resume_.load()) {
@@ -1554,120 +1627,209 @@ void Storage::CollectGarbage()
             gc_running_.store(false);
             return;
         }
-        gcitems = root->items();
-        updated = UpdateRoot(*root, gcroot);
+
+        current_bucket_.store(!(current_bucket_.load()));
+        {
+            Batch batch(*this);
+            updated = UpdateRoot(*root, gcroot);
+        }
         writeLock.unlock();
     } else {
+        // The buckets were already swapped when the interrupted collection
+        // started.
         gcroot = old_gc_root_;
 
         if (!LoadProto(old_gc_root_, root)) {
             // If this branch is reached, the data store is corrupted
             abort();
         }
-        gcitems = root->items();
         updated = true;
+        LoadGCCursor(gcroot, position);
         gc_resume_.store(false);
     }
 
+    const bool oldLocation = !current_bucket_.load();
+
     if (!updated) {
         gc_running_.store(false);
         return;
     }
-    MigrateKey(gcitems);
-    std::shared_ptr<proto::StorageItems> items;
 
-    if (!LoadProto(gcitems, items)) {
-        gc_running_.store(false);
-        return;
-    }
+    const int64_t stepSize =
+        std::max(config_.gc_step_size_, static_cast<int64_t>(1));
+    std::vector<GCWork> stack{{root->items(), GCNode::ITEMS}};
+    std::set<std::string> visited;
+    uint64_t processed = 0;
+
+    while (!stack.empty()) {
+        {
+            std::lock_guard<std::mutex> writeLock(write_lock_);
+            Batch batch(*this);
+            int64_t budget = stepSize;
+
+            while (!stack.empty() && (0 < budget)) {
+                const GCWork work = stack.back();
+                stack.pop_back();
+                // Work before the cursor was copied by a previous run, but
+                // the walk still needs its children.
+                const bool copied = (processed < position);
+                ++processed;
+
+                // Index nodes and objects may be shared, only copy once
+                if (!visited.insert(work.first).second) { continue; }
+
+                if (!copied) {
+                    if (!MigrateKey(work.first)) {
+                        gc_running_.store(false);
+                        return;
+                    }
+
+                    --budget;
+                }
 
-    if (!items->creds().empty()) {
-        MigrateKey(items->creds());
-        std::shared_ptr<proto::StorageCredentials> creds;
+                if (!ExpandGCNode(work, stack)) {
+                    gc_running_.store(false);
+                    return;
+                }
+            }
 
-        if (!LoadProto(items->creds(), creds)) {
-            gc_running_.store(false);
-            return;
+            StoreGCCursor(gcroot, processed);
         }
 
-        for (auto& it : creds->cred()) {
-            MigrateKey(it.hash());
+        if (!stack.empty() && (0 < config_.gc_step_delay_)) {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(config_.gc_step_delay_));
         }
     }
 
-    if (!items->nyms().empty()) {
-        MigrateKey(items->nyms());
-        std::shared_ptr<proto::StorageNymList> nyms;
+    std::unique_lock<std::mutex> writeLock(write_lock_);
+    {
+        Batch batch(*this);
+        UpdateRoot();
+    }
 
-        if (!LoadProto(items->nyms(), nyms)) {
-            gc_running_.store(false);
-            return;
-        }
+    // Emptying a bucket is a backend write, so it must not interleave with
+    // a batch opened by another writer.
+    std::unique_lock<std::mutex> bucketLock(bucket_lock_);
+    EmptyBucket(oldLocation);
+    bucketLock.unlock();
+    writeLock.unlock();
 
-        for (auto& it : nyms->nym()) {
-            MigrateKey(it.hash());
-            std::shared_ptr<proto::StorageNym> nym;
+    gc_running_.store(false);
+}
+
+bool Storage::ExpandGCNode(const GCWork& work, std::vector<GCWork>& stack)
+{
+    const std::string& hash = work.first;
 
-            if (!LoadProto(it.hash(), nym)) {
-                gc_running_.store(false);
-                return;
+    switch (work.second) {
+        case GCNode::ITEMS: {
+            std::shared_ptr<proto::StorageItems> items;
+
+            if (!LoadProto(hash, items)) { return false; }
+
+            if (!items->creds().empty()) {
+                stack.push_back({items->creds(), GCNode::CREDENTIALS});
             }
 
-            MigrateKey(nym->credlist().hash());
-        }
-    }
+            if (!items->nyms().empty()) {
+                stack.push_back({items->nyms(), GCNode::NYMLIST});
+            }
 
-    if (!items->seeds().empty()) {
-        MigrateKey(items->seeds());
-        std::shared_ptr<proto::StorageSeeds> seeds;
+            if (!items->seeds().empty()) {
+                stack.push_back({items->seeds(), GCNode::SEEDS});
+            }
 
-        if (!LoadProto(items->seeds(), seeds)) {
-            gc_running_.store(false);
-            return;
-        }
+            if (!items->servers().empty()) {
+                stack.push_back({items->servers(), GCNode::SERVERS});
+            }
 
-        for (auto& it : seeds->seed()) {
-            MigrateKey(it.hash());
-        }
-    }
+            if (!items->units().empty()) {
+                stack.push_back({items->units(), GCNode::UNITS});
+            }
+        } break;
+        case GCNode::CREDENTIALS: {
+            std::shared_ptr<proto::StorageCredentials> creds;
 
-    if (!items->servers().empty()) {
-        MigrateKey(items->servers());
-        std::shared_ptr<proto::StorageServers> servers;
+            if (!LoadProto(hash, creds)) { return false; }
 
-        if (!LoadProto(items->servers(), servers)) {
-            gc_running_.store(false);
-            return;
-        }
+            for (auto& it : creds->cred()) {
+                stack.push_back({it.hash(), GCNode::LEAF});
+            }
+        } break;
+        case GCNode::NYMLIST: {
+            std::shared_ptr<proto::StorageNymList> nyms;
+
+            if (!LoadProto(hash, nyms)) { return false; }
+
+            for (auto& it : nyms->nym()) {
+                stack.push_back({it.hash(), GCNode::NYM});
+            }
+        } break;
+        case GCNode::NYM: {
+            std::shared_ptr<proto::StorageNym> nym;
+
+            if (!LoadProto(hash, nym)) { return false; }
+
+            stack.push_back({nym->credlist().hash(), GCNode::LEAF});
+        } break;
+        case GCNode::SEEDS: {
+            std::shared_ptr<proto::StorageSeeds> seeds;
+
+            if (!LoadProto(hash, seeds)) { return false; }
+
+            for (auto& it : seeds->seed()) {
+                stack.push_back({it.hash(), GCNode::LEAF});
+            }
+        } break;
+        case GCNode::SERVERS: {
+            std::shared_ptr<proto::StorageServers> servers;
+
+            if (!LoadProto(hash, servers)) { return false; }
+
+            for (auto& it : servers->server()) {
+                stack.push_back({it.hash(), GCNode::LEAF});
+            }
+        } break;
+        case GCNode::UNITS: {
+            std::shared_ptr<proto::StorageUnits> units;
+
+            if (!LoadProto(hash, units)) { return false; }
 
-        for (auto& it : servers->server()) {
-            MigrateKey(it.hash());
+            for (auto& it : units->unit()) {
+                stack.push_back({it.hash(), GCNode::LEAF});
+            }
+        } break;
+        case GCNode::LEAF:
+        default: {
         }
     }
 
-    if (!items->units().empty()) {
-        MigrateKey(items->units());
-        std::shared_ptr<proto::StorageUnits> units;
+    return true;
+}
 
-        if (!LoadProto(items->units(), units)) {
-            gc_running_.store(false);
-            return;
-        }
+bool Storage::LoadGCCursor(const std::string& gcroot, uint64_t& position)
+    const
+{
+    const std::string cursor = LoadCursor();
 
-        for (auto& it : units->unit()) {
-            MigrateKey(it.hash());
-        }
+    // The cursor is only meaningful for the collection run which wrote it
+    const auto separator = cursor.find(' ');
+
+    if ((std::string::npos == separator) ||
+        (cursor.substr(0, separator) != gcroot)) {
+
+        return false;
     }
 
-    std::unique_lock<std::mutex> writeLock(write_lock_);
-    UpdateRoot();
-    writeLock.unlock();
+    position = std::strtoull(cursor.c_str() + separator + 1, nullptr, 10);
 
-    std::unique_lock<std::mutex> bucketLock(bucket_lock_);
-    EmptyBucket(oldLocation);
-    bucketLock.unlock();
+    return true;
+}
 
-    gc_running_.store(false);
+bool Storage::StoreGCCursor(const std::string& gcroot, const uint64_t position)
+{
+    return StoreCursor(gcroot + " " + std::to_string(position));
 }
 
 bool Storage::MigrateKey(const std::string& key)
@@ -0,0 +1,124 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#include "opentxs/storage/StorageCache.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace opentxs
+{
+
+StorageCache::StorageCache(const std::size_t capacity)
+    : capacity_(capacity)
+    , shard_capacity_(capacity / SHARD_COUNT)
+    , shards_()
+    , hits_(0)
+    , misses_(0)
+{
+}
+
+void StorageCache::Add(
+    const std::string& hash,
+    const Object& object,
+    std::size_t size)
+{
+    // Account for the key and bookkeeping as well as the object itself
+    size += hash.size() + sizeof(Entry);
+
+    // Objects larger than a shard would only flush it
+    if (size > shard_capacity_) { return; }
+
+    auto& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+
+    auto existing = shard.index_.find(hash);
+
+    if (shard.index_.end() != existing) {
+        // Another thread loaded the same object concurrently
+        shard.lru_.splice(shard.lru_.begin(), shard.lru_, existing->second);
+
+        return;
+    }
+
+    shard.lru_.emplace_front(hash, object, size);
+    shard.index_[hash] = shard.lru_.begin();
+    shard.size_ += size;
+
+    while (shard.size_ > shard_capacity_) {
+        auto& oldest = shard.lru_.back();
+        shard.size_ -= std::get<2>(oldest);
+        shard.index_.erase(std::get<0>(oldest));
+        shard.lru_.pop_back();
+    }
+}
+
+void StorageCache::Clear()
+{
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.lock_);
+        shard.index_.clear();
+        shard.lru_.clear();
+        shard.size_ = 0;
+    }
+}
+
+StorageCache::Object StorageCache::Find(const std::string& hash)
+{
+    auto& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.lock_);
+
+    auto it = shard.index_.find(hash);
+
+    if (shard.index_.end() == it) { return nullptr; }
+
+    shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+
+    return std::get<1>(*(it->second));
+}
+
+StorageCache::Shard& StorageCache::GetShard(const std::string& hash)
+{
+    return shards_[std::hash<std::string>()(hash) % SHARD_COUNT];
+}
+
+} // namespace opentxs
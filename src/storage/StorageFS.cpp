@@ -75,9 +75,19 @@ void StorageFS::Purge(const std::string& path)
 }
 
 std::string StorageFS::LoadRoot() const
+{
+    return ReadFile(config_.fs_root_file_);
+}
+
+std::string StorageFS::LoadCursor() const
+{
+    return ReadFile(config_.fs_gc_cursor_file_);
+}
+
+std::string StorageFS::ReadFile(const std::string& name) const
 {
     if (!folder_.empty()) {
-        std::string filename = folder_ + "/" + config_.fs_root_file_;
+        std::string filename = folder_ + "/" + name;
 
         if (!boost::filesystem::exists(filename)) { return ""; }
 
@@ -141,15 +151,25 @@ bool StorageFS::Load(
 }
 
 bool StorageFS::StoreRoot(const std::string& hash)
+{
+    return WriteFile(config_.fs_root_file_, hash);
+}
+
+bool StorageFS::StoreCursor(const std::string& cursor)
+{
+    return WriteFile(config_.fs_gc_cursor_file_, cursor);
+}
+
+bool StorageFS::WriteFile(const std::string& name, const std::string& value)
 {
     if (!folder_.empty()) {
-        std::string filename = folder_ + "/" + config_.fs_root_file_;
+        std::string filename = folder_ + "/" + name;
         std::ofstream file(
             filename,
             std::ios::out | std::ios::trunc | std::ios::binary);
 
         if (file.good()) {
-            file.write(hash.c_str(), hash.size());
+            file.write(value.c_str(), value.size());
             file.close();
 
             return true;
@@ -0,0 +1,426 @@
+/************************************************************
+ *
+ *                 OPEN TRANSACTIONS
+ *
+ *       Financial Cryptography and Digital Cash
+ *       Library, Protocol, API, Server, CLI, GUI
+ *
+ *       -- Anonymous Numbered Accounts.
+ *       -- Untraceable Digital Cash.
+ *       -- Triple-Signed Receipts.
+ *       -- Cheques, Vouchers, Transfers, Inboxes.
+ *       -- Basket Currencies, Markets, Payment Plans.
+ *       -- Signed, XML, Ricardian-style Contracts.
+ *       -- Scripted smart contracts.
+ *
+ *  EMAIL:
+ *  fellowtraveler@opentransactions.org
+ *
+ *  WEBSITE:
+ *  http://www.opentransactions.org/
+ *
+ *  -----------------------------------------------------
+ *
+ *   LICENSE:
+ *   This Source Code Form is subject to the terms of the
+ *   Mozilla Public License, v. 2.0. If a copy of the MPL
+ *   was not distributed with this file, You can obtain one
+ *   at http://mozilla.org/MPL/2.0/.
+ *
+ *   DISCLAIMER:
+ *   This program is distributed in the hope that it will
+ *   be useful, but WITHOUT ANY WARRANTY; without even the
+ *   implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *   PARTICULAR PURPOSE.  See the Mozilla Public License
+ *   for more details.
+ *
+ ************************************************************/
+
+#ifdef OT_STORAGE_LOG
+#include "opentxs/storage/StorageLog.hpp"
+
+#include "opentxs/storage/Storage.hpp"
+#include "opentxs/storage/StorageConfig.hpp"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace opentxs
+{
+
+StorageLog::StorageLog(
+    const StorageConfig& config,
+    const Digest& hash,
+    const Random& random)
+        : ot_super(config, hash, random)
+        , folder_(config.path_)
+{
+    Init_StorageLog();
+}
+
+void StorageLog::Init_StorageLog()
+{
+    const bool opened =
+        Open(GetSegment(false), folder_ + "/" + config_.log_primary_bucket_) &&
+        Open(GetSegment(true), folder_ + "/" + config_.log_secondary_bucket_);
+
+    if (!opened) {
+        std::cerr << "Failed to initialize log storage." << std::endl;
+        abort();
+    }
+}
+
+bool StorageLog::Append(
+    Segment& segment,
+    const std::string& key,
+    const std::string& value) const
+{
+    const std::size_t limit = std::numeric_limits<uint32_t>::max();
+
+    if ((key.size() > limit) || (value.size() > limit)) { return false; }
+
+    const uint32_t header[3] = {RECORD_MAGIC,
+                                static_cast<uint32_t>(key.size()),
+                                static_cast<uint32_t>(value.size())};
+    std::string record;
+    record.reserve(HEADER_SIZE + key.size() + value.size());
+    record.append(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    record.append(key);
+    record.append(value);
+
+    segment.dirty_ = true;
+
+    if (!Write(segment.fd_, record, segment.filename_)) {
+        // Do not leave a partial record behind for the next append
+        if (0 != ::ftruncate(segment.fd_, segment.size_)) {
+            std::cerr << __FUNCTION__ << ": failed to discard partial "
+                      << "record." << std::endl;
+        }
+
+        return false;
+    }
+
+    segment.index_[key] = {segment.size_ + HEADER_SIZE + key.size(),
+                           value.size()};
+    segment.size_ += record.size();
+
+    return true;
+}
+
+void StorageLog::Close(Segment& segment) const
+{
+    Remap(segment, 0);
+
+    if (-1 != segment.fd_) {
+        ::close(segment.fd_);
+        segment.fd_ = -1;
+    }
+
+    segment.index_.clear();
+    segment.size_ = 0;
+}
+
+bool StorageLog::Open(Segment& segment, const std::string& filename) const
+{
+    std::lock_guard<std::mutex> lock(segment.lock_);
+
+    segment.filename_ = filename;
+    // Whatever is already in the file may not have been synced yet
+    segment.dirty_ = true;
+    segment.fd_ = ::open(
+        filename.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+
+    if (-1 == segment.fd_) {
+        std::cerr << __FUNCTION__ << ": failed to open " << filename << ": "
+                  << std::strerror(errno) << std::endl;
+
+        return false;
+    }
+
+    struct stat info;
+
+    if (0 != ::fstat(segment.fd_, &info)) { return false; }
+
+    const std::size_t fileSize = static_cast<std::size_t>(info.st_size);
+
+    if (!Remap(segment, fileSize)) { return false; }
+
+    // Rebuild the index by walking the records in the segment
+    std::size_t offset = 0;
+
+    while ((offset + HEADER_SIZE) <= fileSize) {
+        uint32_t header[3];
+        std::memcpy(header, segment.map_ + offset, HEADER_SIZE);
+
+        if (RECORD_MAGIC != header[0]) { break; }
+
+        const std::size_t keyStart = offset + HEADER_SIZE;
+        const std::size_t valueStart = keyStart + header[1];
+        const std::size_t end = valueStart + header[2];
+
+        if (end > fileSize) { break; }
+
+        segment.index_[std::string(segment.map_ + keyStart, header[1])] = {
+            valueStart, header[2]};
+        offset = end;
+    }
+
+    if (offset < fileSize) {
+        std::cerr << __FUNCTION__ << ": discarding " << (fileSize - offset)
+                  << " bytes of incomplete records from " << filename
+                  << std::endl;
+
+        if (0 != ::ftruncate(segment.fd_, offset)) { return false; }
+    }
+
+    segment.size_ = offset;
+
+    return true;
+}
+
+bool StorageLog::Remap(Segment& segment, const std::size_t size) const
+{
+    if (nullptr != segment.map_) {
+        ::munmap(const_cast<char*>(segment.map_), segment.mapped_);
+        segment.map_ = nullptr;
+        segment.mapped_ = 0;
+    }
+
+    if (0 == size) { return true; }
+
+    // Mapping past the end of the file is allowed as long as those pages are
+    // never accessed, and only complete records are ever read.
+    const std::size_t length =
+        ((size / MAP_INCREMENT) + 1) * MAP_INCREMENT;
+    void* map =
+        ::mmap(nullptr, length, PROT_READ, MAP_SHARED, segment.fd_, 0);
+
+    if (MAP_FAILED == map) {
+        std::cerr << __FUNCTION__ << ": failed to map " << segment.filename_
+                  << ": " << std::strerror(errno) << std::endl;
+
+        return false;
+    }
+
+    segment.map_ = static_cast<const char*>(map);
+    segment.mapped_ = length;
+
+    return true;
+}
+
+bool StorageLog::Sync(Segment& segment) const
+{
+    std::lock_guard<std::mutex> lock(segment.lock_);
+
+    if (!segment.dirty_) { return true; }
+
+    if (0 != ::fdatasync(segment.fd_)) { return false; }
+
+    segment.dirty_ = false;
+
+    return true;
+}
+
+// A rename is only durable once the directory holding it is synced
+bool StorageLog::SyncFolder() const
+{
+    const int fd = ::open(folder_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (-1 == fd) { return false; }
+
+    const bool synced = (0 == ::fsync(fd));
+    ::close(fd);
+
+    return synced;
+}
+
+bool StorageLog::Write(
+    const int fd,
+    const std::string& data,
+    const std::string& filename) const
+{
+    std::size_t written = 0;
+
+    while (written < data.size()) {
+        const ssize_t result =
+            ::write(fd, data.data() + written, data.size() - written);
+
+        if (0 > result) {
+            if (EINTR == errno) { continue; }
+
+            std::cerr << __FUNCTION__ << ": write to " << filename
+                      << " failed: " << std::strerror(errno) << std::endl;
+
+            return false;
+        }
+
+        written += static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+std::string StorageLog::LoadRoot() const
+{
+    return ReadFile(config_.log_root_file_);
+}
+
+std::string StorageLog::LoadCursor() const
+{
+    return ReadFile(config_.log_gc_cursor_file_);
+}
+
+std::string StorageLog::ReadFile(const std::string& name) const
+{
+    if (folder_.empty()) { return ""; }
+
+    const std::string filename = folder_ + "/" + name;
+    std::ifstream file(
+        filename, std::ios::in | std::ios::ate | std::ios::binary);
+
+    if (file.good()) {
+        std::ifstream::pos_type pos = file.tellg();
+
+        if ((0 >= pos) || (0xFFFFFFFF <= pos)) { return ""; }
+
+        uint32_t size(pos);
+
+        file.seekg(0, std::ios::beg);
+
+        std::vector<char> bytes(size);
+        file.read(&bytes[0], size);
+
+        return std::string(&bytes[0], size);
+    }
+
+    return "";
+}
+
+bool StorageLog::Load(
+    const std::string& key,
+    std::string& value,
+    const bool bucket) const
+{
+    Segment& segment = GetSegment(bucket);
+    std::lock_guard<std::mutex> lock(segment.lock_);
+
+    auto it = segment.index_.find(key);
+
+    if (segment.index_.end() == it) { return false; }
+
+    const std::size_t offset = it->second.first;
+    const std::size_t size = it->second.second;
+
+    if ((offset + size) > segment.mapped_) {
+        if (!Remap(segment, segment.size_)) { return false; }
+    }
+
+    value.assign(segment.map_ + offset, size);
+
+    return true;
+}
+
+bool StorageLog::StoreRoot(const std::string& hash)
+{
+    return ReplaceFile(config_.log_root_file_, hash);
+}
+
+bool StorageLog::StoreCursor(const std::string& cursor)
+{
+    return ReplaceFile(config_.log_gc_cursor_file_, cursor);
+}
+
+bool StorageLog::ReplaceFile(const std::string& name, const std::string& value)
+{
+    if (folder_.empty()) { return false; }
+
+    // Everything the new value refers to must be durable before it is
+    if (!Sync(GetSegment(false)) || !Sync(GetSegment(true))) { return false; }
+
+    const std::string filename = folder_ + "/" + name;
+    const std::string temp = filename + ".tmp";
+    const int fd = ::open(
+        temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+
+    if (-1 == fd) { return false; }
+
+    // The new contents must be on disk before the rename can expose them
+    const bool written = Write(fd, value, temp) && (0 == ::fsync(fd));
+
+    if ((0 != ::close(fd)) || !written) { return false; }
+
+    if (0 != std::rename(temp.c_str(), filename.c_str())) { return false; }
+
+    return SyncFolder();
+}
+
+bool StorageLog::Store(
+    const std::string& key,
+    const std::string& value,
+    const bool bucket) const
+{
+    Segment& segment = GetSegment(bucket);
+    std::lock_guard<std::mutex> lock(segment.lock_);
+
+    if (-1 == segment.fd_) { return false; }
+
+    // Keys are content hashes, so the existing record is identical
+    if (segment.index_.end() != segment.index_.find(key)) { return true; }
+
+    return Append(segment, key, value);
+}
+
+bool StorageLog::EmptyBucket(const bool bucket)
+{
+    Segment& segment = GetSegment(bucket);
+    std::lock_guard<std::mutex> lock(segment.lock_);
+
+    Remap(segment, 0);
+    segment.index_.clear();
+    segment.size_ = 0;
+    segment.dirty_ = true;
+
+    return (0 == ::ftruncate(segment.fd_, 0));
+}
+
+// StoreRoot() has already synced anything the new root refers to, so this
+// only costs a sync if records were stored after the last root.
+bool StorageLog::CommitBatch()
+{
+    return Sync(GetSegment(false)) && Sync(GetSegment(true));
+}
+
+void StorageLog::Cleanup_StorageLog()
+{
+    for (auto& segment : segments_) {
+        std::lock_guard<std::mutex> lock(segment.lock_);
+        Close(segment);
+    }
+}
+
+void StorageLog::Cleanup()
+{
+    Cleanup_StorageLog();
+}
+
+StorageLog::~StorageLog()
+{
+    Cleanup_StorageLog();
+}
+
+} // namespace opentxs
+#endif
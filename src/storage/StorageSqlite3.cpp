@@ -45,6 +45,8 @@
 #include <sqlite3.h>
 #include <stdint.h>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <string>
 
 namespace opentxs
@@ -59,16 +61,64 @@ StorageSqlite3::StorageSqlite3(
     Init_StorageSqlite3();
 }
 
+// Must be called with db_lock_ held. The caller resets the statement when it
+// is done with it.
+sqlite3_stmt* StorageSqlite3::Statement(
+    StatementCache& cache,
+    const std::string& tablename,
+    const std::string& query) const
+{
+    auto it = cache.find(tablename);
+
+    if (cache.end() != it) { return it->second; }
+
+    sqlite3_stmt* statement = nullptr;
+
+    if (SQLITE_OK !=
+        sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0)) {
+        std::cerr << __FUNCTION__ << ": failed to prepare statement: "
+                  << sqlite3_errmsg(db_) << std::endl;
+        sqlite3_finalize(statement);
+
+        return nullptr;
+    }
+
+    cache[tablename] = statement;
+
+    return statement;
+}
+
+// Finalizes the cached statements for one table, or for every table if
+// tablename is empty.
+void StorageSqlite3::FinalizeStatements(const std::string& tablename)
+{
+    std::lock_guard<std::recursive_mutex> lock(db_lock_);
+
+    for (auto cache : {&select_statements_, &upsert_statements_}) {
+        for (auto it = cache->begin(); it != cache->end();) {
+            if (tablename.empty() || (tablename == it->first)) {
+                sqlite3_finalize(it->second);
+                it = cache->erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
 bool StorageSqlite3::Select(
     const std::string& key,
     const std::string& tablename,
     std::string& value) const
 {
-    sqlite3_stmt* statement = nullptr;
+    std::lock_guard<std::recursive_mutex> lock(db_lock_);
     const std::string query =
         "select v from `" + tablename + "` where k=?1 LIMIT 0,1;";
+    sqlite3_stmt* statement =
+        Statement(select_statements_, tablename, query);
+
+    if (nullptr == statement) { return false; }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
     bool success = false;
@@ -79,7 +129,8 @@ bool StorageSqlite3::Select(
         value.assign(static_cast<const char*>(pResult), size);
         success = true;
     }
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
 
     return success;
 }
@@ -89,22 +140,27 @@ bool StorageSqlite3::Upsert(
     const std::string& tablename,
     const std::string& value) const
 {
-    sqlite3_stmt *statement;
+    std::lock_guard<std::recursive_mutex> lock(db_lock_);
     const std::string query =
         "insert or replace into `" + tablename +
         "` (k, v) values (?1, ?2);";
+    sqlite3_stmt* statement =
+        Statement(upsert_statements_, tablename, query);
+
+    if (nullptr == statement) { return false; }
 
-    sqlite3_prepare_v2(db_, query.c_str(), -1, &statement, 0);
     sqlite3_bind_text(statement, 1, key.c_str(), key.size(), SQLITE_STATIC);
     sqlite3_bind_blob(statement, 2, value.c_str(), value.size(), SQLITE_STATIC);
     int result = sqlite3_step(statement);
-    sqlite3_finalize(statement);
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
 
     return (result == SQLITE_DONE);
 }
 
 bool StorageSqlite3::Create(const std::string& tablename)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_lock_);
     const std::string createTable = "create table if not exists ";
     const std::string tableFormat = " (k text PRIMARY KEY, v BLOB);";
     const std::string sql = createTable + "`" + tablename + "`" + tableFormat;
@@ -115,7 +171,9 @@ bool StorageSqlite3::Create(const std::string& tablename)
 
 bool StorageSqlite3::Purge(const std::string& tablename)
 {
+    std::lock_guard<std::recursive_mutex> lock(db_lock_);
     const std::string sql = "DROP TABLE `" + tablename + "`;";
+    FinalizeStatements(tablename);
 
     if (SQLITE_OK ==
         sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr)) {
@@ -158,6 +216,21 @@ std::string StorageSqlite3::LoadRoot() const
     return "";
 }
 
+std::string StorageSqlite3::LoadCursor() const
+{
+    std::string value;
+
+    if (Select(
+        config_.sqlite3_gc_cursor_key_,
+        config_.sqlite3_control_table_,
+        value)) {
+
+        return value;
+    }
+
+    return "";
+}
+
 bool StorageSqlite3::Load(
     const std::string& key,
     std::string& value,
@@ -172,6 +245,12 @@ bool StorageSqlite3::StoreRoot(const std::string& hash)
         config_.sqlite3_root_key_, config_.sqlite3_control_table_, hash);
 }
 
+bool StorageSqlite3::StoreCursor(const std::string& cursor)
+{
+    return Upsert(
+        config_.sqlite3_gc_cursor_key_, config_.sqlite3_control_table_, cursor);
+}
+
 bool StorageSqlite3::Store(
     const std::string& key,
     const std::string& value,
@@ -185,9 +264,49 @@ bool StorageSqlite3::EmptyBucket(const bool bucket)
     return Purge(GetTableName(bucket));
 }
 
+bool StorageSqlite3::BeginBatch()
+{
+    db_lock_.lock();
+
+    if (SQLITE_OK !=
+        sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr)) {
+        std::cerr << __FUNCTION__ << ": " << sqlite3_errmsg(db_)
+                  << std::endl;
+        db_lock_.unlock();
+
+        return false;
+    }
+
+    return true;
+}
+
+bool StorageSqlite3::CommitBatch()
+{
+    bool success = (SQLITE_OK ==
+        sqlite3_exec(db_, "COMMIT TRANSACTION;", nullptr, nullptr, nullptr));
+
+    if (!success) {
+        std::cerr << __FUNCTION__ << ": " << sqlite3_errmsg(db_)
+                  << std::endl;
+
+        // A failed COMMIT may leave the transaction open. Returning with it
+        // still open would pull every later statement on db_ into it.
+        if (0 == sqlite3_get_autocommit(db_)) {
+            sqlite3_exec(
+                db_, "ROLLBACK TRANSACTION;", nullptr, nullptr, nullptr);
+        }
+    }
+
+    db_lock_.unlock();
+
+    return success;
+}
+
 void StorageSqlite3::Cleanup_StorageSqlite3()
 {
+    FinalizeStatements("");
     sqlite3_close(db_);
+    db_ = nullptr;
 }
 
 void StorageSqlite3::Cleanup()
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <irrxml/irrXML.hpp>
+#include <stdint.h>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/Contract.hpp"
+#include "opentxs/core/String.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// Counts receipts instead of loading them, so only the raw file parse and
+// the XML walk are timed.
+class ReceiptCounter : public Contract
+{
+public:
+    std::size_t receipts_ = 0;
+
+protected:
+    int32_t ProcessXMLNode(irr::io::IrrXMLReader*& xml) override
+    {
+        if (0 == strcmp("transaction", xml->getNodeName())) { ++receipts_; }
+
+        return 1;
+    }
+};
+
+// A signed inbox ledger with one armored reference per receipt, laid out
+// the way Contract::AddBookendsAroundContent writes it. The signature is
+// never verified.
+std::string signed_ledger(const std::size_t receipts)
+{
+    const std::string armored =
+        "eNrtWF1v2zYUfe+vEPS+yZLsJG5ZF0EGDN0wDGvRPRSFQEu0zUUiNZJy4v367\n"
+        "ZFLsOPHWrEWLPbQPsc7l4eXh5T0krt/cVWV0i0pgwq+mbhjN3De9b/vH51uQhP\n"
+        "- --escaped dash line inside the signed content\n";
+    std::string output = "-----BEGIN SIGNED LEDGER-----\nHash: SHA256\n\n";
+    output +=
+        "<?xml version=\"1.0\"?>\n<accountLedger version=\"2.0\" "
+        "type=\"inbox\" numPartialRecords=\"0\">\n\n";
+
+    for (std::size_t n = 0; n < receipts; ++n) {
+        const std::string number = std::to_string(1000 + n);
+        output += "<transaction type=\"chequeReceipt\" transactionNum=\"" +
+                  number + "\" inReferenceTo=\"" + number +
+                  "\" adjustment=\"-" + std::to_string(n % 1000) +
+                  "\" closingNum=\"0\" >\n<inReferenceTo>\n" + armored +
+                  "</inReferenceTo>\n</transaction>\n\n";
+    }
+
+    output += "</accountLedger>\n";
+    output +=
+        "-----BEGIN LEDGER SIGNATURE-----\n"
+        "Version: Open Transactions 0.0\n"
+        "Comment: http://opentransactions.org\n\n";
+
+    for (int line = 0; line < 6; ++line) {
+        output +=
+            "QmVuY2htYXJrIHNpZ25hdHVyZSBieXRlcyB0aGF0IGFyZSBuZXZlciB2ZXJpZm\n";
+    }
+
+    output += "-----END LEDGER SIGNATURE-----";
+
+    return output;
+}
+
+} // namespace
+
+TEST(Contract_Benchmark, parse_ledger_with_10k_receipts)
+{
+    const std::size_t receipts = 10000;
+    const String raw(signed_ledger(receipts));
+    const std::size_t passes = 10;
+    ReceiptCounter contract;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < passes; ++i) {
+        contract.receipts_ = 0;
+
+        ASSERT_TRUE(contract.LoadContractFromString(raw));
+        ASSERT_EQ(receipts, contract.receipts_);
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::cout << "Parsed a " << raw.GetLength() / 1024 << " KB ledger of "
+              << receipts << " receipts in "
+              << 1000 * elapsed.count() / passes << " ms ("
+              << (passes * raw.GetLength()) / (1024 * 1024 * elapsed.count())
+              << " MB/s)" << std::endl;
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/Nym.hpp"
+#include "opentxs/core/cron/OTCron.hpp"
+#include "opentxs/core/cron/OTCronItem.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+const int64_t TRADES = 10000;
+const int64_t MARKETS = 200;
+const std::size_t ROUNDS = 5;
+const uint64_t WORK = 20000;
+
+std::atomic<int64_t> processed(0);
+
+// Stands in for an OTTrade resting on a market. ProcessCron() does a fixed
+// amount of arithmetic in place of the matching and receipt signing a real
+// trade does, and the item is due on every round.
+class BenchmarkTrade : public OTCronItem
+{
+private:
+    std::string account_;
+    std::string nym_;
+    std::string market_;
+    uint64_t state_;
+
+public:
+    BenchmarkTrade(const int64_t number, const int64_t market)
+        : account_("account:" + std::to_string(number))
+        , nym_("nym:" + std::to_string(number))
+        , market_("market:" + std::to_string(market))
+        , state_(number)
+    {
+        SetTransactionNum(number);
+    }
+
+    bool ProcessCron() override
+    {
+        for (uint64_t i = 0; i < WORK; ++i) {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 7;
+            state_ ^= state_ << 17;
+        }
+
+        ++processed;
+
+        return true;
+    }
+
+    time64_t GetNextWakeTime() const override { return OT_TIME_ZERO; }
+
+    bool GetCronResources(std::set<std::string>& output) const override
+    {
+        output.insert(account_);
+        output.insert(nym_);
+        output.insert(market_);
+
+        return true;
+    }
+};
+
+double round_latency(const int32_t threads)
+{
+    Nym serverNym;
+    OTCron cron;
+    cron.SetServerNym(&serverNym);
+
+    for (int64_t number = 1; number <= TRADES; ++number) {
+        BenchmarkTrade* trade = new BenchmarkTrade(number, number % MARKETS);
+
+        // Cron takes ownership on success.
+        if (!cron.AddCronItem(*trade, nullptr, false, OT_TIME_ZERO)) {
+            delete trade;
+
+            return 0;
+        }
+    }
+
+    // Trades don't draw numbers here, but cron won't run below its reserve.
+    for (int64_t number = 1; number <= 10; ++number) {
+        cron.AddTransactionNumber(TRADES + number);
+    }
+
+    cron.ActivateCron();
+    OTCron::SetCronMaxThreads(threads);
+    processed = 0;
+    std::vector<double> rounds;
+
+    for (std::size_t i = 0; i < ROUNDS; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        cron.ProcessCronItems();
+        const std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        rounds.push_back(elapsed.count());
+    }
+
+    // Every trade is due on every round.
+    if (TRADES * int64_t(ROUNDS) != processed) { return 0; }
+
+    std::sort(rounds.begin(), rounds.end());
+
+    return rounds[rounds.size() / 2];
+}
+
+} // namespace
+
+TEST(Cron_Benchmark, round_latency)
+{
+    const int32_t maxThreads = OTCron::GetCronMaxThreads();
+    const int32_t refill = OTCron::GetCronRefillAmount();
+    const int32_t interval = OTCron::GetCronMsBetweenProcess();
+    OTCron::SetCronRefillAmount(10);
+    OTCron::SetCronMsBetweenProcess(0);
+
+    const double serial = round_latency(1);
+    const double parallel = round_latency(4);
+
+    OTCron::SetCronMaxThreads(maxThreads);
+    OTCron::SetCronRefillAmount(refill);
+    OTCron::SetCronMsBetweenProcess(interval);
+
+    ASSERT_LT(0, serial);
+    ASSERT_LT(0, parallel);
+
+    std::cout << TRADES << " trades over " << MARKETS
+              << " markets: median round " << serial << " ms on 1 thread, "
+              << parallel << " ms on 4 threads" << std::endl;
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/crypto/CryptoEngine.hpp"
+#include "opentxs/core/crypto/CryptoHash.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+std::string hex(const uint8_t* input, const std::size_t size)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string output;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        output.push_back(digits[input[i] >> 4]);
+        output.push_back(digits[input[i] & 0xf]);
+    }
+
+    return output;
+}
+
+struct CryptoHash_Benchmark : public ::testing::Test
+{
+    const std::vector<std::pair<CryptoHash::HashType, std::string>> types_{
+        {CryptoHash::SHA256, "sha256"},
+        {CryptoHash::SHA512, "sha512"},
+        {CryptoHash::HASH256, "hash256"},
+        {CryptoHash::HASH160, "hash160"}};
+
+    CryptoHash& hash_;
+
+    CryptoHash_Benchmark()
+        : hash_(CryptoEngine::It().Hash())
+    {
+    }
+};
+
+} // namespace
+
+TEST_F(CryptoHash_Benchmark, incremental_matches_one_shot)
+{
+    const std::string input = "The quick brown fox jumps over the lazy dog";
+    uint8_t whole[CryptoHash::MaxDigestSize];
+    uint8_t pieces[CryptoHash::MaxDigestSize];
+
+    for (const auto& type : types_) {
+        std::size_t wholeSize = sizeof(whole);
+        std::size_t piecesSize = sizeof(pieces);
+        auto hasher = hash_.Init(type.first);
+
+        ASSERT_TRUE(bool(hasher)) << type.second;
+        ASSERT_TRUE(hash_.Digest(
+            type.first, input.data(), input.size(), whole, wholeSize));
+
+        for (std::size_t i = 0; i < input.size(); i += 5) {
+            const std::size_t size = std::min<std::size_t>(5, input.size() - i);
+            ASSERT_TRUE(hasher->Update(input.data() + i, size));
+        }
+
+        ASSERT_TRUE(hasher->Final(pieces, piecesSize));
+        ASSERT_EQ(wholeSize, piecesSize) << type.second;
+        ASSERT_EQ(hex(whole, wholeSize), hex(pieces, piecesSize))
+            << type.second;
+    }
+
+    std::size_t size = sizeof(whole);
+    ASSERT_TRUE(hash_.Digest(
+        CryptoHash::SHA256, input.data(), input.size(), whole, size));
+    ASSERT_EQ(
+        "d7a8fbb307d7809469ca9abcb0082e4f8d5651e46d3cdb762d02d0bf37c9e592",
+        hex(whole, size));
+}
+
+TEST_F(CryptoHash_Benchmark, throughput)
+{
+    // Large objects streamed through a Hasher, and small objects hashed in
+    // one call, the way Storage keys are made.
+    const std::vector<uint8_t> chunk(1024 * 1024, 0x5a);
+    const std::size_t chunks = 64;
+    const std::size_t small = 128;
+    const std::size_t smallCount = 200000;
+    uint8_t digest[CryptoHash::MaxDigestSize];
+
+    for (const auto& type : types_) {
+        auto start = std::chrono::steady_clock::now();
+        auto hasher = hash_.Init(type.first);
+        std::size_t size = sizeof(digest);
+
+        ASSERT_TRUE(bool(hasher));
+
+        for (std::size_t i = 0; i < chunks; ++i) {
+            ASSERT_TRUE(hasher->Update(chunk.data(), chunk.size()));
+        }
+
+        ASSERT_TRUE(hasher->Final(digest, size));
+        const std::chrono::duration<double> large =
+            std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; i < smallCount; ++i) {
+            size = sizeof(digest);
+            ASSERT_TRUE(hash_.Digest(
+                type.first, chunk.data() + (i % 1024), small, digest, size));
+        }
+
+        const std::chrono::duration<double> many =
+            std::chrono::steady_clock::now() - start;
+
+        std::cout << type.second << ": " << chunks / large.count()
+                  << " MB/s streamed, " << smallCount / many.count()
+                  << " digests/s of " << small << " bytes" << std::endl;
+    }
+}
@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <stdint.h>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/crypto/CryptoUtil.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// CryptoUtil is abstract, but the base64 functions don't use the parts a
+// crypto engine provides.
+class TestCryptoUtil : public CryptoUtil
+{
+public:
+    bool RandomizeMemory(uint8_t*, uint32_t) const override { return false; }
+    void EncodeID(const Identifier&, String&) const override {}
+    void SetIDFromEncoded(const String&, Identifier&) const override {}
+
+protected:
+    bool GetPasswordFromConsole(OTPassword&, const char*) const override
+    {
+        return false;
+    }
+};
+
+struct Base64 : public ::testing::Test
+{
+    // RFC 4648, section 10
+    const std::vector<std::pair<std::string, std::string>> vectors_{
+        {"", ""},
+        {"f", "Zg=="},
+        {"fo", "Zm8="},
+        {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="},
+        {"fooba", "Zm9vYmE="},
+        {"foobar", "Zm9vYmFy"}};
+
+    TestCryptoUtil util_;
+    const CryptoUtil::Base64Kernel original_;
+    std::vector<CryptoUtil::Base64Kernel> kernels_;
+
+    Base64()
+        : original_(CryptoUtil::SelectedBase64Kernel())
+    {
+        for (const auto kernel :
+             {CryptoUtil::Base64Kernel::SCALAR,
+              CryptoUtil::Base64Kernel::SSSE3,
+              CryptoUtil::Base64Kernel::AVX2}) {
+            if (CryptoUtil::SetBase64Kernel(kernel)) {
+                kernels_.push_back(kernel);
+            }
+        }
+    }
+
+    ~Base64() { CryptoUtil::SetBase64Kernel(original_); }
+
+    static std::string input(const std::size_t size)
+    {
+        std::string output;
+        uint32_t state = 0x12345678 + size;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            state = (state * 1103515245) + 12345;
+            output.push_back(static_cast<char>(state >> 24));
+        }
+
+        return output;
+    }
+
+    static std::string encode(const std::string& data, const bool lineBreaks)
+    {
+        std::string output(
+            CryptoUtil::Base64EncodedSize(data.size(), lineBreaks), '\0');
+        CryptoUtil::Base64Encode(
+            reinterpret_cast<const uint8_t*>(data.data()),
+            data.size(),
+            lineBreaks,
+            &output[0]);
+
+        return output;
+    }
+
+    bool decode(const std::string& encoded, std::string& output) const
+    {
+        std::size_t size = 0;
+        uint8_t* decoded = util_.Base64Decode(encoded.c_str(), &size, true);
+
+        if (nullptr == decoded) { return false; }
+
+        output.assign(reinterpret_cast<const char*>(decoded), size);
+        delete[] decoded;
+
+        return true;
+    }
+};
+
+// The OpenSSL BIO codec CryptoUtil used before it had its own.
+std::string bio_encode(const std::string& data, const bool lineBreaks)
+{
+    BIO* b64 = BIO_new(BIO_f_base64());
+    BIO* mem = BIO_new(BIO_s_mem());
+
+    if (!lineBreaks) { BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL); }
+
+    BIO_push(b64, mem);
+    BIO_write(b64, data.data(), data.size());
+    (void)BIO_flush(b64);
+    char* encoded = nullptr;
+    const long size = BIO_get_mem_data(mem, &encoded);
+    const std::string output(encoded, size);
+    BIO_free_all(b64);
+
+    return output;
+}
+
+std::string bio_decode(const std::string& encoded, const bool lineBreaks)
+{
+    BIO* b64 = BIO_new(BIO_f_base64());
+    BIO* mem =
+        BIO_new_mem_buf(const_cast<char*>(encoded.data()), encoded.size());
+
+    if (!lineBreaks) { BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL); }
+
+    BIO_push(b64, mem);
+    std::string output(encoded.size(), '\0');
+    const int size = BIO_read(b64, &output[0], output.size());
+    output.resize((0 < size) ? size : 0);
+    BIO_free_all(b64);
+
+    return output;
+}
+
+} // namespace
+
+TEST_F(Base64, scalar_is_always_available)
+{
+    ASSERT_FALSE(kernels_.empty());
+    ASSERT_EQ(CryptoUtil::Base64Kernel::SCALAR, kernels_.front());
+}
+
+TEST_F(Base64, rfc4648_vectors)
+{
+    for (const auto kernel : kernels_) {
+        ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+
+        for (const auto& vector : vectors_) {
+            std::string decoded;
+
+            EXPECT_EQ(vector.second, encode(vector.first, false));
+            ASSERT_TRUE(decode(vector.second, decoded));
+            EXPECT_EQ(vector.first, decoded);
+        }
+    }
+}
+
+TEST_F(Base64, line_breaks)
+{
+    const std::string data = input(100);
+
+    for (const auto kernel : kernels_) {
+        ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+        const std::string encoded = encode(data, true);
+
+        // 136 characters: two full lines of 64 and one of 8
+        ASSERT_EQ(std::size_t(139), encoded.size());
+        EXPECT_EQ('\n', encoded[64]);
+        EXPECT_EQ('\n', encoded[129]);
+        EXPECT_EQ('\n', encoded[138]);
+        EXPECT_EQ(encode(data, false).substr(0, 64), encoded.substr(0, 64));
+    }
+}
+
+// Every length mod 3, and lengths either side of the vector block sizes.
+TEST_F(Base64, kernels_agree)
+{
+    for (std::size_t size = 0; size < 400; ++size) {
+        const std::string data = input(size);
+
+        ASSERT_TRUE(
+            CryptoUtil::SetBase64Kernel(CryptoUtil::Base64Kernel::SCALAR));
+        const std::string plain = encode(data, false);
+        const std::string broken = encode(data, true);
+
+        for (const auto kernel : kernels_) {
+            ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+            std::string decoded;
+
+            ASSERT_EQ(plain, encode(data, false)) << "size " << size;
+            ASSERT_EQ(broken, encode(data, true)) << "size " << size;
+            ASSERT_TRUE(decode(plain, decoded)) << "size " << size;
+            ASSERT_EQ(data, decoded) << "size " << size;
+            ASSERT_TRUE(decode(broken, decoded)) << "size " << size;
+            ASSERT_EQ(data, decoded) << "size " << size;
+        }
+    }
+}
+
+TEST_F(Base64, whitespace_is_skipped)
+{
+    for (const auto kernel : kernels_) {
+        ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+        std::string decoded;
+
+        ASSERT_TRUE(decode(" Zm9v\r\nYm\tFy\n", decoded));
+        EXPECT_EQ("foobar", decoded);
+    }
+}
+
+TEST_F(Base64, invalid_input)
+{
+    // An invalid character deep enough to land inside a vector block
+    std::string invalid = encode(input(300), false);
+    invalid[150] = '*';
+
+    for (const auto kernel : kernels_) {
+        ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+        std::string decoded;
+
+        EXPECT_FALSE(decode("Zm9v!mFy", decoded));
+        EXPECT_FALSE(decode("Zg=a", decoded));
+        EXPECT_FALSE(decode("Zg==Zm9v", decoded));
+        EXPECT_FALSE(decode("Z", decoded));
+        EXPECT_FALSE(decode("Zm9vY", decoded));
+        EXPECT_FALSE(decode(invalid, decoded));
+    }
+}
+
+TEST_F(Base64, decode_blocks_stops_at_invalid_character)
+{
+    const std::string encoded = encode(input(300), false);
+
+    for (const auto kernel : kernels_) {
+        ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+
+        for (const std::size_t position : {0, 3, 4, 37, 100, 199, 398}) {
+            std::string data = encoded;
+            data[position] = '\n';
+            std::vector<uint8_t> output((data.size() / 4) * 3);
+
+            EXPECT_EQ(
+                (position / 4) * 4,
+                CryptoUtil::Base64DecodeBlocks(
+                    data.data(), data.size(), output.data()))
+                << "position " << position;
+        }
+    }
+}
+
+// Random inputs of up to 5000 bytes, with and without line breaks, must
+// encode exactly as the OpenSSL BIO encoder does, and each codec must decode
+// what the other encoded.
+TEST_F(Base64, matches_openssl_bio)
+{
+    std::mt19937 random(5000);
+    std::uniform_int_distribution<std::size_t> size(0, 5000);
+    std::uniform_int_distribution<int> byte(0, 255);
+
+    for (std::size_t i = 0; i < 2000; ++i) {
+        std::string data(size(random), '\0');
+
+        for (auto& c : data) { c = static_cast<char>(byte(random)); }
+
+        for (const bool lineBreaks : {false, true}) {
+            const std::string expected = bio_encode(data, lineBreaks);
+
+            ASSERT_EQ(data, bio_decode(expected, lineBreaks));
+
+            for (const auto kernel : kernels_) {
+                ASSERT_TRUE(CryptoUtil::SetBase64Kernel(kernel));
+                const std::string encoded = encode(data, lineBreaks);
+                std::string decoded;
+
+                ASSERT_EQ(expected, encoded)
+                    << "size " << data.size() << ", line breaks "
+                    << lineBreaks;
+                ASSERT_TRUE(decode(expected, decoded));
+                ASSERT_EQ(data, decoded);
+                ASSERT_EQ(data, bio_decode(encoded, lineBreaks));
+            }
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/String.hpp"
+#include "opentxs/core/crypto/OTASCIIArmor.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// Roughly the shape of a ledger full of receipts: repetitive XML with
+// varying identifiers and amounts.
+std::string ledger(const std::size_t receipts)
+{
+    std::string output =
+        "<accountLedger version=\"2.0\" type=\"inbox\" numPartialRecords=\"0\""
+        " accountID=\"otVLjwgfBpT6UNpNKPGwW6qE8FJWM5wvgH6G\"\n"
+        " nymID=\"ot2C8CZUdwHfMh2Ee3hb4tH5dJbLfMNSjTTh\"\n"
+        " notaryID=\"otBUwUF8qCyyGVMvJCfTdf4HdbdXAHNTJZgE\" >\n\n";
+
+    for (std::size_t n = 0; n < receipts; ++n) {
+        const std::string number = std::to_string(1000 + (n * 7919) % 99991);
+        output += "<transaction type=\"chequeReceipt\" dateSigned=\"14" +
+                  number + "\" transactionNum=\"" + number +
+                  "\" inReferenceTo=\"" + std::to_string(n) +
+                  "\" adjustment=\"-" + std::to_string(n % 1000) +
+                  "\" displayValue=\"" + std::to_string(n % 1000) +
+                  "\" numberOfOrigin=\"" + number +
+                  "\" inRefDisplay=\"" + std::to_string(n) +
+                  "\" closingNum=\"0\" totalListOfNumbers=\"\"\n"
+                  " isReplyReceipt=\"false\" replyTransSuccess=\"false\" />"
+                  "\n\n";
+    }
+
+    output += "</accountLedger>\n";
+
+    return output;
+}
+
+struct OTASCIIArmor_Benchmark : public ::testing::Test
+{
+    const ArmorCompression codec_;
+    const int32_t level_;
+
+    OTASCIIArmor_Benchmark()
+        : codec_(OTASCIIArmor::Compression())
+        , level_(OTASCIIArmor::CompressionLevel())
+    {
+    }
+
+    ~OTASCIIArmor_Benchmark() { OTASCIIArmor::SetCompression(codec_, level_); }
+};
+
+} // namespace
+
+TEST_F(OTASCIIArmor_Benchmark, compression_levels)
+{
+    const String plain(ledger(10000));
+    const double megabytes = plain.GetLength() / (1024.0 * 1024.0);
+    std::vector<std::pair<ArmorCompression, int32_t>> settings;
+
+    for (int32_t level = 1; level <= 9; ++level) {
+        settings.push_back({ArmorCompression::ZLIB, level});
+    }
+
+    for (const int32_t level : {1, 3, 9, 19}) {
+        settings.push_back({ArmorCompression::ZSTD, level});
+    }
+
+    for (const auto& setting : settings) {
+        // ZSTD is only available in builds with OT_COMPRESSION_ZSTD
+        if (!OTASCIIArmor::SetCompression(setting.first, setting.second)) {
+            continue;
+        }
+
+        OTASCIIArmor armor;
+        String decoded;
+
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(armor.SetString(plain));
+        const std::chrono::duration<double> encode =
+            std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(armor.GetString(decoded));
+        const std::chrono::duration<double> decode =
+            std::chrono::steady_clock::now() - start;
+
+        ASSERT_TRUE(plain == decoded);
+
+        std::cout << ((ArmorCompression::ZSTD == setting.first) ? "zstd"
+                                                                : "zlib")
+                  << " level " << setting.second << ": ratio "
+                  << static_cast<double>(plain.GetLength()) /
+                         armor.GetLength()
+                  << ", encode " << megabytes / encode.count()
+                  << " MB/s, decode " << megabytes / decode.count()
+                  << " MB/s" << std::endl;
+    }
+}
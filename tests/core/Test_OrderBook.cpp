@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/trade/OTOffer.hpp"
+#include "opentxs/core/trade/OTOrderBook.hpp"
+
+using namespace opentxs;
+
+// Both books replay the same order stream: limit orders that trade against
+// the other side and rest whatever is left, market orders that wait on the
+// book until cron processes them, and cancels. The multimap book is the one
+// OTMarket used before OTOrderBook, including its linear search on removal.
+
+namespace
+{
+
+const std::size_t ORDERS = 50000;
+const int64_t MID = 100000;
+const int64_t SPREAD = 500;
+
+struct Order
+{
+    enum Kind { ADD, PROCESS, CANCEL };
+
+    Kind kind_;
+    std::size_t offer_;
+};
+
+struct Stream
+{
+    std::vector<std::unique_ptr<OTOffer>> offers_;
+    std::vector<bool> selling_;
+    std::vector<int64_t> price_;
+    std::vector<int64_t> amount_;
+    std::vector<Order> orders_;
+
+    Stream()
+    {
+        std::mt19937_64 random(ORDERS);
+        // Most limit orders rest away from the middle, some cross it.
+        std::uniform_int_distribution<int64_t> offset(-SPREAD / 10, SPREAD);
+        std::uniform_int_distribution<int64_t> amount(1, 100);
+        std::uniform_int_distribution<int> kind(0, 99);
+        std::vector<std::size_t> pending;
+
+        for (std::size_t i = 0; i < ORDERS; ++i) {
+            const int roll = kind(random);
+
+            if ((roll < 25) && (!offers_.empty())) {
+                std::uniform_int_distribution<std::size_t> pick(
+                    0, offers_.size() - 1);
+                orders_.push_back({Order::CANCEL, pick(random)});
+
+                continue;
+            }
+
+            const bool selling = (0 == (random() & 1));
+            const int64_t away = offset(random);
+            const int64_t limit = selling ? (MID + away) : (MID - away);
+            const int64_t price = (roll < 30) ? 0 : limit;
+
+            // Market orders are processed a few orders after they arrive.
+            if (0 == price) { pending.push_back(offers_.size()); }
+
+            orders_.push_back({Order::ADD, offers_.size()});
+            offers_.emplace_back(new OTOffer);
+            selling_.push_back(selling);
+            price_.push_back(price);
+            amount_.push_back(amount(random));
+
+            if ((pending.size() > 4) || (ORDERS == i + 1)) {
+                for (const auto& offer : pending) {
+                    orders_.push_back({Order::PROCESS, offer});
+                }
+
+                pending.clear();
+            }
+        }
+    }
+
+    void Reset()
+    {
+        for (std::size_t i = 0; i < offers_.size(); ++i) {
+            offers_[i]->MakeOffer(
+                selling_[i], price_[i], amount_[i], 1, int64_t(i) + 1);
+        }
+    }
+};
+
+// Trades offer against the resting offer, the way ProcessTrade does once it
+// has found a match.
+int64_t fill(OTOffer& offer, OTOffer& resting)
+{
+    const int64_t amount =
+        std::min(offer.GetAmountAvailable(), resting.GetAmountAvailable());
+    offer.IncrementFinishedSoFar(amount);
+    resting.IncrementFinishedSoFar(amount);
+
+    return amount;
+}
+
+bool crosses(OTOffer& offer, const int64_t price)
+{
+    if (offer.IsMarketOrder()) { return true; }
+
+    return offer.IsBid() ? (price <= offer.GetPriceLimit())
+                         : (price >= offer.GetPriceLimit());
+}
+
+class MultimapBook
+{
+private:
+    typedef std::multimap<int64_t, OTOffer*> mapOfOffers;
+
+    mapOfOffers bids_;
+    mapOfOffers asks_;
+
+public:
+    int64_t traded_ = 0;
+
+    void Add(OTOffer& offer)
+    {
+        if (offer.IsBid()) {
+            bids_.insert(
+                bids_.lower_bound(offer.GetPriceLimit()),
+                std::make_pair(offer.GetPriceLimit(), &offer));
+        } else {
+            asks_.insert(
+                asks_.upper_bound(offer.GetPriceLimit()),
+                std::make_pair(offer.GetPriceLimit(), &offer));
+        }
+    }
+
+    void Remove(OTOffer& offer)
+    {
+        mapOfOffers& side = offer.IsBid() ? bids_ : asks_;
+
+        for (auto it = side.begin(); it != side.end(); ++it) {
+            if (it->second == &offer) {
+                side.erase(it);
+
+                return;
+            }
+        }
+    }
+
+    void Match(OTOffer& offer)
+    {
+        while (0 < offer.GetAmountAvailable()) {
+            mapOfOffers::iterator best;
+
+            if (offer.IsBid()) {
+                // Market orders have a 0 price, so they sit in front of
+                // every real ask.
+                best = asks_.begin();
+
+                while ((asks_.end() != best) &&
+                       best->second->IsMarketOrder()) {
+                    ++best;
+                }
+
+                if (asks_.end() == best) { return; }
+            } else {
+                // Market order bids are at the bottom, out of the way, until
+                // nothing else is left.
+                if (bids_.empty()) { return; }
+
+                best = std::prev(bids_.upper_bound(bids_.rbegin()->first));
+
+                if (best->second->IsMarketOrder()) { return; }
+            }
+
+            if (!crosses(offer, best->first)) { return; }
+
+            OTOffer& resting = *best->second;
+            traded_ += fill(offer, resting);
+
+            if (0 == resting.GetAmountAvailable()) {
+                (offer.IsBid() ? asks_ : bids_).erase(best);
+            }
+        }
+    }
+
+    std::size_t Count() const
+    {
+        return bids_.size() + asks_.size();
+    }
+};
+
+class PriceLevelBook
+{
+private:
+    OTOrderBook bids_;
+    OTOrderBook asks_;
+
+public:
+    int64_t traded_ = 0;
+
+    PriceLevelBook()
+        : bids_(true)
+        , asks_(false)
+    {
+    }
+
+    void Add(OTOffer& offer)
+    {
+        (offer.IsBid() ? bids_ : asks_).Add(offer);
+    }
+
+    void Remove(OTOffer& offer)
+    {
+        (offer.IsBid() ? bids_ : asks_).Remove(offer);
+    }
+
+    void Match(OTOffer& offer)
+    {
+        OTOrderBook& other = offer.IsBid() ? asks_ : bids_;
+
+        while ((0 < offer.GetAmountAvailable()) && (0 < other.LevelCount())) {
+            const auto& level = other.Level(0);
+
+            if (!crosses(offer, level.price_)) { return; }
+
+            OTOffer& resting = *level.offers_.front();
+            const int64_t amount = std::min(
+                offer.GetAmountAvailable(), resting.GetAmountAvailable());
+            other.Filled(resting, amount);
+            traded_ += fill(offer, resting);
+
+            if (0 == resting.GetAmountAvailable()) { other.Remove(resting); }
+        }
+    }
+
+    std::size_t Count() const
+    {
+        return bids_.Count() + asks_.Count();
+    }
+};
+
+template <typename Book>
+double orders_per_second(Stream& stream, Book& book)
+{
+    std::vector<bool> resting(stream.offers_.size(), false);
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const auto& order : stream.orders_) {
+        OTOffer& offer = *stream.offers_[order.offer_];
+
+        switch (order.kind_) {
+            case Order::ADD: {
+                if (!offer.IsMarketOrder()) { book.Match(offer); }
+
+                if (0 < offer.GetAmountAvailable()) {
+                    book.Add(offer);
+                    resting[order.offer_] = true;
+                }
+            } break;
+            case Order::PROCESS: {
+                if (!resting[order.offer_]) { break; }
+
+                // Market orders only get one chance to trade.
+                book.Remove(offer);
+                book.Match(offer);
+                resting[order.offer_] = false;
+            } break;
+            case Order::CANCEL: {
+                if (!resting[order.offer_]) { break; }
+
+                if (0 < offer.GetAmountAvailable()) { book.Remove(offer); }
+
+                resting[order.offer_] = false;
+            } break;
+        }
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return stream.orders_.size() / elapsed.count();
+}
+
+} // namespace
+
+TEST(OrderBook_Benchmark, matching)
+{
+    Stream stream;
+
+    stream.Reset();
+    MultimapBook multimap;
+    const double before = orders_per_second(stream, multimap);
+
+    stream.Reset();
+    PriceLevelBook levels;
+    const double after = orders_per_second(stream, levels);
+
+    // Both books must make exactly the same trades.
+    ASSERT_LT(0, levels.traded_);
+    EXPECT_EQ(multimap.traded_, levels.traded_);
+    EXPECT_EQ(multimap.Count(), levels.Count());
+
+    std::cout << stream.orders_.size() << " orders, " << levels.Count()
+              << " left on the book: "
+              << static_cast<uint64_t>(before) << " orders/sec with multimaps, "
+              << static_cast<uint64_t>(after)
+              << " orders/sec with price levels" << std::endl;
+}
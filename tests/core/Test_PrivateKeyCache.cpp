@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <openssl/bio.h>
+#include <openssl/bn.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <openssl/sha.h>
+#include <openssl/x509.h>
+#include <stdint.h>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/OTData.hpp"
+#include "opentxs/core/crypto/OTPassword.hpp"
+#include "opentxs/core/crypto/PrivateKeyCache.hpp"
+
+#ifdef OT_CRYPTO_USING_LIBSECP256K1
+#include "secp256k1.h"
+#endif
+
+using namespace opentxs;
+
+// Each case signs the same message repeatedly, the way the server Nym signs
+// its replies. The uncached loop decrypts the stored private key before every
+// signature, as the backends did before PrivateKeyCache. The cached loop
+// takes the plaintext from PrivateKeyCache instead.
+
+namespace
+{
+
+const std::size_t SIGNATURES = 500;
+const char PASSWORD[] = "benchmark master password";
+const std::string MESSAGE(512, 'm');
+
+double signatures_per_second(const std::function<bool()>& sign)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < SIGNATURES; ++i) {
+        if (!sign()) { return 0; }
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return SIGNATURES / elapsed.count();
+}
+
+void report(const std::string& what, const double uncached, const double cached)
+{
+    std::cout << what << ": " << static_cast<uint64_t>(uncached)
+              << " signatures/sec decrypting every key, "
+              << static_cast<uint64_t>(cached)
+              << " signatures/sec from the cache" << std::endl;
+}
+
+bool rsa_sign(EVP_PKEY* key)
+{
+    if (nullptr == key) { return false; }
+
+    std::vector<unsigned char> signature(EVP_PKEY_size(key));
+    unsigned int size = 0;
+    EVP_MD_CTX* context = EVP_MD_CTX_create();
+    const bool success =
+        (1 == EVP_SignInit_ex(context, EVP_sha256(), nullptr)) &&
+        (1 == EVP_SignUpdate(context, MESSAGE.data(), MESSAGE.size())) &&
+        (1 == EVP_SignFinal(context, &signature[0], &size, key));
+    EVP_MD_CTX_destroy(context);
+    EVP_PKEY_free(key);
+
+    return success;
+}
+
+// The way OTAsymmetricKey_OpenSSL stores a private key: PEM, encrypted with
+// 3DES under the master password.
+std::string rsa_encrypted_key()
+{
+    EVP_PKEY* key = EVP_PKEY_new();
+    RSA* rsa = RSA_new();
+    BIGNUM* exponent = BN_new();
+    BN_set_word(exponent, RSA_F4);
+    RSA_generate_key_ex(rsa, 1024, exponent, nullptr);
+    BN_free(exponent);
+    EVP_PKEY_assign_RSA(key, rsa);
+
+    BIO* bio = BIO_new(BIO_s_mem());
+    PEM_write_bio_PrivateKey(
+        bio,
+        key,
+        EVP_des_ede3_cbc(),
+        nullptr,
+        0,
+        nullptr,
+        const_cast<char*>(PASSWORD));
+    char* data = nullptr;
+    const long size = BIO_get_mem_data(bio, &data);
+    const std::string output(data, size);
+    BIO_free(bio);
+    EVP_PKEY_free(key);
+
+    return output;
+}
+
+EVP_PKEY* rsa_decrypt(const std::string& pem)
+{
+    BIO* bio = BIO_new_mem_buf(const_cast<char*>(pem.data()), pem.size());
+    EVP_PKEY* key = PEM_read_bio_PrivateKey(
+        bio, nullptr, nullptr, const_cast<char*>(PASSWORD));
+    BIO_free(bio);
+
+    return key;
+}
+
+} // namespace
+
+TEST(PrivateKeyCache_Benchmark, rsa_signatures)
+{
+    const std::string pem = rsa_encrypted_key();
+    const OTData encrypted(pem.data(), pem.size());
+
+    ASSERT_TRUE(rsa_sign(rsa_decrypt(pem)));
+
+    const double uncached =
+        signatures_per_second([&]() { return rsa_sign(rsa_decrypt(pem)); });
+
+    // What OTAsymmetricKey_OpenSSLPrivdp::GetKey() caches: the DER encoding
+    // of the decrypted key.
+    EVP_PKEY* key = rsa_decrypt(pem);
+    std::vector<unsigned char> der(i2d_PrivateKey(key, nullptr));
+    unsigned char* pDER = &der[0];
+    i2d_PrivateKey(key, &pDER);
+    EVP_PKEY_free(key);
+    PrivateKeyCache::It().Insert(encrypted, OTData(der));
+    OTPassword::zeroMemory(&der[0], der.size());
+
+    const double cached = signatures_per_second([&]() {
+        OTData cachedKey;
+
+        if (!PrivateKeyCache::It().Get(encrypted, cachedKey)) { return false; }
+
+        const unsigned char* pCached =
+            static_cast<const unsigned char*>(cachedKey.GetPointer());
+
+        return rsa_sign(
+            d2i_AutoPrivateKey(nullptr, &pCached, cachedKey.GetSize()));
+    });
+
+    // Too large for an OTPassword, so that overload must refuse it rather
+    // than truncate the key.
+    OTPassword truncated;
+    EXPECT_FALSE(PrivateKeyCache::It().Get(encrypted, truncated));
+
+    PrivateKeyCache::It().Clear();
+
+    ASSERT_LT(0, cached);
+    report("RSA 1024", uncached, cached);
+}
+
+#ifdef OT_CRYPTO_USING_LIBSECP256K1
+namespace
+{
+
+// The way Libsecp256k1 stores a private key: AES-256-ECB under the SHA256 of
+// the master password.
+bool secp256k1_crypt(
+    const bool encrypt,
+    const std::vector<unsigned char>& input,
+    std::vector<unsigned char>& output)
+{
+    unsigned char key[SHA256_DIGEST_LENGTH];
+    SHA256(
+        reinterpret_cast<const unsigned char*>(PASSWORD),
+        sizeof(PASSWORD) - 1,
+        key);
+    output.resize(input.size() + EVP_MAX_BLOCK_LENGTH);
+    int size = 0, last = 0;
+    EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+    const bool success =
+        (1 == EVP_CipherInit_ex(
+                  context, EVP_aes_256_ecb(), nullptr, key, nullptr,
+                  encrypt)) &&
+        (1 == EVP_CipherUpdate(
+                  context, &output[0], &size, &input[0], input.size())) &&
+        (1 == EVP_CipherFinal_ex(context, &output[size], &last));
+    EVP_CIPHER_CTX_free(context);
+    OTPassword::zeroMemory(key, sizeof(key));
+    output.resize(size + last);
+
+    return success;
+}
+
+bool secp256k1_sign(
+    const secp256k1_context* context,
+    const unsigned char* privateKey)
+{
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    SHA256(
+        reinterpret_cast<const unsigned char*>(MESSAGE.data()),
+        MESSAGE.size(),
+        hash);
+    secp256k1_ecdsa_signature signature;
+
+    return 1 == secp256k1_ecdsa_sign(
+                    context, &signature, hash, privateKey, nullptr, nullptr);
+}
+
+} // namespace
+
+TEST(PrivateKeyCache_Benchmark, secp256k1_signatures)
+{
+    secp256k1_context* context =
+        secp256k1_context_create(SECP256K1_CONTEXT_SIGN);
+    std::vector<unsigned char> privateKey(32);
+
+    do {
+        RAND_bytes(&privateKey[0], privateKey.size());
+    } while (1 != secp256k1_ec_seckey_verify(context, &privateKey[0]));
+
+    std::vector<unsigned char> stored;
+    ASSERT_TRUE(secp256k1_crypt(true, privateKey, stored));
+    const OTData encrypted(&stored[0], stored.size());
+
+    const double uncached = signatures_per_second([&]() {
+        std::vector<unsigned char> plaintext;
+
+        return secp256k1_crypt(false, stored, plaintext) &&
+               secp256k1_sign(context, &plaintext[0]);
+    });
+
+    const OTPassword decrypted(
+        static_cast<const void*>(&privateKey[0]), privateKey.size());
+    PrivateKeyCache::It().Insert(encrypted, decrypted);
+
+    const double cached = signatures_per_second([&]() {
+        OTPassword plaintext;
+
+        return PrivateKeyCache::It().Get(encrypted, plaintext) &&
+               secp256k1_sign(context, plaintext.getMemory_uint8());
+    });
+
+    PrivateKeyCache::It().Clear();
+    secp256k1_context_destroy(context);
+
+    ASSERT_LT(0, cached);
+    report("secp256k1", uncached, cached);
+}
+#endif
@@ -0,0 +1,166 @@
+#include <ftw.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/cash/SpentTokenIndex.hpp"
+#include "opentxs/core/Identifier.hpp"
+#include "opentxs/core/String.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// Set OT_SPENT_TOKEN_BENCHMARK_COUNT to run the benchmark at full size
+// (10000000)
+const std::uint64_t DEFAULT_COUNT = 100000;
+const std::uint64_t DEPOSITS = 1000;
+const std::uint64_t BATCH = 4096;
+const char SERIES[] = "benchmark.0";
+
+std::uint64_t benchmark_count()
+{
+    const char* count = getenv("OT_SPENT_TOKEN_BENCHMARK_COUNT");
+
+    if (nullptr == count) { return DEFAULT_COUNT; }
+
+    return std::stoull(count);
+}
+
+// Token hashes are uniformly distributed, like the SHA256 digests they stand
+// in for.
+Identifier token(const std::uint64_t n)
+{
+    std::mt19937_64 random(n);
+    std::uint64_t hash[SpentTokenIndex::HASH_SIZE / sizeof(std::uint64_t)];
+
+    for (auto& word : hash) { word = random(); }
+
+    Identifier output;
+    output.Assign(hash, sizeof(hash));
+
+    return output;
+}
+
+int remove_entry(const char* path, const struct stat*, int, struct FTW*)
+{
+    return remove(path);
+}
+
+struct SpentTokenIndex_Test : public ::testing::Test
+{
+    std::string folder_;
+
+    SpentTokenIndex_Test()
+    {
+        char folder[] = "/tmp/opentxs-spent-XXXXXX";
+
+        if (nullptr != mkdtemp(folder)) {
+            folder_ = std::string(folder) + "/";
+        }
+    }
+
+    ~SpentTokenIndex_Test()
+    {
+        if (!folder_.empty()) {
+            nftw(folder_.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+        }
+    }
+
+    static void report(
+        const std::string& what,
+        const std::uint64_t count,
+        const std::chrono::duration<double>& elapsed)
+    {
+        const double rate = (0 < elapsed.count()) ? count / elapsed.count() : 0;
+
+        std::cout << what << ": " << static_cast<std::uint64_t>(rate)
+                  << "/sec" << std::endl;
+        RecordProperty(what + "_per_sec", static_cast<int>(rate));
+    }
+};
+
+} // namespace
+
+TEST_F(SpentTokenIndex_Test, survives_reopen)
+{
+    ASSERT_FALSE(folder_.empty());
+
+    const String series(SERIES);
+    std::vector<Identifier> spent;
+
+    // Enough to force a merge into the index, plus some left in the journal.
+    for (std::uint64_t n = 0; n < 5000; ++n) { spent.push_back(token(n)); }
+
+    {
+        SpentTokenIndex index(folder_);
+
+        EXPECT_FALSE(index.IsSpent(series, token(0)));
+        ASSERT_TRUE(index.Record(series, spent));
+        EXPECT_TRUE(index.IsSpent(series, token(0)));
+    }
+
+    SpentTokenIndex index(folder_);
+
+    for (std::uint64_t n = 0; n < 5000; n += 97) {
+        EXPECT_TRUE(index.IsSpent(series, token(n)));
+    }
+
+    EXPECT_FALSE(index.IsSpent(series, token(5000)));
+}
+
+// A deposit checks each token and then records it, one token at a time, the
+// way Notary deposits cash.
+TEST_F(SpentTokenIndex_Test, deposit_benchmark)
+{
+    ASSERT_FALSE(folder_.empty());
+
+    const std::uint64_t count = benchmark_count();
+    const String series(SERIES);
+    std::unique_ptr<SpentTokenIndex> index(new SpentTokenIndex(folder_));
+
+    for (std::uint64_t n = 0; n < count;) {
+        std::vector<Identifier> batch;
+
+        for (; (n < count) && (batch.size() < BATCH); ++n) {
+            batch.push_back(token(n));
+        }
+
+        ASSERT_TRUE(index->Record(series, batch));
+    }
+
+    // Reopen, so that the index is read from disk.
+    index.reset(new SpentTokenIndex(folder_));
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::uint64_t n = count; n < count + DEPOSITS; ++n) {
+        ASSERT_FALSE(index->IsSpent(series, token(n)));
+        ASSERT_TRUE(index->Record(series, token(n)));
+    }
+
+    report("deposits", DEPOSITS, std::chrono::steady_clock::now() - start);
+    std::uint64_t checks = 0;
+    start = std::chrono::steady_clock::now();
+
+    for (std::uint64_t n = 0; n < count; n += (count / DEPOSITS) + 1) {
+        ASSERT_TRUE(index->IsSpent(series, token(n)));
+        ++checks;
+    }
+
+    report(
+        "double_spend_checks",
+        checks,
+        std::chrono::steady_clock::now() - start);
+
+    std::cout << "with " << count << " spent tokens" << std::endl;
+}
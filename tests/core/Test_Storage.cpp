@@ -0,0 +1,262 @@
+#include <ftw.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/core/Proto.hpp"
+#include "opentxs/storage/Storage.hpp"
+#include "opentxs/storage/StorageConfig.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+// Set OT_STORAGE_BENCHMARK_COUNT to run the benchmark at full size (100000)
+const std::uint64_t DEFAULT_COUNT = 1000;
+
+std::uint64_t benchmark_count()
+{
+    const char* count = getenv("OT_STORAGE_BENCHMARK_COUNT");
+
+    if (nullptr == count) { return DEFAULT_COUNT; }
+
+    return std::stoull(count);
+}
+
+// The keys only need to be stable and distinct for the test
+bool digest(const std::uint32_t, const std::string& input, std::string& output)
+{
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0')
+        << std::hash<std::string>()(input) << input.size();
+    output = key.str();
+
+    return true;
+}
+
+std::string random_string()
+{
+    static std::uint64_t counter = 0;
+
+    return std::to_string(++counter);
+}
+
+// Identifiers shaped like real ones, which are well above the minimum length
+// proto::Check accepts.
+std::string identifier(const std::string& prefix, const std::uint64_t n)
+{
+    std::ostringstream id;
+    id << "ot" << prefix << std::setw(40) << std::setfill('0') << n;
+
+    return id.str();
+}
+
+void set_key(proto::AsymmetricKey& key, const proto::KeyRole role)
+{
+    key.set_version(1);
+    key.set_type(proto::AKEYTYPE_SECP256K1);
+    key.set_mode(proto::KEYMODE_PUBLIC);
+    key.set_role(role);
+    key.set_key(std::string(1, '\x02') + std::string(32, '\x5a'));
+}
+
+void add_signature(
+    proto::Credential& credential,
+    const std::string& signer)
+{
+    auto& signature = *credential.add_signature();
+    signature.set_version(1);
+    signature.set_credentialid(signer);
+    signature.set_role(proto::SIGROLE_PUBCREDENTIAL);
+    signature.set_hashtype(proto::HASHTYPE_SHA256);
+    signature.set_signature(std::string(64, '\x33'));
+}
+
+void set_source(proto::NymIDSource& source)
+{
+    source.set_version(1);
+    source.set_type(proto::SOURCETYPE_PUBKEY);
+    set_key(*source.mutable_key(), proto::KEYROLE_SIGN);
+}
+
+// Laid out the way KeyCredential::asSerialized() writes a public, signed
+// credential. The keys and signatures are filler and are never verified.
+proto::Credential credential(
+    const std::string& nymID,
+    const std::string& id,
+    const std::string& masterID)
+{
+    const bool master = masterID.empty();
+    proto::Credential output;
+    output.set_version(1);
+    output.set_id(id);
+    output.set_type(proto::CREDTYPE_LEGACY);
+    output.set_role(master ? proto::CREDROLE_MASTERKEY
+                           : proto::CREDROLE_CHILDKEY);
+    output.set_mode(proto::KEYMODE_PUBLIC);
+    output.set_nymid(nymID);
+
+    auto& keys = *output.mutable_publiccredential();
+    keys.set_version(1);
+    keys.set_mode(proto::KEYMODE_PUBLIC);
+    set_key(*keys.add_key(), proto::KEYROLE_AUTH);
+    set_key(*keys.add_key(), proto::KEYROLE_ENCRYPT);
+    set_key(*keys.add_key(), proto::KEYROLE_SIGN);
+
+    if (master) {
+        auto& parameters = *output.mutable_masterdata();
+        parameters.set_version(1);
+        set_source(*parameters.mutable_source());
+        parameters.mutable_sourceproof()->set_version(1);
+        parameters.mutable_sourceproof()->set_type(
+            proto::SOURCEPROOFTYPE_SELF_SIGNATURE);
+    } else {
+        auto& parameters = *output.mutable_childdata();
+        parameters.set_version(1);
+        parameters.set_masterid(masterID);
+    }
+
+    add_signature(output, id);
+
+    if (!master) { add_signature(output, masterID); }
+
+    return output;
+}
+
+// Laid out the way Nym::SaveCredentialIDs() stores a nym.
+proto::CredentialIndex nym(const std::uint64_t n)
+{
+    const std::string nymID = identifier("nym", n);
+    proto::CredentialIndex output;
+    output.set_version(1);
+    output.set_revision(1);
+    output.set_nymid(nymID);
+    set_source(*output.mutable_source());
+
+    auto& set = *output.add_activecredentials();
+    set.set_version(1);
+    set.set_nymid(nymID);
+    set.set_masterid(identifier("master", n));
+    set.set_mode(proto::CREDSETMODE_INDEX);
+    set.add_activechildids(identifier("child", n));
+
+    return output;
+}
+
+int remove_entry(const char* path, const struct stat*, int, struct FTW*)
+{
+    return remove(path);
+}
+
+struct Storage_Benchmark : public ::testing::Test
+{
+    StorageConfig config_;
+    std::unique_ptr<Storage> storage_;
+
+    Storage_Benchmark()
+    {
+        char folder[] = "/tmp/opentxs-storage-XXXXXX";
+
+        if (nullptr != mkdtemp(folder)) { config_.path_ = folder; }
+
+        config_.auto_publish_nyms_ = false;
+        config_.gc_interval_ = std::numeric_limits<int64_t>::max();
+
+        if (!config_.path_.empty()) {
+            storage_.reset(
+                Storage::Instantiate(digest, random_string, config_));
+        }
+    }
+
+    ~Storage_Benchmark()
+    {
+        storage_.reset();
+
+        if (!config_.path_.empty()) {
+            nftw(config_.path_.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+        }
+    }
+
+    static void report(
+        const std::string& what,
+        const std::uint64_t count,
+        const std::chrono::duration<double>& elapsed)
+    {
+        const double rate = (0 < elapsed.count()) ? count / elapsed.count() : 0;
+
+        std::cout << "Stored " << count << " " << what << " in "
+                  << elapsed.count() << " s ("
+                  << static_cast<std::uint64_t>(rate) << " ops/sec)"
+                  << std::endl;
+        RecordProperty(what + "_per_sec", static_cast<int>(rate));
+    }
+};
+
+} // namespace
+
+TEST_F(Storage_Benchmark, store_credentials)
+{
+    ASSERT_TRUE(storage_);
+
+    const std::uint64_t count = benchmark_count();
+    const std::string nymID = identifier("nym", 0);
+    const std::string masterID = identifier("master", 0);
+
+    ASSERT_TRUE(proto::Check(credential(nymID, masterID, ""), 0, 0xFFFFFFFF));
+    ASSERT_TRUE(proto::Check(
+        credential(nymID, identifier("child", 0), masterID), 0, 0xFFFFFFFF));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::uint64_t n = 0; n < count; ++n) {
+        ASSERT_TRUE(storage_->Store(
+            credential(nymID, identifier("child", n), masterID)));
+    }
+
+    report("credentials", count, std::chrono::steady_clock::now() - start);
+
+    for (std::uint64_t n = 0; n < count; n += (count / 100) + 1) {
+        std::shared_ptr<proto::Credential> loaded;
+
+        ASSERT_TRUE(storage_->Load(identifier("child", n), loaded));
+        ASSERT_EQ(identifier("child", n), loaded->id());
+    }
+}
+
+// Each nym store writes the index, the nym record, the nym list, the item
+// list and the root, so this is the path batching was added for.
+TEST_F(Storage_Benchmark, store_nyms)
+{
+    ASSERT_TRUE(storage_);
+
+    const std::uint64_t count = benchmark_count();
+
+    ASSERT_TRUE(proto::Check(nym(0), 0, 0xFFFFFFFF));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::uint64_t n = 0; n < count; ++n) {
+        ASSERT_TRUE(storage_->Store(nym(n)));
+    }
+
+    report("nyms", count, std::chrono::steady_clock::now() - start);
+
+    for (std::uint64_t n = 0; n < count; n += (count / 100) + 1) {
+        std::shared_ptr<proto::CredentialIndex> loaded;
+
+        ASSERT_TRUE(storage_->Load(identifier("nym", n), loaded));
+        ASSERT_EQ(identifier("nym", n), loaded->nymid());
+    }
+}
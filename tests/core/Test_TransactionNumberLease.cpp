@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest-message.h"
+#include "gtest/gtest-test-part.h"
+#include "opentxs/server/TransactionNumberLease.hpp"
+
+using namespace opentxs;
+
+namespace
+{
+
+const int64_t NUMBERS = 10000;
+
+// Stands in for MainFile::SaveMainFile(), which rewrites the whole notary
+// file each time the lease is saved.
+struct NotaryFile
+{
+    std::string path_;
+    std::string contents_;
+    std::atomic<int64_t> saves_;
+
+    NotaryFile()
+        : contents_(64 * 1024, 'n')
+        , saves_(0)
+    {
+        char path[] = "/tmp/opentxs-notary-XXXXXX";
+        const int fd = mkstemp(path);
+
+        if (-1 != fd) {
+            close(fd);
+            path_ = path;
+        }
+    }
+
+    ~NotaryFile()
+    {
+        if (!path_.empty()) { remove(path_.c_str()); }
+    }
+
+    bool Save()
+    {
+        FILE* file = fopen(path_.c_str(), "wb");
+
+        if (nullptr == file) { return false; }
+
+        const bool written =
+            (contents_.size() ==
+             fwrite(contents_.data(), 1, contents_.size(), file));
+        ++saves_;
+
+        return (0 == fclose(file)) && written;
+    }
+};
+
+// Issues NUMBERS transaction numbers from threads workers, and returns them
+// all, sorted.
+std::vector<int64_t> issue(
+    TransactionNumberLease& lease,
+    const int64_t block,
+    const std::size_t threads,
+    double& perSecond)
+{
+    std::vector<std::vector<int64_t>> issued(threads);
+    std::vector<std::thread> workers;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&, i]() {
+            for (int64_t n = 0; n < NUMBERS / int64_t(threads); ++n) {
+                int64_t number = 0;
+
+                if (!lease.Next(block, number)) { return; }
+
+                issued[i].push_back(number);
+            }
+        });
+    }
+
+    for (auto& worker : workers) { worker.join(); }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::vector<int64_t> output;
+
+    for (const auto& numbers : issued) {
+        output.insert(output.end(), numbers.begin(), numbers.end());
+    }
+
+    std::sort(output.begin(), output.end());
+    perSecond = (0 < elapsed.count()) ? output.size() / elapsed.count() : 0;
+
+    return output;
+}
+
+void report(
+    const int64_t block,
+    const std::size_t threads,
+    const double perSecond,
+    const int64_t saves)
+{
+    std::cout << "block " << block << ", " << threads << " thread(s): "
+              << static_cast<uint64_t>(perSecond) << " numbers/sec, " << saves
+              << " saves" << std::endl;
+}
+
+} // namespace
+
+TEST(TransactionNumberLease, resumes_past_saved_lease)
+{
+    TransactionNumberLease lease([]() { return true; });
+    int64_t number = 0;
+
+    ASSERT_TRUE(lease.Next(10, number));
+    EXPECT_EQ(1, number);
+    EXPECT_EQ(10, lease.Lease());
+
+    const int64_t saved = lease.Lease();
+    TransactionNumberLease restarted([]() { return true; });
+    restarted.Reset(saved);
+
+    ASSERT_TRUE(restarted.Next(10, number));
+    EXPECT_EQ(11, number);
+    EXPECT_EQ(20, restarted.Lease());
+}
+
+TEST(TransactionNumberLease, failed_save_issues_nothing)
+{
+    bool succeed = false;
+    TransactionNumberLease lease([&]() { return succeed; });
+    int64_t number = 0;
+
+    EXPECT_FALSE(lease.Next(10, number));
+    EXPECT_EQ(0, lease.Last());
+    EXPECT_EQ(0, lease.Lease());
+
+    succeed = true;
+    ASSERT_TRUE(lease.Next(10, number));
+    EXPECT_EQ(1, number);
+}
+
+// A block of 1 saves the notary file for every number, which is what
+// Transactor did before numbers were leased.
+TEST(TransactionNumberLease_Benchmark, numbers_per_second)
+{
+    for (const int64_t block : {int64_t(1), int64_t(100)}) {
+        for (const std::size_t threads : {std::size_t(1), std::size_t(4)}) {
+            NotaryFile file;
+
+            ASSERT_FALSE(file.path_.empty());
+
+            TransactionNumberLease lease([&]() { return file.Save(); });
+            double perSecond = 0;
+            const auto issued = issue(lease, block, threads, perSecond);
+
+            ASSERT_EQ(NUMBERS / int64_t(threads) * int64_t(threads),
+                      int64_t(issued.size()));
+            EXPECT_TRUE(
+                std::adjacent_find(issued.begin(), issued.end()) ==
+                issued.end());
+            EXPECT_GE(lease.Lease(), issued.back());
+
+            report(block, threads, perSecond, file.saves_);
+        }
+    }
+}